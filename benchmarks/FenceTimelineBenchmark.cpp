@@ -0,0 +1,141 @@
+// Cost of the fence timeline on a SoftwareFence: Signal(), IsComplete() answered from the cached completed value,
+// IsComplete() on a value not reached yet (every call queries the fence), and a raw fence query for comparison. Then
+// 1, 2, 4, ... threads polling IsComplete() on recent values while one thread signals and completes, the way the frame
+// loop, the pools and the fence wait service poll one timeline; the share of polls that reached the fence shows what
+// the cache saves. With d3d12 a fence query is a driver call, much more expensive than here.
+//
+// usage: FenceTimelineBenchmark [operations, default 2^22] [repetitions, default 5] [max threads, default hardware threads]
+
+#include "core/FenceTimeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Best of repetitions, in nanoseconds per call of operation(i).
+    template <typename Operation>
+    double Measure(uint32_t operations, uint32_t repetitions, Operation&& operation)
+    {
+        double best = 0.0;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < operations; ++i)
+            {
+                operation(i);
+            }
+            const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / operations;
+            best = repetition == 0 ? nanoseconds : std::min(best, nanoseconds);
+        }
+        return best;
+    }
+
+    struct PollResult
+    {
+        double pollsPerSecond { 0.0 };
+        double fenceQueryFraction { 0.0 };
+    };
+
+    // pollers threads poll while this thread signals and completes operations values.
+    PollResult MeasurePolling(uint32_t pollers, uint32_t operations, uint64_t& checksum)
+    {
+        SoftwareFence fence;
+        FenceTimeline timeline(&fence);
+        std::atomic<bool> done { false };
+        std::vector<uint64_t> completed(pollers);
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < pollers; ++i)
+        {
+            threads.emplace_back([&timeline, &done, &completed, i]()
+            {
+                uint64_t reached = 0;
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    // a few values behind the last signal and the last signal itself, like a pool checking its oldest entry.
+                    const uint64_t last = timeline.GetLastSignaledValue();
+                    reached += timeline.IsComplete(last > 4 ? last - 4 : 0) ? 1 : 0;
+                    reached += timeline.IsComplete(last) ? 1 : 0;
+                }
+                completed[i] = reached;
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < operations; ++i)
+        {
+            fence.Complete(timeline.Signal());
+            if (i % 64 == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_relaxed);
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (uint64_t reached : completed)
+        {
+            checksum += reached;
+        }
+        const FenceTimeline::Stats stats = timeline.GetStats();
+        PollResult result;
+        result.pollsPerSecond = stats.completionPolls / seconds;
+        result.fenceQueryFraction = stats.completionPolls > 0 ? static_cast<double>(stats.fenceQueries) / stats.completionPolls : 0.0;
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t operations = argc > 1 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[1], nullptr, 10))) : 1u << 22;
+    const uint32_t repetitions = argc > 2 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[2], nullptr, 10))) : 5u;
+    const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t maxThreads = argc > 3 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[3], nullptr, 10))) : hardwareThreads;
+
+    printf("%u operations, %u hardware threads, best of %u\n", operations, hardwareThreads, repetitions);
+    uint64_t checksum = 0;
+
+    {
+        SoftwareFence fence;
+        FenceTimeline timeline(&fence);
+        printf("%-28s %8.2f ns\n", "Signal", Measure(operations, repetitions, [&timeline](uint32_t) { timeline.Signal(); }));
+
+        fence.CompleteAll();
+        timeline.RefreshCompletedValue();
+        const uint64_t last = timeline.GetLastSignaledValue();
+        printf("%-28s %8.2f ns\n", "IsComplete, cached", Measure(operations, repetitions, [&timeline, &checksum, last](uint32_t i)
+        {
+            checksum += timeline.IsComplete(last - i % 1024) ? 1 : 0;
+        }));
+        printf("%-28s %8.2f ns\n", "IsComplete, not reached", Measure(operations, repetitions, [&timeline, &checksum, last](uint32_t i)
+        {
+            checksum += timeline.IsComplete(last + 1 + i % 1024) ? 1 : 0;
+        }));
+        printf("%-28s %8.2f ns\n", "RefreshCompletedValue", Measure(operations, repetitions, [&timeline, &checksum](uint32_t)
+        {
+            checksum += timeline.RefreshCompletedValue();
+        }));
+    }
+
+    printf("\n%8s %14s %14s\n", "pollers", "polls/s", "fence queries");
+    for (uint32_t pollers = 1; pollers < maxThreads * 2; pollers *= 2)
+    {
+        pollers = std::min(pollers, maxThreads);
+        const PollResult result = MeasurePolling(pollers, operations / 16, checksum);
+        printf("%8u %14.0f %13.1f%%\n", pollers, result.pollsPerSecond, 100.0 * result.fenceQueryFraction);
+    }
+
+    // printed so the work isn't optimized away.
+    printf("checksum %llx\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Frame loop timings on a NullDevice, in real time: FrameSubmissionModel driven back to back by the HeadlessRunner.
+// With no GPU cost the frame time is the CPU cost of the loop itself (pools, barriers, submission, fence bookkeeping)
+// for 0, 4 and 16 scene command lists; with the default GPU cost the simulated GPU is the bottleneck and the table
+// shows how much of the frame is spent waiting on the fence for 1, 2 and 3 frames in flight.
+//
+// usage: FrameLoopBenchmark [frames, default 20000] [draws per scene command list, default 64]
+
+#include "core/FrameSubmissionModel.h"
+#include "core/HeadlessRunner.h"
+#include "core/NullDevice.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    struct Result
+    {
+        HeadlessRunner::Report report;
+        FrameSubmissionModel::Stats stats;
+    };
+
+    Result Run(const NullDevice::Settings& deviceSettings, const FrameSubmissionModel::Settings& settings, uint64_t frames, uint32_t drawsPerList)
+    {
+        SteadyClock clock;
+        NullDevice device(clock, deviceSettings);
+        FrameSubmissionModel model(device, clock, settings);
+        model.SetRecordScene([drawsPerList](GpuCommandList& commandList, uint32_t, uint32_t)
+        {
+            for (uint32_t i = 0; i < drawsPerList; ++i)
+            {
+                commandList.Draw(3, 1);
+            }
+        });
+
+        // a few frames to create the pooled allocators before measuring.
+        for (uint32_t i = 0; i < settings.frameLatency * 2; ++i)
+        {
+            model.Frame();
+        }
+
+        HeadlessRunner runner(clock);
+        Result result;
+        result.report = runner.Run(frames, [&model]() { model.Frame(); });
+        model.Flush();
+        result.stats = model.GetStats();
+        return result;
+    }
+
+    void Print(const char* name, uint32_t value, const Result& result)
+    {
+        const HeadlessRunner::Report& report = result.report;
+        printf("%10s %6u %12.1f %9.4f %9.4f %9.4f %9.4f %11.4f %10llu\n", name, value, report.framesPerSecond,
+            report.frameMs.average, report.frameMs.p50, report.frameMs.p99, report.frameMs.max, result.stats.fenceWaitMs.average,
+            static_cast<unsigned long long>(result.stats.allocators.created));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint64_t frames = argc > 1 ? std::max<uint64_t>(1, strtoull(argv[1], nullptr, 10)) : 20000u;
+    const uint32_t drawsPerList = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 64u;
+
+    printf("%llu frames, %u draws per scene command list\n", static_cast<unsigned long long>(frames), drawsPerList);
+    printf("%10s %6s %12s %9s %9s %9s %9s %11s %10s\n", "", "", "frames/s", "avg ms", "p50 ms", "p99 ms", "max ms", "fence ms", "allocators");
+
+    // the CPU side alone: the fences complete as soon as they're signaled.
+    NullDevice::Settings noGpuCost;
+    noGpuCost.submitLatency = Clock::Duration::zero();
+    noGpuCost.commandListCost = Clock::Duration::zero();
+    noGpuCost.commandCost = Clock::Duration::zero();
+    const uint32_t listCounts[] = { 0, 4, 16 };
+    for (uint32_t listCount : listCounts)
+    {
+        FrameSubmissionModel::Settings settings;
+        settings.sceneCommandListCount = listCount;
+        Print("lists", listCount, Run(noGpuCost, settings, frames, drawsPerList));
+    }
+
+    // GPU bound: the frames in flight hide the submission latency, the rest of the frame is a fence wait.
+    const uint32_t latencies[] = { 1, 2, 3 };
+    for (uint32_t latency : latencies)
+    {
+        FrameSubmissionModel::Settings settings;
+        settings.sceneCommandListCount = 4;
+        settings.frameLatency = latency;
+        Print("latency", latency, Run(NullDevice::Settings(), settings, frames, drawsPerList));
+    }
+    return 0;
+}
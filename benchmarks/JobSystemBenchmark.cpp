@@ -0,0 +1,95 @@
+// Scaling of the job system with the number of workers on synthetic jobs: a fixed amount of CPU bound work split in
+// jobs of several sizes, run serially and then on 2, 4, ... threads up to one per hardware thread. Small jobs measure the
+// scheduling overhead, big ones how close the speedup gets to the core count.
+//
+// usage: JobSystemBenchmark [total work units, default 2^24] [repetitions, default 5] [max threads, default hardware threads]
+
+#include "core/JobSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    // Some integer work the compiler can't fold, one unit is a few nanoseconds.
+    uint64_t Work(uint64_t seed, uint32_t units)
+    {
+        uint64_t state = seed | 1;
+        for (uint32_t i = 0; i < units; ++i)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+        }
+        return state;
+    }
+
+    // Best of repetitions, in milliseconds. Without a job system the jobs run one after the other on this thread.
+    double Run(JobSystem* jobs, uint32_t totalUnits, uint32_t unitsPerJob, uint32_t repetitions, uint64_t& checksum)
+    {
+        const uint32_t jobCount = totalUnits / unitsPerJob;
+        std::vector<uint64_t> results(jobCount);
+        auto job = [&](uint32_t i) { results[i] = Work(i, unitsPerJob); };
+
+        double best = 0.0;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            if (jobs)
+            {
+                jobs->ParallelFor(jobCount, 1, job);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < jobCount; ++i)
+                {
+                    job(i);
+                }
+            }
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = repetition == 0 ? milliseconds : std::min(best, milliseconds);
+        }
+
+        for (uint64_t result : results)
+        {
+            checksum += result;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t totalUnits = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1u << 24;
+    const uint32_t repetitions = argc > 2 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[2], nullptr, 10))) : 5u;
+    const uint32_t jobSizes[] = { 256, 4096, 65536 };
+    const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t maxThreads = argc > 3 ? std::max(2u, static_cast<uint32_t>(strtoul(argv[3], nullptr, 10))) : std::max(2u, hardwareThreads);
+
+    printf("%u work units, %u hardware threads, best of %u\n", totalUnits, hardwareThreads, repetitions);
+    printf("%8s %10s %10s %12s %8s %10s\n", "threads", "job units", "jobs", "ms", "speedup", "stolen");
+
+    uint64_t checksum = 0;
+    for (uint32_t jobSize : jobSizes)
+    {
+        const double serialMs = Run(nullptr, totalUnits, jobSize, repetitions, checksum);
+        printf("%8s %10u %10u %12.3f %7.2fx %10s\n", "serial", jobSize, totalUnits / jobSize, serialMs, 1.0, "-");
+
+        // the thread calling ParallelFor runs jobs too: threads - 1 workers.
+        for (uint32_t threads = 2; threads < maxThreads * 2; threads *= 2)
+        {
+            threads = std::min(threads, maxThreads);
+            JobSystem jobs(threads - 1);
+            const double milliseconds = Run(&jobs, totalUnits, jobSize, repetitions, checksum);
+
+            const JobSystem::Stats stats = jobs.GetStats();
+            printf("%8u %10u %10u %12.3f %7.2fx %9.1f%%\n", threads, jobSize, totalUnits / jobSize, milliseconds,
+                serialMs / milliseconds, stats.executed > 0 ? 100.0 * stats.stolen / stats.executed : 0.0);
+        }
+    }
+
+    // printed so the work isn't optimized away.
+    printf("checksum %llx\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Cost of the CPU profiler: a zone opened and closed back to back with recording enabled and disabled, on 1, 2, 4, ...
+// threads at once up to one per hardware thread, a zone recorded on a named track, and the Chrome trace export of full
+// rings. Runs in its own process, the zones it records don't evict the ones of a capture worth keeping.
+//
+// usage: ProfilerBenchmark [zones per thread, default 2^20] [repetitions, default 5] [max threads, default hardware threads]
+
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Best of repetitions, in nanoseconds per zone.
+    double OpenZones(uint32_t zones, uint32_t repetitions)
+    {
+        double best = 0.0;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < zones; ++i)
+            {
+                ProfileZone zone("ProfilerBenchmark zone");
+            }
+            const double nanoseconds = MillisecondsSince(start) * 1e6 / zones;
+            best = repetition == 0 ? nanoseconds : std::min(best, nanoseconds);
+        }
+        return best;
+    }
+
+    // Every thread opens zones at the same time, the slowest one is reported. The threads are created once per run:
+    // each new thread gets a ring of its own that lives as long as the profiler.
+    double MeasureZones(uint32_t threadCount, uint32_t zonesPerThread, uint32_t repetitions)
+    {
+        std::vector<double> nanoseconds(threadCount);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back([&nanoseconds, i, zonesPerThread, repetitions]()
+            {
+                nanoseconds[i] = OpenZones(zonesPerThread, repetitions);
+            });
+        }
+        nanoseconds[0] = OpenZones(zonesPerThread, repetitions);
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        return *std::max_element(nanoseconds.begin(), nanoseconds.end());
+    }
+
+    double MeasureTrackRecord(Profiler::Track& track, uint32_t zones, uint32_t repetitions)
+    {
+        double best = 0.0;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < zones; ++i)
+            {
+                const int64_t now = Profiler::NowNanoseconds();
+                Profiler::Record(track, "ProfilerBenchmark track zone", now, now + 1000, 0);
+            }
+            const double nanoseconds = MillisecondsSince(start) * 1e6 / zones;
+            best = repetition == 0 ? nanoseconds : std::min(best, nanoseconds);
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t zonesPerThread = argc > 1 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[1], nullptr, 10))) : 1u << 20;
+    const uint32_t repetitions = argc > 2 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[2], nullptr, 10))) : 5u;
+    const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t maxThreads = argc > 3 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[3], nullptr, 10))) : hardwareThreads;
+
+    Profiler& profiler = Profiler::Get();
+    printf("%u zones per thread, %u zones kept per thread, %u hardware threads, best of %u\n", zonesPerThread,
+        Profiler::ZoneCapacity, hardwareThreads, repetitions);
+    printf("%8s %14s %14s\n", "threads", "enabled ns", "disabled ns");
+
+    for (uint32_t threads = 1; threads < maxThreads * 2; threads *= 2)
+    {
+        threads = std::min(threads, maxThreads);
+        profiler.SetEnabled(true);
+        const double enabled = MeasureZones(threads, zonesPerThread, repetitions);
+        profiler.SetEnabled(false);
+        const double disabled = MeasureZones(threads, zonesPerThread, repetitions);
+        printf("%8u %14.2f %14.2f\n", threads, enabled, disabled);
+    }
+    profiler.SetEnabled(true);
+
+    Profiler::Track& track = profiler.CreateTrack("ProfilerBenchmark track");
+    printf("track record: %.2f ns per zone\n", MeasureTrackRecord(track, zonesPerThread, repetitions));
+
+    // every ring written so far is full: the export copies ZoneCapacity zones of each.
+    double exportMs = 0.0;
+    size_t bytes = 0;
+    for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+    {
+        std::ostringstream out;
+        const auto start = std::chrono::steady_clock::now();
+        profiler.WriteChromeTrace(out);
+        const double milliseconds = MillisecondsSince(start);
+        exportMs = repetition == 0 ? milliseconds : std::min(exportMs, milliseconds);
+        bytes = out.str().size();
+    }
+    printf("trace export: %.3f ms, %.1f MB\n", exportMs, bytes / (1024.0 * 1024.0));
+    return 0;
+}
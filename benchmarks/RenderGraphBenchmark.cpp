@@ -0,0 +1,129 @@
+// Render graph compilation on large randomized graphs: thousands of passes each writing a few new transient resources
+// and reading recent ones, a handful of imported resources and passes with side effects keeping chains alive, the rest
+// culled. Reports the time to build and compile the graph, the barriers planned and the memory aliasing saves (transient
+// heap size against every transient resource placed on its own).
+//
+// usage: RenderGraphBenchmark [repetitions, default 5] [seed, default 1]
+
+#include "core/RenderGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const uint64_t KB = 1024;
+    const uint64_t MB = 1024 * 1024;
+    const uint32_t ImportedCount = 8;
+    const uint32_t ReadWindow = 48; // passes read among the last resources created
+
+    double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Adds passCount random passes to an empty graph, the same graph for the same seed.
+    void Build(RenderGraph& graph, uint32_t passCount, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        const ResourceState writeStates[] = { ResourceState::RenderTarget, ResourceState::UnorderedAccess, ResourceState::CopyDest, ResourceState::DepthWrite };
+        const ResourceState readStates[] = { ResourceState::ShaderResource, ResourceState::ShaderResource, ResourceState::CopySource, ResourceState::DepthRead, ResourceState::UnorderedAccess };
+
+        std::vector<RenderGraph::ResourceHandle> imported;
+        for (uint32_t i = 0; i < ImportedCount; ++i)
+        {
+            imported.push_back(graph.ImportResource("imported " + std::to_string(i), ResourceState::ShaderResource, ResourceState::ShaderResource));
+        }
+        const RenderGraph::ResourceHandle backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+
+        std::vector<RenderGraph::ResourceHandle> transients;
+        std::vector<RenderGraph::ResourceHandle> used;
+        for (uint32_t passIndex = 0; passIndex < passCount; ++passIndex)
+        {
+            const bool last = passIndex + 1 == passCount;
+            const RenderGraph::PassHandle pass = graph.AddPass("pass " + std::to_string(passIndex), random() % 64 == 0);
+            used.clear();
+
+            const uint32_t readCount = transients.empty() ? 0 : 1 + random() % 3;
+            for (uint32_t i = 0; i < readCount; ++i)
+            {
+                const size_t window = std::min<size_t>(transients.size(), ReadWindow);
+                const RenderGraph::ResourceHandle resource = transients[transients.size() - 1 - random() % window];
+                if (std::find(used.begin(), used.end(), resource) == used.end())
+                {
+                    graph.Read(pass, resource, readStates[random() % 5]);
+                    used.push_back(resource);
+                }
+            }
+
+            const uint32_t createCount = 1 + random() % 2;
+            for (uint32_t i = 0; i < createCount; ++i)
+            {
+                // render targets from 64 KB to 16 MB, now and then an MSAA one aligned to 4 MB.
+                const uint64_t size = (1 + random() % 256) * 64 * KB;
+                const uint64_t alignment = random() % 16 == 0 ? 4 * MB : RenderGraph::PlacementAlignment;
+                const RenderGraph::ResourceHandle resource = graph.CreateTransient("resource " + std::to_string(transients.size()), size, alignment);
+                graph.Write(pass, resource, writeStates[random() % 4]);
+                transients.push_back(resource);
+            }
+
+            if (last)
+            {
+                graph.Write(pass, backBuffer, ResourceState::RenderTarget);
+            }
+            else if (random() % 32 == 0)
+            {
+                graph.Write(pass, imported[random() % ImportedCount], ResourceState::UnorderedAccess);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t repetitions = argc > 1 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[1], nullptr, 10))) : 5u;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1u;
+    const uint32_t passCounts[] = { 1000, 4000, 16000 };
+
+    printf("best of %u, seed %u\n", repetitions, seed);
+    printf("%7s %9s %7s %9s %9s %11s %9s %9s %9s %8s %10s %10s %8s\n", "passes", "resources", "culled", "build ms", "compile ms",
+        "transitions", "aliasing", "uav", "batches", "aliased", "heap MB", "unaliased", "saved");
+
+    RenderGraph graph;
+    for (uint32_t passCount : passCounts)
+    {
+        double buildMs = 0.0;
+        double compileMs = 0.0;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            // the storage is kept across Reset(), like from one frame to the next.
+            graph.Reset();
+            auto start = std::chrono::steady_clock::now();
+            Build(graph, passCount, seed);
+            const double build = MillisecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            graph.Compile();
+            const double compile = MillisecondsSince(start);
+
+            buildMs = repetition == 0 ? build : std::min(buildMs, build);
+            compileMs = repetition == 0 ? compile : std::min(compileMs, compile);
+        }
+
+        const RenderGraph::Stats& stats = graph.GetStats();
+        const double heapMB = static_cast<double>(stats.transientHeapSize) / MB;
+        const double unaliasedMB = static_cast<double>(stats.transientBytes) / MB;
+        printf("%7u %9u %7llu %9.3f %10.3f %11llu %9llu %9llu %9llu %8llu %10.1f %10.1f %7.1f%%\n", passCount, graph.GetResourceCount(),
+            static_cast<unsigned long long>(stats.culledPasses), buildMs, compileMs,
+            static_cast<unsigned long long>(stats.transitionBarriers), static_cast<unsigned long long>(stats.aliasingBarriers),
+            static_cast<unsigned long long>(stats.unorderedAccessBarriers), static_cast<unsigned long long>(stats.barrierBatches),
+            static_cast<unsigned long long>(stats.aliasedResources), heapMB, unaliasedMB,
+            unaliasedMB > 0.0 ? 100.0 * (1.0 - heapMB / unaliasedMB) : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Throughput of the TLSF allocator behind the placed resource heaps: allocating a burst of blocks and freeing them all,
+// in the same and in the reverse order, then a steady state where a random live block is freed and a new one allocated
+// over and over, with and without 4 MB aligned (MSAA) requests mixed in. Sizes are those of placed resources, 64 KB
+// granularity up to 16 MB. The churn also reports how fragmented the heap ends up; 2048 live blocks take most of the
+// heap, the failed allocations show how well it copes when nearly full.
+//
+// usage: TlsfAllocatorBenchmark [operations, default 2^20] [repetitions, default 5] [seed, default 1]
+
+#include "core/TlsfAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const uint64_t KB = 1024;
+    const uint64_t MB = 1024 * 1024;
+    const uint64_t Granularity = 64 * KB;
+    const uint64_t HeapSize = 4096 * MB;
+
+    struct Request
+    {
+        uint64_t size;
+        uint64_t alignment;
+    };
+
+    // The same requests for every repetition, so only the allocator is timed.
+    std::vector<Request> MakeRequests(uint32_t count, uint32_t alignedOneIn, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<Request> requests(count);
+        for (Request& request : requests)
+        {
+            // mostly small blocks, a few large ones, like a frame's render targets and buffers.
+            const uint64_t granules = random() % 4 == 0 ? 1 + random() % 256 : 1 + random() % 16;
+            request.size = granules * Granularity - random() % Granularity;
+            request.alignment = alignedOneIn > 0 && random() % alignedOneIn == 0 ? 4 * MB : Granularity;
+        }
+        return requests;
+    }
+
+    double NanosecondsSince(std::chrono::steady_clock::time_point start, uint64_t operations)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / operations;
+    }
+
+    struct BurstResult
+    {
+        double allocateNs { 0.0 };
+        double freeNs { 0.0 };
+    };
+
+    // Allocate every request, then free them in allocation order or in reverse.
+    BurstResult Burst(const std::vector<Request>& requests, bool reverseFree, uint32_t repetitions, uint64_t& checksum)
+    {
+        BurstResult best;
+        std::vector<TlsfAllocator::Handle> handles(requests.size());
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            TlsfAllocator allocator(HeapSize, Granularity);
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < requests.size(); ++i)
+            {
+                const TlsfAllocator::Allocation allocation = allocator.Allocate(requests[i].size, requests[i].alignment);
+                handles[i] = allocation.handle;
+                checksum += allocation.offset;
+            }
+            const double allocateNs = NanosecondsSince(start, requests.size());
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < handles.size(); ++i)
+            {
+                const TlsfAllocator::Handle handle = handles[reverseFree ? handles.size() - 1 - i : i];
+                if (handle != TlsfAllocator::InvalidHandle)
+                {
+                    allocator.Free(handle);
+                }
+            }
+            const double freeNs = NanosecondsSince(start, handles.size());
+
+            best.allocateNs = repetition == 0 ? allocateNs : std::min(best.allocateNs, allocateNs);
+            best.freeNs = repetition == 0 ? freeNs : std::min(best.freeNs, freeNs);
+        }
+        return best;
+    }
+
+    struct ChurnResult
+    {
+        double operationNs { 0.0 }; // one free and one allocation
+        uint64_t failed { 0 };
+        TlsfAllocator::Stats stats;
+    };
+
+    // liveCount blocks allocated up front, then each operation frees a random one and allocates the next request.
+    ChurnResult Churn(const std::vector<Request>& requests, uint32_t liveCount, uint32_t repetitions, uint32_t seed, uint64_t& checksum)
+    {
+        ChurnResult best;
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            TlsfAllocator allocator(HeapSize, Granularity);
+            std::mt19937 random(seed);
+            std::vector<TlsfAllocator::Handle> live;
+            for (uint32_t i = 0; i < liveCount; ++i)
+            {
+                live.push_back(allocator.Allocate(requests[i % requests.size()].size, requests[i % requests.size()].alignment).handle);
+            }
+
+            // the victims are drawn before timing, the generator isn't part of the measure.
+            std::vector<uint32_t> victims(requests.size());
+            for (uint32_t& victim : victims)
+            {
+                victim = random() % liveCount;
+            }
+
+            uint64_t failed = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < requests.size(); ++i)
+            {
+                TlsfAllocator::Handle& slot = live[victims[i]];
+                if (slot != TlsfAllocator::InvalidHandle)
+                {
+                    allocator.Free(slot);
+                }
+                const TlsfAllocator::Allocation allocation = allocator.Allocate(requests[i].size, requests[i].alignment);
+                slot = allocation.handle;
+                failed += allocation.IsValid() ? 0 : 1;
+                checksum += allocation.offset;
+            }
+            const double operationNs = NanosecondsSince(start, requests.size());
+
+            if (repetition == 0 || operationNs < best.operationNs)
+            {
+                best.operationNs = operationNs;
+                best.failed = failed;
+                best.stats = allocator.GetStats();
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t operations = argc > 1 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[1], nullptr, 10))) : 1u << 20;
+    const uint32_t repetitions = argc > 2 ? std::max(1u, static_cast<uint32_t>(strtoul(argv[2], nullptr, 10))) : 5u;
+    const uint32_t seed = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 1u;
+
+    printf("%u operations on a %llu MB heap, best of %u\n", operations, static_cast<unsigned long long>(HeapSize / MB), repetitions);
+    uint64_t checksum = 0;
+
+    // a burst has to fit in the heap, the average request is about 2.5 MB.
+    const std::vector<Request> burst = MakeRequests(std::min(operations, 1024u), 0, seed);
+    printf("\n%-28s %12s %12s\n", "burst", "allocate ns", "free ns");
+    const BurstResult fifo = Burst(burst, false, repetitions, checksum);
+    printf("%-28s %12.1f %12.1f\n", "free in allocation order", fifo.allocateNs, fifo.freeNs);
+    const BurstResult lifo = Burst(burst, true, repetitions, checksum);
+    printf("%-28s %12.1f %12.1f\n", "free in reverse order", lifo.allocateNs, lifo.freeNs);
+
+    printf("\n%-28s %12s %8s %8s %10s %14s\n", "churn", "free+alloc ns", "failed", "blocks", "used MB", "fragmentation");
+    const uint32_t liveCounts[] = { 64, 512, 2048 };
+    const uint32_t alignedOneIn[] = { 0, 8 };
+    for (uint32_t aligned : alignedOneIn)
+    {
+        const std::vector<Request> requests = MakeRequests(operations, aligned, seed + 1);
+        for (uint32_t liveCount : liveCounts)
+        {
+            const ChurnResult result = Churn(requests, liveCount, repetitions, seed, checksum);
+            char name[64];
+            snprintf(name, sizeof(name), "%u live%s", liveCount, aligned ? ", 1 in 8 aligned" : "");
+            printf("%-28s %12.1f %8llu %8llu %10.1f %13.1f%%\n", name, result.operationNs, static_cast<unsigned long long>(result.failed),
+                static_cast<unsigned long long>(result.stats.allocations), static_cast<double>(result.stats.usedBytes) / MB,
+                100.0 * result.stats.fragmentation);
+        }
+    }
+
+    // printed so the work isn't optimized away.
+    printf("\nchecksum %llx\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
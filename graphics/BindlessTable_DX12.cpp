@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "BindlessTable_DX12.h"
+
+BindlessTable_DX12::BindlessTable_DX12(ComPtr<ID3D12Device> device, ID3D12DescriptorHeap* heap, uint32_t capacity, FenceTimeline& timeline)
+    : m_device(device)
+    , m_descriptorSize(device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
+    , m_cpuStart(heap->GetCPUDescriptorHandleForHeapStart())
+    , m_gpuStart(heap->GetGPUDescriptorHandleForHeapStart())
+    , m_indices(timeline, capacity)
+{
+}
+
+BindlessTable_DX12::Handle BindlessTable_DX12::CreateShaderResourceView(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+{
+    const Handle handle = m_indices.Allocate();
+    if (handle.IsValid())
+    {
+        m_device->CreateShaderResourceView(resource, desc, GetCpuHandle(handle));
+    }
+    return handle;
+}
+
+BindlessTable_DX12::Handle BindlessTable_DX12::CreateUnorderedAccessView(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter)
+{
+    const Handle handle = m_indices.Allocate();
+    if (handle.IsValid())
+    {
+        m_device->CreateUnorderedAccessView(resource, counter, desc, GetCpuHandle(handle));
+    }
+    return handle;
+}
+
+BindlessTable_DX12::Handle BindlessTable_DX12::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc)
+{
+    const Handle handle = m_indices.Allocate();
+    if (handle.IsValid())
+    {
+        m_device->CreateConstantBufferView(&desc, GetCpuHandle(handle));
+    }
+    return handle;
+}
+
+BindlessTable_DX12::Handle BindlessTable_DX12::Copy(D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+    const Handle handle = m_indices.Allocate();
+    if (handle.IsValid())
+    {
+        m_device->CopyDescriptorsSimple(1, GetCpuHandle(handle), source, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    return handle;
+}
+
+void BindlessTable_DX12::Free(Handle& handle)
+{
+    if (handle.IsValid())
+    {
+        m_indices.Free(handle);
+        handle = Handle();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "graphics.h"
+#include "core/BindlessIndexAllocator.h"
+
+// Bindless CBV/SRV/UAV table: the reserved front of the shader visible heap (DescriptorRing_DX12), each view gets a
+// stable slot for its whole lifetime (BindlessIndexAllocator) and shaders index the heap with that integer, passed in
+// root constants (SetIndex()). Nothing is rebuilt per draw: the heap is bound once per list, the table is either the
+// whole heap (ResourceDescriptorHeap[index], shader model 6.6) or an unbounded range at GetTableStart().
+class BindlessTable_DX12
+{
+public:
+    using Handle = BindlessIndexAllocator::Handle;
+
+    // The first capacity descriptors of heap, timeline is the one of the queue reading them.
+    BindlessTable_DX12(ComPtr<ID3D12Device> device, ID3D12DescriptorHeap* heap, uint32_t capacity, FenceTimeline& timeline);
+
+    BindlessTable_DX12(const BindlessTable_DX12&) = delete;
+    BindlessTable_DX12& operator=(const BindlessTable_DX12&) = delete;
+
+    // A view in a new slot, invalid handle when the table is full. Thread safe.
+    Handle CreateShaderResourceView(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc);
+    Handle CreateUnorderedAccessView(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter = nullptr);
+    Handle CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc);
+    // A copy of a staging descriptor (DescriptorAllocator_DX12) in a new slot.
+    Handle Copy(D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+    // Free the slot once the frame being recorded has completed, the handle is stale right away.
+    void Free(Handle& handle);
+    // The frame has been submitted with frameFenceValue, the slots it freed wait for it.
+    void EndFrame(uint64_t frameFenceValue) { m_indices.EndFrame(frameFenceValue); }
+    // Slots freed by the frames the GPU is done with become available, call once per frame. Doesn't block.
+    void RetireCompleted() { m_indices.RetireCompleted(); }
+
+    bool IsValid(Handle handle) const { return m_indices.IsValid(handle); }
+    // What the shaders index the heap with.
+    static uint32_t GetIndex(Handle handle) { return handle.index; }
+
+    // Pass the index of handle to the shaders as root constant destOffset of rootParameterIndex.
+    static void SetIndex(ID3D12GraphicsCommandList* commandList, UINT rootParameterIndex, Handle handle, UINT destOffset = 0)
+    {
+        commandList->SetGraphicsRoot32BitConstant(rootParameterIndex, GetIndex(handle), destOffset);
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE GetTableStart() const { return m_gpuStart; }
+    uint32_t GetCapacity() const { return m_indices.GetCapacity(); }
+    BindlessIndexAllocator::Stats GetStats() const { return m_indices.GetStats(); }
+
+private:
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(Handle handle) const { return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuStart, static_cast<INT>(handle.index), m_descriptorSize); }
+
+    ComPtr<ID3D12Device> m_device;
+    UINT m_descriptorSize;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart;
+    BindlessIndexAllocator m_indices;
+};
@@ -0,0 +1,68 @@
+#include "stdafx.h"
+#include "Clock_Win32.h"
+
+#if !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+Clock_Win32::Clock_Win32()
+{
+    m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    m_highResolution = m_timer != nullptr;
+    if (!m_timer)
+    {
+        m_timer = ::CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+    assert(m_timer && "Failed to create waitable timer.");
+}
+
+Clock_Win32::~Clock_Win32()
+{
+    ::CloseHandle(m_timer);
+}
+
+Clock::Duration Clock_Win32::Now() const
+{
+    return Duration(QpcNowNanoseconds());
+}
+
+int64_t Clock_Win32::QpcToNanoseconds(int64_t ticks)
+{
+    static const int64_t frequency = []()
+    {
+        LARGE_INTEGER value = {};
+        ::QueryPerformanceFrequency(&value);
+        return value.QuadPart;
+    }();
+
+    // split to avoid overflowing ticks * 1e9
+    return (ticks / frequency) * 1000000000LL + (ticks % frequency) * 1000000000LL / frequency;
+}
+
+int64_t Clock_Win32::QpcNowNanoseconds()
+{
+    LARGE_INTEGER counter;
+    ::QueryPerformanceCounter(&counter);
+    return QpcToNanoseconds(counter.QuadPart);
+}
+
+void Clock_Win32::Sleep(Duration duration)
+{
+    if (duration <= Duration::zero())
+    {
+        return;
+    }
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -static_cast<LONGLONG>(duration.count() / 100); // relative, in 100ns units
+
+    if (::SetWaitableTimerEx(m_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+    {
+        ::WaitForSingleObject(m_timer, INFINITE);
+    }
+}
+
+void Clock_Win32::Relax()
+{
+    YieldProcessor();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "graphics.h"
+#include "core/Clock.h"
+
+// QueryPerformanceCounter time and high resolution waitable timer sleeps (falls back to a regular waitable timer on
+// windows versions without CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, the pacer's final spin absorbs the coarser wake up).
+class Clock_Win32 : public Clock
+{
+public:
+    Clock_Win32();
+    ~Clock_Win32();
+
+    Clock_Win32(const Clock_Win32&) = delete;
+    Clock_Win32& operator=(const Clock_Win32&) = delete;
+
+    virtual Duration Now() const override;
+    virtual void Sleep(Duration duration) override;
+    virtual void Relax() override;
+
+    bool IsHighResolution() const { return m_highResolution; }
+
+    // QueryPerformanceCounter ticks in nanoseconds, the unit of Now() and of std::chrono::steady_clock (which counts the
+    // same ticks): timestamps from d3d12 and dxgi (clock calibration, frame statistics) land on the CPU clocks.
+    static int64_t QpcToNanoseconds(int64_t ticks);
+    static int64_t QpcNowNanoseconds();
+
+private:
+    HANDLE m_timer { };
+    bool m_highResolution { false };
+};
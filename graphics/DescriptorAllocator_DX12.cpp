@@ -0,0 +1,56 @@
+#include "stdafx.h"
+#include "DescriptorAllocator_DX12.h"
+
+DescriptorAllocator_DX12::DescriptorAllocator_DX12(ComPtr<ID3D12Device> device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t pageSize)
+    : m_device(device)
+    , m_type(type)
+    , m_descriptorSize(device->GetDescriptorHandleIncrementSize(type))
+    , m_freeList(pageSize)
+{
+}
+
+DescriptorAllocator_DX12::Descriptor DescriptorAllocator_DX12::Allocate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_freeList.NeedsPage())
+    {
+        // the heap first, a failure leaves the free list without a page that has no heap behind it.
+        D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+        desc.NumDescriptors = m_freeList.GetPageSize();
+        desc.Type = m_type;
+        desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE; // staging, never bound
+
+        ComPtr<ID3D12DescriptorHeap> page;
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&page)));
+        m_pages.reserve(m_pages.size() + 1);
+        m_pageStarts.reserve(m_pageStarts.size() + 1);
+        m_pageStarts.push_back(page->GetCPUDescriptorHandleForHeapStart());
+        m_pages.push_back(page);
+    }
+
+    const uint32_t index = m_freeList.Allocate();
+    const uint32_t pageSize = m_freeList.GetPageSize();
+    Descriptor descriptor;
+    descriptor.index = index;
+    descriptor.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_pageStarts[index / pageSize], index % pageSize, m_descriptorSize);
+    return descriptor;
+}
+
+void DescriptorAllocator_DX12::Free(Descriptor& descriptor)
+{
+    if (!descriptor.IsValid())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_freeList.Free(descriptor.index);
+    descriptor = Descriptor();
+}
+
+PagedFreeList::Stats DescriptorAllocator_DX12::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_freeList.GetStats();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "graphics.h"
+#include "core/PagedFreeList.h"
+
+#include <mutex>
+#include <vector>
+
+// Persistent descriptors (views created once and kept as long as their resource) in CPU only descriptor heaps, a page
+// of pageSize descriptors at a time (PagedFreeList). These are the staging copies: shaders see them once copied into
+// the shader visible ring (DescriptorRing_DX12). Allocating and freeing are O(1) and thread safe.
+class DescriptorAllocator_DX12
+{
+public:
+    static const uint32_t DefaultPageSize = 256;
+
+    struct Descriptor
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle { 0 };
+        uint32_t index { PagedFreeList::InvalidIndex };
+
+        bool IsValid() const { return index != PagedFreeList::InvalidIndex; }
+    };
+
+    DescriptorAllocator_DX12(ComPtr<ID3D12Device> device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t pageSize = DefaultPageSize);
+
+    DescriptorAllocator_DX12(const DescriptorAllocator_DX12&) = delete;
+    DescriptorAllocator_DX12& operator=(const DescriptorAllocator_DX12&) = delete;
+
+    Descriptor Allocate();
+    // The descriptor can be freed as soon as nothing copies it anymore, the copies already made stay valid.
+    void Free(Descriptor& descriptor);
+
+    D3D12_DESCRIPTOR_HEAP_TYPE GetType() const { return m_type; }
+    UINT GetDescriptorSize() const { return m_descriptorSize; }
+    PagedFreeList::Stats GetStats() const;
+
+private:
+    ComPtr<ID3D12Device> m_device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    UINT m_descriptorSize;
+
+    mutable std::mutex m_mutex;
+    PagedFreeList m_freeList;
+    std::vector<ComPtr<ID3D12DescriptorHeap>> m_pages;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_pageStarts;
+};
@@ -0,0 +1,49 @@
+#include "stdafx.h"
+#include "DescriptorRing_DX12.h"
+
+DescriptorRing_DX12::DescriptorRing_DX12(ComPtr<ID3D12Device> device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity, FenceTimeline& timeline,
+    uint32_t reservedDescriptors)
+    : m_device(device)
+    , m_type(type)
+    , m_descriptorSize(device->GetDescriptorHandleIncrementSize(type))
+    , m_reservedDescriptors(reservedDescriptors)
+    , m_allocator(timeline, capacity)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+    desc.NumDescriptors = reservedDescriptors + capacity;
+    desc.Type = type;
+    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_heap)));
+    NAME_D3D12_OBJECT(m_heap);
+
+    m_cpuStart = m_heap->GetCPUDescriptorHandleForHeapStart();
+    m_gpuStart = m_heap->GetGPUDescriptorHandleForHeapStart();
+}
+
+DescriptorRing_DX12::Table DescriptorRing_DX12::Allocate(uint32_t count)
+{
+    Table table;
+    const uint64_t offset = count > 0 ? m_allocator.Allocate(count, 1) : LinearRingAllocator::InvalidOffset;
+    if (offset == LinearRingAllocator::InvalidOffset)
+    {
+        return table;
+    }
+
+    table.cpuHandle = GetCpuHandle(m_reservedDescriptors + static_cast<uint32_t>(offset));
+    table.gpuHandle = GetGpuHandle(m_reservedDescriptors + static_cast<uint32_t>(offset));
+    table.count = count;
+    table.descriptorSize = m_descriptorSize;
+    return table;
+}
+
+DescriptorRing_DX12::Table DescriptorRing_DX12::Copy(uint32_t count, const D3D12_CPU_DESCRIPTOR_HANDLE* sources)
+{
+    Table table = Allocate(count);
+    if (table.IsValid())
+    {
+        // one destination range, count source ranges of one descriptor each.
+        const UINT destinationSize = count;
+        m_device->CopyDescriptors(1, &table.cpuHandle, &destinationSize, count, sources, nullptr, m_type);
+    }
+    return table;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "graphics.h"
+#include "core/LinearRingAllocator.h"
+
+// Shader visible descriptor heap suballocated per frame like the upload ring (LinearRingAllocator, in descriptors
+// instead of bytes): the descriptor tables of a frame are copied in from the staging heaps (DescriptorAllocator_DX12)
+// and the space is handed back once the frame's fence value is reached. Only one heap of each type can be bound, the
+// scene lists get this one: its first reservedDescriptors descriptors are left out of the ring for the bindless table
+// (BindlessTable_DX12).
+class DescriptorRing_DX12
+{
+public:
+    struct Table
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle { 0 };
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle { 0 }; // SetGraphicsRootDescriptorTable
+        uint32_t count { 0 };
+        UINT descriptorSize { 0 };
+
+        bool IsValid() const { return count > 0; }
+        D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index) const { return CD3DX12_CPU_DESCRIPTOR_HANDLE(cpuHandle, index, descriptorSize); }
+        D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index) const { return CD3DX12_GPU_DESCRIPTOR_HANDLE(gpuHandle, index, descriptorSize); }
+    };
+
+    // type is CBV_SRV_UAV or SAMPLER, capacity in descriptors. timeline is the one of the queue using the tables.
+    DescriptorRing_DX12(ComPtr<ID3D12Device> device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity, FenceTimeline& timeline,
+        uint32_t reservedDescriptors = 0);
+
+    DescriptorRing_DX12(const DescriptorRing_DX12&) = delete;
+    DescriptorRing_DX12& operator=(const DescriptorRing_DX12&) = delete;
+
+    // count contiguous descriptors valid for the frame being recorded, invalid when the ring is full. Thread safe.
+    Table Allocate(uint32_t count);
+
+    // A table holding copies of sources (staging descriptors), in a single CopyDescriptors call. Thread safe.
+    Table Copy(uint32_t count, const D3D12_CPU_DESCRIPTOR_HANDLE* sources);
+
+    // Once per frame, after the signal of the submission using this frame's tables.
+    void EndFrame(uint64_t fenceValue) { m_allocator.EndFrame(fenceValue); }
+    // Hand back the tables of the frames the GPU is done with, doesn't block.
+    void RetireCompleted() { m_allocator.RetireCompleted(); }
+
+    ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+    UINT GetDescriptorSize() const { return m_descriptorSize; }
+    uint32_t GetReservedDescriptorCount() const { return m_reservedDescriptors; }
+    // Descriptor of the heap by index, from its start (the reserved descriptors come first).
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index) const { return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuStart, static_cast<INT>(index), m_descriptorSize); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index) const { return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_gpuStart, static_cast<INT>(index), m_descriptorSize); }
+    LinearRingAllocator::Stats GetStats() const { return m_allocator.GetStats(); } // in descriptors
+
+private:
+    ComPtr<ID3D12Device> m_device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    UINT m_descriptorSize;
+    uint32_t m_reservedDescriptors;
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart;
+    LinearRingAllocator m_allocator;
+};
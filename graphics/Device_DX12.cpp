@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "Device_DX12.h"
+
+D3D12_RESOURCE_STATES Device_DX12::ToD3D12(ResourceState state)
+{
+    switch (state)
+    {
+    case ResourceState::RenderTarget: return D3D12_RESOURCE_STATE_RENDER_TARGET;
+    case ResourceState::CopySource: return D3D12_RESOURCE_STATE_COPY_SOURCE;
+    case ResourceState::CopyDest: return D3D12_RESOURCE_STATE_COPY_DEST;
+    case ResourceState::ShaderResource: return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    case ResourceState::UnorderedAccess: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    case ResourceState::GenericRead: return D3D12_RESOURCE_STATE_GENERIC_READ;
+    case ResourceState::DepthWrite: return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    case ResourceState::DepthRead: return D3D12_RESOURCE_STATE_DEPTH_READ;
+    default: return D3D12_RESOURCE_STATE_PRESENT;
+    }
+}
+
+DXGI_FORMAT Device_DX12::ToD3D12(Format format)
+{
+    switch (format)
+    {
+    case Format::RGBA8Unorm: return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case Format::BGRA8Unorm: return DXGI_FORMAT_B8G8R8A8_UNORM;
+    case Format::R32Float: return DXGI_FORMAT_R32_FLOAT;
+    case Format::D32Float: return DXGI_FORMAT_D32_FLOAT;
+    default: return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+D3D12_COMMAND_LIST_TYPE Device_DX12::ToD3D12(QueueType type)
+{
+    switch (type)
+    {
+    case QueueType::Compute: return D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    case QueueType::Copy: return D3D12_COMMAND_LIST_TYPE_COPY;
+    default: return D3D12_COMMAND_LIST_TYPE_DIRECT;
+    }
+}
+
+D3D12_DESCRIPTOR_HEAP_TYPE Device_DX12::ToD3D12(DescriptorHeapType type)
+{
+    switch (type)
+    {
+    case DescriptorHeapType::DepthStencil: return D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+    case DescriptorHeapType::ShaderResource: return D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    case DescriptorHeapType::Sampler: return D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+    default: return D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    }
+}
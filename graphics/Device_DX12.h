@@ -0,0 +1,17 @@
+#pragma once
+#include "graphics.h"
+#include "core/Device.h"
+
+// Conversions from the enums of the abstract device layer (core/Device.h) to D3D12, for the D3D12 code built on the
+// platform independent parts (the queues of Framework_DX12, RenderGraph_DX12, ResourceStateTracker_DX12). Framework_DX12
+// drives D3D12 directly, the layer itself is only implemented by NullDevice.
+class Device_DX12
+{
+public:
+    Device_DX12() = delete;
+
+    static D3D12_RESOURCE_STATES ToD3D12(ResourceState state);
+    static DXGI_FORMAT ToD3D12(Format format);
+    static D3D12_COMMAND_LIST_TYPE ToD3D12(QueueType type);
+    static D3D12_DESCRIPTOR_HEAP_TYPE ToD3D12(DescriptorHeapType type);
+};
@@ -0,0 +1,137 @@
+#include "stdafx.h"
+#include "Fence_DX12.h"
+#include "core/Profiler.h"
+
+namespace
+{
+    // Every waiting thread gets its own event, an auto reset event shared between several waiters would only wake one of them.
+    struct ThreadFenceEvent
+    {
+        ThreadFenceEvent() : handle(::CreateEvent(NULL, FALSE, FALSE, NULL))
+        {
+            assert(handle && "Failed to create event.");
+        }
+        ~ThreadFenceEvent() { ::CloseHandle(handle); }
+
+        HANDLE handle;
+    };
+
+    HANDLE GetThreadFenceEvent()
+    {
+        thread_local ThreadFenceEvent fenceEvent;
+        return fenceEvent.handle;
+    }
+}
+
+Fence_DX12::Fence_DX12(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> commandQueue, UINT64 initialValue)
+    : m_commandQueue(commandQueue)
+{
+    ThrowIfFailed(device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+}
+
+void Fence_DX12::Signal(uint64_t value)
+{
+    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), value));
+}
+
+uint64_t Fence_DX12::GetCompletedValue() const
+{
+    return m_fence->GetCompletedValue();
+}
+
+bool Fence_DX12::Wait(uint64_t value, std::chrono::milliseconds timeout)
+{
+    if (m_fence->GetCompletedValue() >= value)
+    {
+        return true;
+    }
+
+    PROFILE_ZONE("Fence wait");
+
+    // the thread's event can still be armed by an earlier wait that timed out on another value and wake this one up
+    // early: only the fence says when value is reached, the event is armed again until then.
+    HANDLE fenceEvent = GetThreadFenceEvent();
+    const bool infinite = timeout == std::chrono::milliseconds::max();
+    const auto deadline = infinite ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now() + timeout;
+    while (m_fence->GetCompletedValue() < value)
+    {
+        DWORD milliseconds = INFINITE;
+        if (!infinite)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                return false;
+            }
+            // rounded up, a 0 ms wait would spin until the deadline.
+            milliseconds = static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+        }
+
+        ThrowIfFailed(m_fence->SetEventOnCompletion(value, fenceEvent));
+        if (::WaitForSingleObject(fenceEvent, milliseconds) == WAIT_FAILED)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+FenceWaitMultiplexer_DX12::FenceWaitMultiplexer_DX12()
+    : m_wakeEvent(::CreateEvent(NULL, FALSE, FALSE, NULL))
+{
+    assert(m_wakeEvent && "Failed to create event.");
+}
+
+FenceWaitMultiplexer_DX12::~FenceWaitMultiplexer_DX12()
+{
+    for (HANDLE fenceEvent : m_fenceEvents)
+    {
+        ::CloseHandle(fenceEvent);
+    }
+    ::CloseHandle(m_wakeEvent);
+}
+
+void FenceWaitMultiplexer_DX12::WaitAny(const std::vector<FenceWait>& waits, std::chrono::milliseconds timeout)
+{
+    // slot 0 is the wake event, the rest are fence events; waits past the handle limit are picked up on later rounds.
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    handles[0] = m_wakeEvent;
+
+    DWORD handleCount = 1;
+    bool polled = false;
+    for (const FenceWait& wait : waits)
+    {
+        Fence_DX12* fence = dynamic_cast<Fence_DX12*>(wait.timeline->GetBackend());
+        if (!fence || handleCount == MAXIMUM_WAIT_OBJECTS)
+        {
+            polled = true;
+            continue;
+        }
+
+        const size_t eventIndex = handleCount - 1;
+        if (eventIndex == m_fenceEvents.size())
+        {
+            HANDLE fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+            assert(fenceEvent && "Failed to create event.");
+            m_fenceEvents.push_back(fenceEvent);
+        }
+
+        // an event reused from an earlier round may still be armed for a value not reached yet, at worst it wakes
+        // this wait up early and the service checks again.
+        ThrowIfFailed(fence->GetFence()->SetEventOnCompletion(wait.value, m_fenceEvents[eventIndex]));
+        handles[handleCount++] = m_fenceEvents[eventIndex];
+    }
+
+    DWORD milliseconds = timeout == std::chrono::milliseconds::max() ? INFINITE : static_cast<DWORD>(timeout.count());
+    if (polled)
+    {
+        milliseconds = std::min<DWORD>(milliseconds, 1);
+    }
+
+    ::WaitForMultipleObjects(handleCount, handles, FALSE, milliseconds);
+}
+
+void FenceWaitMultiplexer_DX12::Wake()
+{
+    ::SetEvent(m_wakeEvent);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "graphics.h"
+#include "core/FenceTimeline.h"
+#include "core/FenceWaitService.h"
+
+#include <vector>
+
+// FenceBackend on top of an ID3D12Fence signaled by a single command queue.
+class Fence_DX12 : public FenceBackend
+{
+public:
+    Fence_DX12(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> commandQueue, UINT64 initialValue = 0);
+
+    virtual void Signal(uint64_t value) override;
+    virtual uint64_t GetCompletedValue() const override;
+    virtual bool Wait(uint64_t value, std::chrono::milliseconds timeout) override;
+
+    ID3D12Fence* GetFence() const { return m_fence.Get(); }
+    ID3D12CommandQueue* GetCommandQueue() const { return m_commandQueue.Get(); }
+
+private:
+    ComPtr<ID3D12Fence> m_fence;
+    ComPtr<ID3D12CommandQueue> m_commandQueue;
+};
+
+// Waits on the fences of many timelines at once: one event per pending wait armed with SetEventOnCompletion, plus a wake
+// event, all in a single WaitForMultipleObjects. Timelines not backed by a Fence_DX12 are polled.
+class FenceWaitMultiplexer_DX12 : public FenceWaitMultiplexer
+{
+public:
+    FenceWaitMultiplexer_DX12();
+    ~FenceWaitMultiplexer_DX12();
+
+    FenceWaitMultiplexer_DX12(const FenceWaitMultiplexer_DX12&) = delete;
+    FenceWaitMultiplexer_DX12& operator=(const FenceWaitMultiplexer_DX12&) = delete;
+
+    virtual void WaitAny(const std::vector<FenceWait>& waits, std::chrono::milliseconds timeout) override;
+    virtual void Wake() override;
+
+private:
+    HANDLE m_wakeEvent;
+    std::vector<HANDLE> m_fenceEvents;
+};
@@ -1,6 +1,26 @@
 #include "stdafx.h"
 #include "Win32Application.h"
 
+namespace
+{
+    std::string ToNarrowString(const WCHAR* text)
+    {
+        std::string narrow;
+        const int size = ::WideCharToMultiByte(CP_ACP, 0, text, -1, nullptr, 0, nullptr, nullptr);
+        if (size > 1)
+        {
+            narrow.resize(size - 1);
+            ::WideCharToMultiByte(CP_ACP, 0, text, -1, &narrow[0], size, nullptr, nullptr);
+        }
+        return narrow;
+    }
+
+    bool IsNumber(const WCHAR* text)
+    {
+        return iswdigit(text[0]) != 0;
+    }
+}
+
 Framework::Framework(UINT width, UINT height)
     : m_width(width)
     , m_height(height)
@@ -12,4 +32,95 @@ Framework::Framework(UINT width, UINT height)
 _Use_decl_annotations_
 void Framework::ParseCommandLineArgs(WCHAR* argv[], int argc)
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        // -headless [frames]: render offscreen without a window and report the throughput.
+        if (_wcsicmp(argv[i], L"-headless") == 0)
+        {
+            UINT frameCount = DefaultHeadlessFrameCount;
+            if (i + 1 < argc && IsNumber(argv[i + 1]))
+            {
+                frameCount = static_cast<UINT>(_wtoi(argv[++i]));
+            }
+            SetHeadless(true, frameCount);
+        }
+
+        // -trace <file>: save a Chrome trace of the CPU profiler zones to file on exit.
+        if (_wcsicmp(argv[i], L"-trace") == 0 && i + 1 < argc)
+        {
+            m_traceFile = ToNarrowString(argv[++i]);
+        }
+
+        // -benchmark [frames]: measure frames after the warmup, print the report and write it as JSON, then exit.
+        if (_wcsicmp(argv[i], L"-benchmark") == 0)
+        {
+            m_benchmarkRequested = true;
+            if (i + 1 < argc && IsNumber(argv[i + 1]))
+            {
+                m_benchmarkSettings.measuredFrames = static_cast<UINT>(_wtoi(argv[++i]));
+            }
+        }
+
+        // -warmup <frames>: frames rendered before the benchmark starts measuring.
+        if (_wcsicmp(argv[i], L"-warmup") == 0 && i + 1 < argc && IsNumber(argv[i + 1]))
+        {
+            m_benchmarkSettings.warmupFrames = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+
+        // -report <file>: where the benchmark report is written.
+        if (_wcsicmp(argv[i], L"-report") == 0 && i + 1 < argc)
+        {
+            m_benchmarkSettings.reportFile = ToNarrowString(argv[++i]);
+        }
+
+        // -resolution <width>x<height>: size of the window, or of the offscreen targets in headless mode.
+        if (_wcsicmp(argv[i], L"-resolution") == 0 && i + 1 < argc)
+        {
+            UINT width = 0;
+            UINT height = 0;
+            if (swscanf_s(argv[++i], L"%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+            {
+                SetWidthHeight(width, height);
+            }
+        }
+
+        // -vsync: present on the vertical blank.
+        if (_wcsicmp(argv[i], L"-vsync") == 0)
+        {
+            SetVSync(true);
+        }
+
+        // -buffers <count>: back buffers of the swap chain (offscreen targets in headless mode).
+        if (_wcsicmp(argv[i], L"-buffers") == 0 && i + 1 < argc && IsNumber(argv[i + 1]))
+        {
+            m_requestedBufferCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+    }
+}
+
+void Framework::RunFrame()
+{
+    PROFILE_ZONE("Frame");
+
+    {
+        PROFILE_ZONE("BeginFrame");
+        BeginFrame();
+    }
+
+    m_framePipeline.RunFrame(GetJobSystem(),
+        [this]()
+        {
+            PROFILE_ZONE("Simulate");
+            StepSimulation();
+            m_interpolationAlpha.Back() = m_fixedTimestep.GetAlpha();
+            Update();
+        },
+        [this]()
+        {
+            m_interpolationAlpha.Publish();
+            PublishFrame();
+        },
+        [this]() { Render(); });
+
+    m_benchmark.EndFrame(m_clock->Now());
 }
@@ -1,4 +1,9 @@
 #pragma once
+#include "core/Clock.h"
+#include "core/FixedTimestep.h"
+#include "core/FrameBenchmark.h"
+#include "core/FramePipeline.h"
+#include "core/Profiler.h"
 
 class Framework
 {
@@ -7,9 +12,13 @@ public:
     virtual ~Framework() {}
 
     virtual void Init() = 0;
-    virtual void Update() = 0;
-    virtual void Render() = 0;
+    virtual void BeginFrame() {} // called at the start of every frame, before Update(). May block to throttle the frame rate.
+    virtual void FixedUpdate(double /*stepSeconds*/) {} // simulation step, zero or more times per frame at the fixed timestep rate, before Update()
+    virtual void Update() = 0; // once per frame, variable step
+    virtual void Render() = 0; // interpolates the simulation state by GetInterpolationAlpha()
+    virtual void PublishFrame() {} // pipelined frames: make the state Update() just wrote the one Render() reads, see SetPipelinedFrames()
     virtual void Release() = 0;
+    virtual void WaitForGpu() {} // until the GPU is done with every frame submitted so far, before the window goes away
     virtual void Resize(UINT32 width, UINT32 height) {};
     virtual void KeyDown(UINT8 /*key*/) {}
     virtual void KeyUp(UINT8 /*key*/) {}
@@ -19,12 +28,53 @@ public:
     UINT GetWidth() const { return m_width; }
     UINT GetHeight() const { return m_height; }
     float GetAspectRatio() const { return m_aspectRatio; }
+    UINT GetTargetFrameRate() const { return m_targetFrameRate; } // frames per second the main loop paces to, 0 for as fast as possible
+    const std::string& GetTraceFile() const { return m_traceFile; } // where the profiler trace is saved on exit, empty for none
+    bool IsHeadless() const { return m_headless; } // no window: render offscreen, GetHeadlessFrameCount() frames as fast as possible
+    UINT GetHeadlessFrameCount() const { return m_headlessFrameCount; }
+    bool IsVSync() const { return m_vSync; } // presents wait for the vertical blank
+    virtual UINT GetBackBufferCount() const { return m_requestedBufferCount; } // 0 until the renderer picks its default
 
     void ParseCommandLineArgs(_In_reads_(argc) WCHAR* argv[], int argc);
 
+    // One frame: BeginFrame(), the simulation stage (fixed steps then Update()), PublishFrame() and Render().
+    void RunFrame();
+
+    // Pipelined frames: the simulation stage of the next frame runs on a worker of GetJobSystem() while Render() records
+    // the current one. Update() and FixedUpdate() must then only write the back packet of a FramePackets, Render() only
+    // read the front one, and PublishFrame() swap them. Off by default, Update() and Render() share the state otherwise.
+    void SetPipelinedFrames(bool enabled) { m_framePipeline.SetEnabled(enabled); }
+    bool IsPipelinedFrames() const { return m_framePipeline.IsEnabled(); }
+    void FlushFrames() { m_framePipeline.Flush(); } // wait for the simulation in flight, before touching its state from another stage (input, release)
+    const FramePipeline::Stats& GetFramePipelineStats() const { return m_framePipeline.GetStats(); }
+    virtual JobSystem* GetJobSystem() { return nullptr; } // runs the simulation stage, the stages run back to back without one
+
+    // Fixed timestep simulation.
+    void StepSimulation() { m_fixedTimestep.Advance([this](double stepSeconds) { FixedUpdate(stepSeconds); }); } // runs the FixedUpdate() steps due, once per frame
+    double GetInterpolationAlpha() const { return m_interpolationAlpha.Front(); } // of the frame being rendered: fraction of a step between its last simulated state and its time
+    void SetClock(Clock& clock) { m_clock = &clock; m_fixedTimestep.SetClock(clock); } // time source of the simulation and the benchmark, the framework doesn't own it
+    void SetFixedTimestep(UINT stepsPerSecond, UINT maxStepsPerFrame);
+    const FixedTimestep::Stats& GetFixedTimestepStats() const { return m_fixedTimestep.GetStats(); }
+
+    // Benchmark mode (-benchmark): warmup frames, then measured frames whose CPU, GPU, fence wait and present times are
+    // reported. StartBenchmark() once initialized and on the final clock, every RunFrame() then counts as a frame.
+    bool IsBenchmark() const { return m_benchmarkRequested; }
+    void StartBenchmark() { m_benchmark.Start(m_benchmarkSettings, m_clock->Now()); }
+    const FrameBenchmark& GetBenchmark() const { return m_benchmark; }
+
 protected:
     void SetWidthHeight(UINT w, UINT h);
     void SetInitialized() { m_initialized = true; }
+    void SetTargetFrameRate(UINT frameRate) { m_targetFrameRate = frameRate; }
+    void SetHeadless(bool headless, UINT frameCount = DefaultHeadlessFrameCount) { m_headless = headless; m_headlessFrameCount = frameCount; }
+    void SetVSync(bool vSync) { m_vSync = vSync; }
+    UINT GetRequestedBufferCount() const { return m_requestedBufferCount; } // -buffers, 0 for the renderer's default
+
+    // Benchmark samples, ignored outside of the measured frames. frame is the RunFrame() count the sample belongs to.
+    void RecordBenchmark(FrameBenchmark::Metric metric, double milliseconds) { m_benchmark.Record(metric, milliseconds); }
+    void RecordBenchmark(FrameBenchmark::Metric metric, uint64_t frame, double milliseconds) { m_benchmark.Record(metric, frame, milliseconds); }
+
+    static const UINT DefaultHeadlessFrameCount { 1000 };
 
 private:
     // Viewport dimensions.
@@ -32,10 +82,34 @@ private:
     UINT m_height;
     float m_aspectRatio;
     
+    UINT m_targetFrameRate{ 60 };
+    std::string m_traceFile;
+    bool m_headless{ false };
+    UINT m_headlessFrameCount{ DefaultHeadlessFrameCount };
+    bool m_vSync{ false };
+    UINT m_requestedBufferCount{ 0 };
+
+    SteadyClock m_defaultClock;
+    Clock* m_clock{ &m_defaultClock };
+    FixedTimestep m_fixedTimestep{ m_defaultClock };
+
+    FramePipeline m_framePipeline;
+    FramePackets<double> m_interpolationAlpha; // captured by the simulation stage, published with the frame
+
+    bool m_benchmarkRequested{ false };
+    FrameBenchmark::Settings m_benchmarkSettings;
+    FrameBenchmark m_benchmark;
+
     bool m_initialized{ false };
 };
 
 
+inline void Framework::SetFixedTimestep(UINT stepsPerSecond, UINT maxStepsPerFrame)
+{
+    m_fixedTimestep.SetStep(FixedTimestep::StepFromRate(stepsPerSecond));
+    m_fixedTimestep.SetMaxStepsPerFrame(maxStepsPerFrame);
+}
+
 inline void Framework::SetWidthHeight(UINT w, UINT h)
 {
     m_width = w;
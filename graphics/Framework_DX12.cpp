@@ -1,9 +1,10 @@
 #include "stdafx.h"
 #include "Framework_DX12.h"
+#include "Clock_Win32.h"
+#include "Device_DX12.h"
 #include "Win32Application.h"
 
 // TODO: Check ThrowIfFailed for input parameters, it should always be HRESULT
-// TODO: How many back buffers do we need in the swap chain 2,3 or 4
 
 namespace
 {
@@ -80,9 +81,19 @@ Framework_DX12::~Framework_DX12()
 
 void Framework_DX12::Init()
 {
+    PROFILE_FUNCTION();
+
     UINT dxgiFactoryFlags = 0;
 
-    Win32Application::SetCustomWindowText(_T("Framework_DX12"));
+    if (GetRequestedBufferCount() > 0)
+    {
+        SetBackBufferCount(GetRequestedBufferCount());
+    }
+
+    if (!IsHeadless())
+    {
+        Win32Application::SetCustomWindowText(_T("Framework_DX12"));
+    }
 
     if (m_enableDebugLayer)
     {
@@ -133,7 +144,43 @@ void Framework_DX12::Init()
 
     m_device = CreateDevice(dxgiAdapter);
 
-    m_commandQueue = CreateCommandQueue(m_device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    // one queue per type, each with its own fence and command allocator pool. Compute and copy work submitted to their own
+    // queues overlaps with graphics, the cross queue dependencies are turned into GPU side waits by the queue scheduler.
+    for (UINT queue = 0; queue < static_cast<UINT>(QueueType::Count); ++queue)
+    {
+        const auto queueType = static_cast<QueueType>(queue);
+        const auto commandListType = Device_DX12::ToD3D12(queueType);
+
+        m_commandQueues[queue] = CreateCommandQueue(m_device, commandListType);
+        m_fences[queue] = std::make_unique<Fence_DX12>(m_device, m_commandQueues[queue]);
+        m_timelines[queueType].Bind(m_fences[queue].get());
+        m_commandAllocatorPools[queue] = CreateCommandAllocatorPool(m_device, commandListType, m_timelines[queueType]);
+
+        NAME_D3D12_OBJECT_INDEXED(m_commandQueues, queue);
+    }
+
+    m_queueScheduler = std::make_unique<QueueScheduler>(m_timelines, [this](QueueType waitingQueue, const SyncPoint& point)
+    {
+        ThrowIfFailed(GetCommandQueue(waitingQueue)->Wait(m_fences[static_cast<UINT>(point.queue)]->GetFence(), point.value));
+    });
+
+    m_uploadRing = std::make_unique<UploadRing_DX12>(m_device, m_timelines[QueueType::Direct], m_uploadRingSize);
+    m_heapAllocator = std::make_unique<HeapAllocator_DX12>(m_device);
+    m_rootSignatureCache = std::make_unique<RootSignatureCache_DX12>(m_device);
+    if (!m_rootSignatureCachePath.empty())
+    {
+        m_rootSignatureCache->LoadBlobs(m_rootSignatureCachePath);
+    }
+
+    for (UINT type = 0; type < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++type)
+    {
+        m_descriptorAllocators[type] = std::make_unique<DescriptorAllocator_DX12>(m_device, static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(type));
+    }
+    // one shader visible CBV/SRV/UAV heap can be bound at a time: the bindless table is its front, the ring the rest.
+    m_descriptorRing = std::make_unique<DescriptorRing_DX12>(m_device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_descriptorRingSize,
+        m_timelines[QueueType::Direct], m_bindlessTableSize);
+    m_bindlessTable = std::make_unique<BindlessTable_DX12>(m_device, m_descriptorRing->GetHeap(), m_bindlessTableSize, m_timelines[QueueType::Direct]);
+    m_renderGraph = std::make_unique<RenderGraph_DX12>(m_device, [this](ComPtr<IUnknown> object) { DeferredRelease(std::move(object)); });
 
     BOOL allowTearing = FALSE;
     if (FAILED(dxgiFactory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
@@ -141,32 +188,80 @@ void Framework_DX12::Init()
         LOG("Failed to check tearing support\n");
     }
 
-    m_swapChain = CreateSwapChain(Win32Application::GetHwnd(), dxgiFactory, m_commandQueue, GetWidth(), GetHeight(), FrameBufferCount, allowTearing);
-    
-    m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
-
-    m_rtvDescriptorHeap = CreateDescriptorHeap(m_device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, FrameBufferCount);
+    m_rtvDescriptorHeap = CreateDescriptorHeap(m_device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, m_backBufferCount);
     m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
-    UpdateRenderTargetViews(m_device, m_swapChain, m_rtvDescriptorHeap, FrameBufferCount);
+    m_backBuffers.resize(m_backBufferCount);
+    m_backBufferFenceValues.assign(m_backBufferCount, 0);
 
-    for (UINT i = 0; i < FrameBufferCount; ++i)
+    if (IsHeadless())
+    {
+        // no window: the frames render into a ring of offscreen targets standing in for the back buffers.
+        m_presenter = std::make_unique<OffscreenPresenter>(m_timelines[QueueType::Direct], m_backBufferCount);
+        CreateOffscreenRenderTargets(m_device, m_rtvDescriptorHeap, m_backBufferCount, GetWidth(), GetHeight());
+    }
+    else
     {
-        m_commandAllocators[i] = CreateCommandAllocator(m_device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        m_swapChain = CreateSwapChain(Win32Application::GetHwnd(), dxgiFactory, GetCommandQueue(QueueType::Direct), GetWidth(), GetHeight(), m_backBufferCount, allowTearing, m_lowLatencyMode);
+
+        if (m_lowLatencyMode)
+        {
+            // the frame waits for DXGI at its start (BeginFrame) rather than being throttled inside Present().
+            ThrowIfFailed(m_swapChain->SetMaximumFrameLatency(m_maxFrameLatency));
+            m_frameLatencyWaitableObject = m_swapChain->GetFrameLatencyWaitableObject();
+        }
+
+        m_presenter = std::make_unique<SwapChainPresenter_DX12>(m_swapChain, m_supportTearing);
+        UpdateRenderTargetViews(m_device, m_swapChain, m_rtvDescriptorHeap, m_backBufferCount);
     }
 
-    m_commandList = CreateCommandList(m_device, m_commandAllocators[m_currentBackBufferIndex], D3D12_COMMAND_LIST_TYPE_DIRECT);
+    m_currentBackBufferIndex = m_presenter->GetCurrentBufferIndex();
+
+    auto& directAllocatorPool = GetCommandAllocatorPool(QueueType::Direct);
+
+    // the command list is created closed, its allocator has nothing in flight and goes straight back to the pool.
+    auto commandAllocator = directAllocatorPool.Acquire();
+    m_commandList = CreateCommandList(m_device, commandAllocator, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    m_endFrameCommandList = CreateCommandList(m_device, commandAllocator, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    directAllocatorPool.Release(std::move(commandAllocator), m_timelines[QueueType::Direct].GetLastSignaledValue());
 
-    m_fence = CreateFence(m_device);
-    m_fenceEvent = CreateEventHandle();
-    m_fenceValue = 0;
-    for (UINT i = 0; i < FrameBufferCount; ++i) 
-        m_fenceValuesPerFrame[i] = 0;
+    // in automatic mode the latency moves within the controller's range, the ring covers the largest one.
+    const UINT maxFrameLatency = m_autoFrameLatency ? m_frameLatencyController.GetSettings().maxLatency : m_frameLatency;
+    m_frameFenceValues.assign(maxFrameLatency, 0);
+
+    // one query slot per frame in flight and one for the frame being recorded.
+    m_gpuProfiler = std::make_unique<GpuProfiler_DX12>(m_device, GetCommandQueue(QueueType::Direct), maxFrameLatency + 1, "GPU direct queue");
+    m_gpuProfiler->SetPassCallback([this](uint64_t frame, const char* name, double milliseconds)
+    {
+        // one profiler frame per Render(), the same count as the benchmark's frames.
+        if (strcmp(name, GpuFramePassName) == 0)
+        {
+            RecordBenchmark(FrameBenchmark::Metric::GpuFrame, frame, milliseconds);
+        }
+    });
+    m_frameIndex = 0;
+    m_lastFrameStart = std::chrono::steady_clock::now();
+
+    m_jobSystem = std::make_unique<JobSystem>();
+    m_sceneRecorder = std::make_unique<ParallelRecorder_DX12>(m_device, D3D12_COMMAND_LIST_TYPE_DIRECT, directAllocatorPool, *m_jobSystem);
+
+    m_fenceWaitMultiplexer = std::make_unique<FenceWaitMultiplexer_DX12>();
+    m_fenceWaitService = std::make_unique<FenceWaitService>(*m_fenceWaitMultiplexer, m_jobSystem.get());
 
     // initialization complete!
     SetInitialized();
 }
 
+void Framework_DX12::BeginFrame()
+{
+    if (m_frameLatencyWaitableObject)
+    {
+        // block until the swap chain can take another frame, before the frame samples any input.
+        PROFILE_ZONE("Frame latency waitable");
+        ::WaitForSingleObjectEx(m_frameLatencyWaitableObject, 1000, TRUE);
+    }
+}
+
 void Framework_DX12::Update()
 {
     
@@ -174,24 +269,40 @@ void Framework_DX12::Update()
 
 void Framework_DX12::Render()
 {
-    auto commandAllocator = m_commandAllocators[m_currentBackBufferIndex];
+    PROFILE_FUNCTION();
+
+    ApplyPendingResize();
+
+    const auto frameStart = std::chrono::steady_clock::now();
+    const double frameMs = std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count();
+    m_lastFrameStart = frameStart;
+    RecordBenchmark(FrameBenchmark::Metric::CpuFrame, frameMs);
+
+    // the space of the frames the GPU is done with is available again for this one.
+    m_uploadRing->RetireCompleted();
+    m_descriptorRing->RetireCompleted();
+    m_bindlessTable->RetireCompleted();
+
+    auto& commandAllocatorPool = GetCommandAllocatorPool(QueueType::Direct);
+    auto commandAllocator = commandAllocatorPool.Acquire(); // already reset by the pool
     auto backBuffer = m_backBuffers[m_currentBackBufferIndex];
 
-    commandAllocator->Reset();
-    m_commandList->Reset(commandAllocator.Get(), nullptr);
+    ThrowIfFailed(m_commandList->Reset(commandAllocator.Get(), nullptr));
+    m_frameCommandLists.clear();
 
-    // clear the render target
-    {
-        // transition the back buffer to render target
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            backBuffer.Get(),
-            D3D12_RESOURCE_STATE_PRESENT,
-            D3D12_RESOURCE_STATE_RENDER_TARGET
-        );
+    // GPU time of the whole frame, from the first list to the last one.
+    m_gpuProfiler->BeginFrame(m_timelines[QueueType::Direct]);
+    const UINT gpuFramePass = m_gpuProfiler->BeginPass(m_commandList.Get(), GpuFramePassName);
 
-        m_commandList->ResourceBarrier(1, &barrier);
+    // the frame as a render graph: the back buffer goes from present to render target and back, passes nothing
+    // depends on are culled and the barriers in between are batched.
+    RenderGraph_DX12& graph = *m_renderGraph;
+    graph.Reset();
+    const auto backBufferResource = graph.ImportResource("Back buffer", backBuffer.Get(), ResourceState::Present, ResourceState::Present);
 
-        // clear the back buffer
+    // clear the render target
+    const auto clearPass = graph.AddPass("Clear", [this](ID3D12GraphicsCommandList* commandList)
+    {
         FLOAT clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
         CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(
             m_rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), // start of the heap
@@ -199,70 +310,331 @@ void Framework_DX12::Render()
             m_rtvDescriptorSize // size of increment
         );
 
-        m_commandList->ClearRenderTargetView(rtv, clearColor, 0, nullptr);
+        commandList->ClearRenderTargetView(rtv, clearColor, 0, nullptr);
+    });
+    graph.Write(clearPass, backBufferResource, ResourceState::RenderTarget);
+
+    AddRenderPasses(graph, backBufferResource);
+
+    // recorded by the scene recorder in its own lists, the graph only records the barriers in front of it.
+    const auto scenePass = graph.AddPass("Scene", nullptr);
+    graph.Write(scenePass, backBufferResource, ResourceState::RenderTarget);
+
+    {
+        PROFILE_ZONE("Render graph");
+        graph.Compile();
+        graph.RecordUntil(m_commandList.Get(), scenePass);
+    }
+
+    // record the scene in parallel, each worker into its own command list, between the clear and the transition to present.
+    auto endFrameCommandList = m_commandList;
+    if (m_sceneCommandListCount > 0)
+    {
+        {
+            PROFILE_ZONE("Close");
+            ThrowIfFailed(m_commandList->Close());
+        }
+        m_frameCommandLists.push_back(m_commandList.Get());
+
+        const UINT listCount = m_sceneCommandListCount;
+        while (m_sceneStateTrackers.size() < listCount)
+        {
+            m_sceneStateTrackers.push_back(std::make_unique<ResourceStateTracker_DX12>(m_resourceStates));
+        }
+
+        const size_t firstSceneList = m_frameCommandLists.size();
+        m_sceneRecorder->Record(listCount, [this, listCount](ID3D12GraphicsCommandList* commandList, UINT listIndex)
+        {
+            GPU_PROFILE_ZONE(m_gpuProfiler.get(), commandList, "Scene");
+            ResourceStateTracker_DX12& stateTracker = GetSceneStateTracker(listIndex);
+            stateTracker.Reset();
+
+            ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorRing->GetHeap() };
+            commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+            RecordScene(commandList, listIndex, listCount);
+            stateTracker.Flush(commandList);
+        }, m_frameCommandLists);
+
+        ResolveSceneStates(commandAllocator.Get(), firstSceneList, listCount);
+
+        // the first list is closed, the allocator is free to record the end of the frame.
+        endFrameCommandList = m_endFrameCommandList;
+        ThrowIfFailed(endFrameCommandList->Reset(commandAllocator.Get(), nullptr));
     }
 
     // present the render target
     {
-        // transition the back buffer to present
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            backBuffer.Get(),
-            D3D12_RESOURCE_STATE_RENDER_TARGET,
-            D3D12_RESOURCE_STATE_PRESENT
-        );
+        // the back buffer back to present
+        graph.RecordRemaining(endFrameCommandList.Get());
+
+        m_gpuProfiler->EndPass(endFrameCommandList.Get(), gpuFramePass);
+        m_gpuProfiler->ResolveFrame(endFrameCommandList.Get());
+
+        // close then execute every command list of the frame, in recording order, in a single submission
+        {
+            PROFILE_ZONE("Close");
+            ThrowIfFailed(endFrameCommandList->Close());
+        }
+        m_frameCommandLists.push_back(endFrameCommandList.Get());
 
-        m_commandList->ResourceBarrier(1, &barrier);
+        auto& directTimeline = m_timelines[QueueType::Direct];
 
-        // close then execute the command list
-        ThrowIfFailed(m_commandList->Close());
+        // the GPU has been idle since the previous frame completed, not enough frames in flight to keep it busy.
+        const bool gpuIdleAtSubmit = m_autoFrameLatency && directTimeline.IsComplete(directTimeline.GetLastSignaledValue());
 
-        ID3D12CommandList* const commandLists[] = { m_commandList.Get() };
-        m_commandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+        // wait on the GPU for the compute and copy work this frame depends on.
+        {
+            PROFILE_ZONE("ExecuteCommandLists");
+            m_queueScheduler->Resolve(QueueType::Direct);
+            GetCommandQueue(QueueType::Direct)->ExecuteCommandLists(static_cast<UINT>(m_frameCommandLists.size()), m_frameCommandLists.data());
+        }
 
         // present back buffer
-        const UINT syncInterval = m_vSyncEnabled ? 1 : 0;
-        const UINT presentFlags = m_supportTearing && !m_vSyncEnabled ? DXGI_PRESENT_ALLOW_TEARING : 0;
-        ThrowIfFailed(m_swapChain->Present(syncInterval, presentFlags));
+        {
+            PROFILE_ZONE("Present");
+            const auto presentStart = std::chrono::steady_clock::now();
+            m_presenter->Present(IsVSync());
+            RecordBenchmark(FrameBenchmark::Metric::Present, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - presentStart).count());
+        }
 
-        m_fenceValuesPerFrame[m_currentBackBufferIndex] = SignalFenceGPU(m_commandQueue, m_fence, m_fenceValue);
+        // match the presents to the moment they reach the display. The statistics aren't available in every
+        // presentation mode (windowed composition for instance), the latency is only recorded when they are.
+        UINT presentCount = 0;
+        if (m_swapChain && SUCCEEDED(m_swapChain->GetLastPresentCount(&presentCount)))
+        {
+            m_presentLatency.OnPresent(presentCount, Clock_Win32::QpcNowNanoseconds());
+        }
+
+        DXGI_FRAME_STATISTICS frameStatistics = {};
+        if (m_swapChain && SUCCEEDED(m_swapChain->GetFrameStatistics(&frameStatistics)))
+        {
+            m_presentLatency.OnDisplayed(frameStatistics.PresentCount, Clock_Win32::QpcToNanoseconds(frameStatistics.SyncQPCTime.QuadPart));
+        }
+
+        const uint64_t frameFenceValue = directTimeline.Signal();
+        m_frameFenceValues[m_frameIndex % m_frameFenceValues.size()] = frameFenceValue;
+        m_backBufferFenceValues[m_currentBackBufferIndex] = frameFenceValue;
+        ++m_frameIndex;
+
+        commandAllocatorPool.Release(std::move(commandAllocator), frameFenceValue);
+        m_deferredReleases.EndFrame(SyncPoint{ QueueType::Direct, frameFenceValue });
+        m_deferredAllocations.EndFrame(SyncPoint{ QueueType::Direct, frameFenceValue });
+        m_sceneRecorder->Submitted(frameFenceValue);
+        m_uploadRing->EndFrame(frameFenceValue);
+        m_descriptorRing->EndFrame(frameFenceValue);
+        m_bindlessTable->EndFrame(frameFenceValue);
+        m_gpuProfiler->EndFrame(frameFenceValue);
+
+        m_presenter->FrameSubmitted(frameFenceValue);
+        m_currentBackBufferIndex = m_presenter->GetCurrentBufferIndex();
+
+        // at most m_frameLatency frames in flight, counting the next one: wait for the frame submitted m_frameLatency frames ago.
+        // Only blocks when the cached completed value and the fence itself are both behind.
+        const auto waitStart = std::chrono::steady_clock::now();
+        if (m_frameIndex >= m_frameLatency)
+        {
+            PROFILE_ZONE("Frame latency wait");
+            directTimeline.Wait(m_frameFenceValues[(m_frameIndex - m_frameLatency) % m_frameFenceValues.size()]);
+        }
+        const double fenceWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        RecordBenchmark(FrameBenchmark::Metric::FenceWait, fenceWaitMs);
 
-        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+        if (m_autoFrameLatency && m_frameLatencyController.RecordFrame(gpuIdleAtSubmit, fenceWaitMs, frameMs))
+        {
+            m_frameLatency = m_frameLatencyController.GetLatency();
+            LOG("Frame latency: %u frames in flight\n", m_frameLatency);
+        }
 
-        WaitForFenceValue(m_fence, m_fenceValuesPerFrame[m_currentBackBufferIndex], m_fenceEvent);
+        m_deferredReleases.Collect(m_timelines);
+        m_deferredAllocations.Collect(m_timelines);
+        m_gpuProfiler->Collect(directTimeline);
     }
 }
 
 void Framework_DX12::Release()
 {
-    FlushGPUCommandQueue(m_commandQueue, m_fence, m_fenceValue, m_fenceEvent);
+    PROFILE_FUNCTION();
+
+    for (UINT queue = 0; queue < static_cast<UINT>(QueueType::Count); ++queue)
+    {
+        m_timelines[static_cast<QueueType>(queue)].Flush();
+    }
+
+    // every fence has been reached, the pending waits resume before the service thread stops.
+    m_fenceWaitService.reset();
+    m_fenceWaitMultiplexer.reset();
+
+    m_deferredReleases.ReleaseAll();
+    m_deferredAllocations.ReleaseAll();
+
+    m_gpuProfiler->Collect(m_timelines[QueueType::Direct]);
+    for (const auto& pass : m_gpuProfiler->GetPassStatistics())
+    {
+        LOG("GPU %s: %.3f ms avg, %.3f ms p50, %.3f ms p95, %.3f ms p99, %.3f ms max\n", pass.name.c_str(), pass.milliseconds.average,
+            pass.milliseconds.p50, pass.milliseconds.p95, pass.milliseconds.p99, pass.milliseconds.max);
+    }
 
-    ::CloseHandle(m_fenceEvent);
+    const auto uploadRing = m_uploadRing->GetStats();
+    LOG("Upload ring: %llu KB, high water %llu KB, largest frame %llu KB, %llu allocations, %llu failed\n",
+        static_cast<unsigned long long>(uploadRing.capacity / 1024), static_cast<unsigned long long>(uploadRing.highWaterBytes / 1024),
+        static_cast<unsigned long long>(uploadRing.maxFrameBytes / 1024), static_cast<unsigned long long>(uploadRing.allocations),
+        static_cast<unsigned long long>(uploadRing.failedAllocations));
+
+    const auto descriptorRing = m_descriptorRing->GetStats();
+    LOG("Descriptor ring: %llu descriptors, high water %llu, largest frame %llu, %llu failed allocations\n",
+        static_cast<unsigned long long>(descriptorRing.capacity), static_cast<unsigned long long>(descriptorRing.highWaterBytes),
+        static_cast<unsigned long long>(descriptorRing.maxFrameBytes), static_cast<unsigned long long>(descriptorRing.failedAllocations));
+    const auto bindless = m_bindlessTable->GetStats();
+    LOG("Bindless table: %u slots, %u in use, %u waiting for the GPU, high water %u, %llu failed allocations\n", bindless.capacity,
+        bindless.allocated, bindless.pendingFree, bindless.highWater, static_cast<unsigned long long>(bindless.failedAllocations));
+
+    for (UINT type = 0; type < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++type)
+    {
+        const auto descriptors = m_descriptorAllocators[type]->GetStats();
+        if (descriptors.pages > 0)
+        {
+            LOG("Descriptors (heap type %u): %u pages, %u of %u in use (%.1f%%), high water %u\n", type, descriptors.pages,
+                descriptors.allocated, descriptors.capacity, descriptors.occupancy * 100.0, descriptors.highWater);
+        }
+    }
+
+    const auto& graph = m_renderGraph->GetGraph().GetStats();
+    LOG("Render graph: %llu passes, %llu culled, %llu transient textures in a %llu KB heap (%llu KB without aliasing), %llu barrier batches\n",
+        static_cast<unsigned long long>(graph.passes), static_cast<unsigned long long>(graph.culledPasses),
+        static_cast<unsigned long long>(graph.transientResources), static_cast<unsigned long long>(m_renderGraph->GetHeapSize() / 1024),
+        static_cast<unsigned long long>(graph.transientBytes / 1024), static_cast<unsigned long long>(graph.barrierBatches));
+
+    const auto rootSignatures = m_rootSignatureCache->GetStats();
+    LOG("Root signatures (version 1.%u): %llu created for %llu requests, %llu serialized, %llu from cached blobs\n",
+        m_rootSignatureCache->GetVersion() == D3D_ROOT_SIGNATURE_VERSION_1_1 ? 1u : 0u, static_cast<unsigned long long>(rootSignatures.rootSignatures),
+        static_cast<unsigned long long>(rootSignatures.requests), static_cast<unsigned long long>(rootSignatures.serializations),
+        static_cast<unsigned long long>(rootSignatures.blobHits));
+    if (!m_rootSignatureCachePath.empty() && !m_rootSignatureCache->SaveBlobs(m_rootSignatureCachePath))
+    {
+        LOG("Failed to save the root signature cache to %s\n", m_rootSignatureCachePath.c_str());
+    }
+
+    const auto heaps = m_heapAllocator->GetStats();
+    LOG("Placed resource heaps: %llu heaps, %llu KB reserved, %llu KB used by %llu resources, %.1f%% utilization, %.1f%% fragmentation\n",
+        static_cast<unsigned long long>(heaps.blocks), static_cast<unsigned long long>(heaps.reservedBytes / 1024),
+        static_cast<unsigned long long>(heaps.usedBytes / 1024), static_cast<unsigned long long>(heaps.allocations),
+        heaps.utilization * 100.0, heaps.fragmentation * 100.0);
+
+    if (m_frameLatencyWaitableObject)
+    {
+        ::CloseHandle(m_frameLatencyWaitableObject);
+        m_frameLatencyWaitableObject = nullptr;
+    }
+
+    if (m_resizeRequests > 0)
+    {
+        LOG("Resize: %llu requests, %llu swap chain resizes\n",
+            static_cast<unsigned long long>(m_resizeRequests), static_cast<unsigned long long>(m_resizesApplied));
+    }
+
+    const auto presentLatency = m_presentLatency.GetStats();
+    if (presentLatency.samples > 0)
+    {
+        LOG("Present to display latency (%s): %.2f ms avg, %.2f ms min, %.2f ms max over the last %llu presents\n",
+            m_lowLatencyMode ? "low latency" : "default", presentLatency.averageMs, presentLatency.minMs, presentLatency.maxMs,
+            static_cast<unsigned long long>(std::min<uint64_t>(presentLatency.samples, PresentLatencyTracker::SampleCount)));
+    }
 }
 
 void Framework_DX12::Resize(UINT32 newWidth, UINT32 newHeight)
 {
-    if (GetWidth() != newWidth || GetHeight() != newHeight)
+    // Don't allow 0 size swap chain back buffers.
+    m_pendingWidth = std::max(1u, newWidth);
+    m_pendingHeight = std::max(1u, newHeight);
+    m_resizePending = true;
+    ++m_resizeRequests;
+}
+
+void Framework_DX12::ApplyPendingResize()
+{
+    if (!m_resizePending)
     {
-        SetWidthHeight(std::max(1u, newWidth), std::max(1u, newHeight)); // Don't allow 0 size swap chain back buffers.
+        return;
+    }
+    m_resizePending = false;
 
-        // Flush the GPU queue to make sure the swap chain's back buffers
-        // are not being referenced by an in-flight command list.
-        FlushGPUCommandQueue(m_commandQueue, m_fence, m_fenceValue, m_fenceEvent);
+    if (GetWidth() == m_pendingWidth && GetHeight() == m_pendingHeight)
+    {
+        return;
+    }
 
-        for (UINT i = 0; i < FrameBufferCount; ++i)
-        {
-            m_backBuffers[i].Reset();
-            m_fenceValuesPerFrame[i] = m_fenceValue; // since we have already done the flush its safe to set it to anything less than m_fenceValue + 1.
-        }
+    PROFILE_ZONE("Resize swap chain");
 
+    SetWidthHeight(m_pendingWidth, m_pendingHeight);
+    ++m_resizesApplied;
+
+    // ResizeBuffers needs every back buffer idle, and every frame renders to one: this drains the frames in flight on the
+    // direct queue, on purpose. A resize is rare and the frames that follow render at the new size anyway. Only the
+    // compute and copy queues, and direct submissions after the last frame, are left running.
+    uint64_t lastBackBufferUse = 0;
+    for (uint64_t fenceValue : m_backBufferFenceValues)
+    {
+        lastBackBufferUse = std::max(lastBackBufferUse, fenceValue);
+    }
+    m_timelines[QueueType::Direct].Wait(lastBackBufferUse);
+
+    for (auto& backBuffer : m_backBuffers)
+    {
+        backBuffer.Reset();
+    }
+
+    // the back buffers can't go through the deferred release queue, ResizeBuffers fails while any reference to them is alive.
+    m_deferredReleases.Collect(m_timelines);
+
+    if (m_swapChain)
+    {
         DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
         ThrowIfFailed(m_swapChain->GetDesc(&swapChainDesc));
-        ThrowIfFailed(m_swapChain->ResizeBuffers(FrameBufferCount, GetWidth(), GetHeight(), swapChainDesc.BufferDesc.Format, swapChainDesc.Flags));
+        ThrowIfFailed(m_swapChain->ResizeBuffers(m_backBufferCount, GetWidth(), GetHeight(), swapChainDesc.BufferDesc.Format, swapChainDesc.Flags));
 
-        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
-
-        UpdateRenderTargetViews(m_device, m_swapChain, m_rtvDescriptorHeap, FrameBufferCount);
+        UpdateRenderTargetViews(m_device, m_swapChain, m_rtvDescriptorHeap, m_backBufferCount);
+    }
+    else
+    {
+        CreateOffscreenRenderTargets(m_device, m_rtvDescriptorHeap, m_backBufferCount, GetWidth(), GetHeight());
     }
+
+    m_presenter->BuffersRecreated();
+    m_currentBackBufferIndex = m_presenter->GetCurrentBufferIndex();
+    m_backBufferFenceValues.assign(m_backBufferCount, 0);
+}
+
+SyncPoint Framework_DX12::ExecuteCommandLists(QueueType queue, UINT numCommandLists, ID3D12CommandList* const* commandLists)
+{
+    PROFILE_ZONE("ExecuteCommandLists");
+    m_queueScheduler->Resolve(queue);
+    GetCommandQueue(queue)->ExecuteCommandLists(numCommandLists, commandLists);
+    return m_timelines.Signal(queue);
+}
+
+void Framework_DX12::QueueWait(QueueType queue, const SyncPoint& point)
+{
+    m_queueScheduler->AddDependency(queue, point);
+}
+
+void Framework_DX12::SetBackBufferCount(UINT backBufferCount)
+{
+    assert(!HasInitialized() && "The back buffer count must be set before Init()");
+    m_backBufferCount = std::min(std::max(2u, backBufferCount), static_cast<UINT>(DXGI_MAX_SWAP_CHAIN_BUFFERS));
+}
+
+void Framework_DX12::SetFrameLatency(UINT frameLatency)
+{
+    assert(!HasInitialized() && "The frame latency must be set before Init()");
+    m_autoFrameLatency = frameLatency == 0;
+    m_frameLatency = m_autoFrameLatency ? m_frameLatencyController.GetLatency() : frameLatency;
+}
+
+void Framework_DX12::SetLowLatencyMode(bool enable, UINT maxFrameLatency)
+{
+    assert(!HasInitialized() && "The low latency mode must be set before Init()");
+    m_lowLatencyMode = enable;
+    m_maxFrameLatency = std::max(1u, maxFrameLatency);
 }
 
 void Framework_DX12::EnableDebugLayer() const
@@ -332,7 +704,7 @@ ComPtr<Framework_DX12::D3D12CommandQueueInterface> Framework_DX12::CreateCommand
     return d3d12CommandQueue;
 }
 
-ComPtr<Framework_DX12::DXGISwapChainInterface> Framework_DX12::CreateSwapChain(HWND hWnd, ComPtr<DXGIFactoryInterface> dxgiFactory, ComPtr<ID3D12CommandQueue> commandQueue, uint32_t width, uint32_t height, uint32_t bufferCount, bool supportTearing) const
+ComPtr<Framework_DX12::DXGISwapChainInterface> Framework_DX12::CreateSwapChain(HWND hWnd, ComPtr<DXGIFactoryInterface> dxgiFactory, ComPtr<ID3D12CommandQueue> commandQueue, uint32_t width, uint32_t height, uint32_t bufferCount, bool supportTearing, bool frameLatencyWaitable) const
 {
     ComPtr<DXGISwapChainInterface> dxgiSwapChain;
 
@@ -349,6 +721,8 @@ ComPtr<Framework_DX12::DXGISwapChainInterface> Framework_DX12::CreateSwapChain(H
     swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
     // It is recommended to always allow tearing if tearing support is available.
     swapChainDesc.Flags = supportTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+    // The waitable object lets the application wait for DXGI at the start of the frame instead of inside Present().
+    swapChainDesc.Flags |= frameLatencyWaitable ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
 
     ComPtr<IDXGISwapChain1> swapChain1;
     ThrowIfFailed(dxgiFactory->CreateSwapChainForHwnd(
@@ -405,6 +779,31 @@ void Framework_DX12::UpdateRenderTargetViews(ComPtr<D3D12DeviceInterface> device
     }
 }
 
+void Framework_DX12::CreateOffscreenRenderTargets(ComPtr<D3D12DeviceInterface> device, ComPtr<D3D12DescriptorHeapInterface> descriptorHeap, UINT count, UINT width, UINT height)
+{
+    const auto RTVDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+    // same format as the swap chain, created in the PRESENT (COMMON) state the frame transitions from.
+    const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+    const CD3DX12_RESOURCE_DESC textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, 1, 0,
+        D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+    for (UINT i = 0; i < count; ++i)
+    {
+        ComPtr<ID3D12Resource> renderTarget;
+        ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &textureDesc,
+            D3D12_RESOURCE_STATE_PRESENT, nullptr, IID_PPV_ARGS(&renderTarget)));
+
+        device->CreateRenderTargetView(renderTarget.Get(), nullptr, rtvHandle);
+
+        m_backBuffers[i] = renderTarget;
+        NAME_D3D12_OBJECT_INDEXED(m_backBuffers, i);
+
+        rtvHandle.Offset(RTVDescriptorSize);
+    }
+}
+
 ComPtr<ID3D12CommandAllocator> Framework_DX12::CreateCommandAllocator(ComPtr<D3D12DeviceInterface> device, D3D12_COMMAND_LIST_TYPE type) const
 {
     ComPtr<ID3D12CommandAllocator> commandAllocator;
@@ -413,6 +812,15 @@ ComPtr<ID3D12CommandAllocator> Framework_DX12::CreateCommandAllocator(ComPtr<D3D
     return commandAllocator;
 }
 
+std::unique_ptr<Framework_DX12::CommandAllocatorPool> Framework_DX12::CreateCommandAllocatorPool(ComPtr<D3D12DeviceInterface> device, D3D12_COMMAND_LIST_TYPE type, FenceTimeline& timeline) const
+{
+    return std::make_unique<CommandAllocatorPool>(
+        timeline,
+        [this, device, type]() { return CreateCommandAllocator(device, type); },
+        [](ComPtr<ID3D12CommandAllocator>& commandAllocator) { ThrowIfFailed(commandAllocator->Reset()); } // its fence value has been reached, safe to reset
+    );
+}
+
 ComPtr<ID3D12GraphicsCommandList> Framework_DX12::CreateCommandList(ComPtr<D3D12DeviceInterface> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type) const
 {
     ComPtr<ID3D12GraphicsCommandList> commandList;
@@ -447,6 +855,79 @@ UINT64 Framework_DX12::SignalFenceGPU(ComPtr<ID3D12CommandQueue> commandQueue, C
     return fenceValue;
 }
 
+void Framework_DX12::RegisterResource(ID3D12Resource* resource, ResourceState state)
+{
+    m_resourceStates.Register(resource, ResourceStateTracker_DX12::GetSubresourceCount(m_device.Get(), resource), state);
+}
+
+void Framework_DX12::ResolveSceneStates(ID3D12CommandAllocator* commandAllocator, size_t firstSceneList, UINT listCount)
+{
+    PROFILE_FUNCTION();
+
+    // in submission order: each list starts from the states the lists before it leave. Lists that need transitions
+    // from those states get a small list of fixup barriers in front of them.
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    UINT fixupCount = 0;
+    for (UINT listIndex = 0; listIndex < listCount; ++listIndex)
+    {
+        barriers.clear();
+        if (m_sceneStateTrackers[listIndex]->Resolve(m_resourceStates, barriers) == 0)
+        {
+            continue;
+        }
+
+        if (fixupCount == m_stateFixupCommandLists.size())
+        {
+            ComPtr<ID3D12GraphicsCommandList> commandList;
+            ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr, IID_PPV_ARGS(&commandList)));
+            m_stateFixupCommandLists.push_back(commandList);
+        }
+        else
+        {
+            ThrowIfFailed(m_stateFixupCommandLists[fixupCount]->Reset(commandAllocator, nullptr));
+        }
+
+        ID3D12GraphicsCommandList* commandList = m_stateFixupCommandLists[fixupCount].Get();
+        commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        ThrowIfFailed(commandList->Close());
+
+        m_frameCommandLists.insert(m_frameCommandLists.begin() + firstSceneList + listIndex + fixupCount, commandList);
+        ++fixupCount;
+    }
+}
+
+void Framework_DX12::DeferredRelease(ComPtr<IUnknown> object, UINT64 byteSize)
+{
+    // released once the frame being recorded has completed, whatever else is signaled on the direct queue until its end.
+    m_deferredReleases.RetireWithFrame(std::move(object), byteSize);
+}
+
+void Framework_DX12::DeferredRelease(ComPtr<ID3D12Resource> resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->GetResourceAllocationInfo(0, 1, &desc);
+
+    ComPtr<IUnknown> object;
+    ThrowIfFailed(resource.As(&object));
+    DeferredRelease(std::move(object), allocationInfo.SizeInBytes);
+}
+
+void Framework_DX12::DeferredRelease(HeapAllocator_DX12::Allocation&& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return;
+    }
+
+    const UINT64 byteSize = allocation.size;
+    m_deferredAllocations.RetireWithFrame(std::move(allocation), byteSize);
+}
+
 void Framework_DX12::WaitForFenceValue(ComPtr<ID3D12Fence> fence, uint64_t targetFenceValue, HANDLE fenceEvent, std::chrono::milliseconds duration) const
 {
     const auto completedFenceValue (fence->GetCompletedValue());
@@ -1,7 +1,26 @@
 #pragma once
 #include "Framework.h"
 #include "graphics.h"
+#include "BindlessTable_DX12.h"
+#include "DescriptorAllocator_DX12.h"
+#include "DescriptorRing_DX12.h"
+#include "RootSignatureCache_DX12.h"
+#include "Fence_DX12.h"
+#include "GpuProfiler_DX12.h"
+#include "HeapAllocator_DX12.h"
+#include "core/DeferredReleaseQueue.h"
+#include "core/FencedPool.h"
+#include "core/FrameLatencyController.h"
+#include "core/PresentLatencyTracker.h"
+#include "core/QueueScheduler.h"
+#include "ParallelRecorder_DX12.h"
+#include "RenderGraph_DX12.h"
+#include "ResourceStateTracker_DX12.h"
+#include "SwapChainPresenter_DX12.h"
+#include "UploadRing_DX12.h"
 #include <chrono>
+#include <memory>
+#include <vector>
 
 class Framework_DX12 : public Framework
 {
@@ -13,24 +32,31 @@ protected:
     using DXGIAdapterInterface = IDXGIAdapter4;
     using DXGISwapChainInterface = IDXGISwapChain4;
     using DXGIFactoryInterface = IDXGIFactory6;
+
+    using CommandAllocatorPool = FencedPool<ComPtr<ID3D12CommandAllocator>>;
     
 public:
     Framework_DX12(UINT width, UINT height, bool useWarpDevice=false);
     ~Framework_DX12();
 
     virtual void Init() override;
+    virtual void BeginFrame() override;
     virtual void Update() override;
     virtual void Render() override;
     virtual void Release() override;
-    virtual void Resize(UINT32 width, UINT32 height) override;
+    virtual void WaitForGpu() override { m_timelines.WaitIdle(); }
+    virtual void Resize(UINT32 width, UINT32 height) override; // only records the size, applied by the next Render()
+    virtual JobSystem* GetJobSystem() override { return m_jobSystem.get(); }
 
     void EnableDebugLayer() const;
     ComPtr<D3D12DeviceInterface> CreateDevice(ComPtr<DXGIAdapterInterface> adapter) const;
     ComPtr<D3D12CommandQueueInterface> CreateCommandQueue(ComPtr<D3D12DeviceInterface> device, D3D12_COMMAND_LIST_TYPE type) const;
-    ComPtr<DXGISwapChainInterface> CreateSwapChain(HWND hWnd, ComPtr<DXGIFactoryInterface> dxgiFactory, ComPtr<ID3D12CommandQueue> commandQueue, uint32_t width, uint32_t height, uint32_t bufferCount, bool supportTearing) const;
+    ComPtr<DXGISwapChainInterface> CreateSwapChain(HWND hWnd, ComPtr<DXGIFactoryInterface> dxgiFactory, ComPtr<ID3D12CommandQueue> commandQueue, uint32_t width, uint32_t height, uint32_t bufferCount, bool supportTearing, bool frameLatencyWaitable = false) const;
     ComPtr<D3D12DescriptorHeapInterface> CreateDescriptorHeap(ComPtr<D3D12DeviceInterface> device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors) const;
     void UpdateRenderTargetViews(ComPtr<D3D12DeviceInterface> device, ComPtr<DXGISwapChainInterface> swapChain, ComPtr<D3D12DescriptorHeapInterface> descriptorHeap, UINT nFrameBuffer);
+    void CreateOffscreenRenderTargets(ComPtr<D3D12DeviceInterface> device, ComPtr<D3D12DescriptorHeapInterface> descriptorHeap, UINT count, UINT width, UINT height);
     ComPtr<ID3D12CommandAllocator> CreateCommandAllocator(ComPtr<D3D12DeviceInterface> device, D3D12_COMMAND_LIST_TYPE type) const;
+    std::unique_ptr<CommandAllocatorPool> CreateCommandAllocatorPool(ComPtr<D3D12DeviceInterface> device, D3D12_COMMAND_LIST_TYPE type, FenceTimeline& timeline) const;
     ComPtr<ID3D12GraphicsCommandList> CreateCommandList(ComPtr<D3D12DeviceInterface> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type) const;
     ComPtr<ID3D12Fence> CreateFence(ComPtr<D3D12DeviceInterface> device) const;
     UINT64 SignalFenceGPU(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, UINT64& fenceValue) const;
@@ -39,21 +65,133 @@ public:
 
     static HANDLE CreateEventHandle();
 
+    // Latency against throughput knobs, both chosen independently and applied by Init().
+    void SetBackBufferCount(UINT backBufferCount); // swap chain buffers, 2 to DXGI_MAX_SWAP_CHAIN_BUFFERS
+    void SetFrameLatency(UINT frameLatency); // frames the CPU can have in flight, counting the one being recorded. 0 picks it from the measured fence waits.
+    virtual UINT GetBackBufferCount() const override { return m_backBufferCount; }
+    UINT GetFrameLatency() const { return m_frameLatency; } // current value, changes over time in automatic mode
+
+    // Low latency presentation: the swap chain is created with a frame latency waitable object and every frame starts by waiting on it,
+    // instead of Present() queuing frames ahead. maxFrameLatency is the number of presents DXGI may queue. Set before Init().
+    void SetLowLatencyMode(bool enable, UINT maxFrameLatency = 1);
+    bool IsLowLatencyMode() const { return m_lowLatencyMode; }
+    PresentLatencyTracker::Stats GetPresentLatencyStats() const { return m_presentLatency.GetStats(); } // Present() call to display
+
+    // Submit closed command lists to queue and signal its fence, returns the sync point other queues (or the CPU) can wait on.
+    // Pending dependencies of the queue (QueueWait) are resolved into GPU side waits first. One submitting thread per queue.
+    SyncPoint ExecuteCommandLists(QueueType queue, UINT numCommandLists, ID3D12CommandList* const* commandLists);
+    // The next submission on queue waits on the GPU, without blocking the CPU, until point has been reached.
+    void QueueWait(QueueType queue, const SyncPoint& point);
+
+    ID3D12CommandQueue* GetCommandQueue(QueueType queue) const { return m_commandQueues[static_cast<UINT>(queue)].Get(); }
+    CommandAllocatorPool& GetCommandAllocatorPool(QueueType queue) const { return *m_commandAllocatorPools[static_cast<UINT>(queue)]; }
+    QueueTimelines& GetTimelines() { return m_timelines; }
+    GpuProfiler_DX12* GetGpuProfiler() const { return m_gpuProfiler.get(); } // passes on the direct queue: GPU_PROFILE_ZONE(GetGpuProfiler(), commandList, "name")
+    // Per frame dynamic data (constants, vertices) read by the direct queue, valid until the end of the frame's GPU work.
+    UploadRing_DX12* GetUploadRing() const { return m_uploadRing.get(); }
+    void SetUploadRingSize(UINT64 size) { m_uploadRingSize = size; } // before Init(), the release log reports the high water mark to size it
+    // Persistent CPU only descriptors of a heap type (views kept as long as their resource).
+    DescriptorAllocator_DX12& GetDescriptorAllocator(D3D12_DESCRIPTOR_HEAP_TYPE type) const { return *m_descriptorAllocators[type]; }
+    // Shader visible CBV/SRV/UAV tables valid for the frame being recorded, bound on every scene list: Copy() the staging descriptors in.
+    DescriptorRing_DX12* GetDescriptorRing() const { return m_descriptorRing.get(); }
+    void SetDescriptorRingSize(uint32_t descriptorCount) { m_descriptorRingSize = descriptorCount; } // before Init()
+    // Stable descriptor indices at the front of the same heap, for shaders indexing resources by root constant.
+    BindlessTable_DX12* GetBindlessTable() const { return m_bindlessTable.get(); }
+    void SetBindlessTableSize(uint32_t descriptorCount) { m_bindlessTableSize = descriptorCount; } // before Init()
+    // Placed resources suballocated from large heaps, for resources created at run time instead of committed ones.
+    HeapAllocator_DX12* GetHeapAllocator() const { return m_heapAllocator.get(); }
+    // Root signatures shared by identical descriptions.
+    RootSignatureCache_DX12* GetRootSignatureCache() const { return m_rootSignatureCache.get(); }
+    void SetRootSignatureCachePath(const std::string& path) { m_rootSignatureCachePath = path; } // before Init(), empty keeps nothing on disk
+    // co_await GetAwaitableTimeline(queue).Until(value) suspends a coroutine until queue has reached value and resumes it on a
+    // job system worker, no thread blocks in the meantime.
+    AwaitableTimeline GetAwaitableTimeline(QueueType queue) { return AwaitableTimeline(m_timelines[queue], *m_fenceWaitService); }
+
+    // Keep an object alive until the GPU has finished the frame currently being recorded, instead of flushing the queue before releasing it.
+    void DeferredRelease(ComPtr<IUnknown> object, UINT64 byteSize = 0);
+    void DeferredRelease(ComPtr<ID3D12Resource> resource);
+    void DeferredRelease(HeapAllocator_DX12::Allocation&& allocation); // the heap range is only handed back once the frame is done
+
     protected:
-    static const UINT FrameBufferCount { 4 };
+    // Record part of the scene into commandList. Called from the job system workers, listIndex in [0, listCount), the lists are
+    // submitted in listIndex order after the clear of the back buffer. Every list starts with no state set, binding the back buffer is up to the override.
+    virtual void RecordScene(ID3D12GraphicsCommandList* /*commandList*/, UINT /*listIndex*/, UINT /*listCount*/) {}
+
+    // Add passes to the frame's render graph, between the clear of the back buffer and the scene. The graph has been
+    // reset, backBuffer is the back buffer imported in the present state. Transient textures declared here share memory.
+    virtual void AddRenderPasses(RenderGraph_DX12& /*graph*/, RenderGraph_DX12::ResourceHandle /*backBuffer*/) {}
+
+    // Resources shared by the scene lists, registered in the state they are in when the next frame starts.
+    void RegisterResource(ID3D12Resource* resource, ResourceState state);
+    void UnregisterResource(ID3D12Resource* resource) { m_resourceStates.Unregister(resource); }
+    // Tracker of the scene list listIndex, only valid in RecordScene(). Transitions are batched until Flush() (done after
+    // RecordScene() returns), the first use of each resource is resolved when the frame is submitted.
+    ResourceStateTracker_DX12& GetSceneStateTracker(UINT listIndex) { return *m_sceneStateTrackers[listIndex]; }
+
+    // Resize the swap chain to the last size passed to Resize() if it changed. Called at the start of Render(), before
+    // anything of the frame references a back buffer.
+    void ApplyPendingResize();
+
+    // Resolve the first use of the resources in the scene lists against the registered states, at submission.
+    void ResolveSceneStates(ID3D12CommandAllocator* commandAllocator, size_t firstSceneList, UINT listCount);
+
+    static constexpr const char* GpuFramePassName = "GPU frame";
+
+    static const UINT DefaultBackBufferCount { 4 };
+    static const UINT DefaultFrameLatency { 3 };
+    static const UINT64 DefaultUploadRingSize { 4 * 1024 * 1024 };
+    static const uint32_t DefaultDescriptorRingSize { 64 * 1024 };
+    static const uint32_t DefaultBindlessTableSize { 64 * 1024 };
+
+    UINT m_backBufferCount { DefaultBackBufferCount };
+    UINT m_frameLatency { DefaultFrameLatency };
+    bool m_autoFrameLatency { false };
+    FrameLatencyController m_frameLatencyController; // only used in automatic mode
 
     // Pipeline objects.
     ComPtr<ID3D12GraphicsCommandList> m_commandList; // generally varies w.r.t number of threads recording drawing commands
-    ComPtr<ID3D12CommandAllocator> m_commandAllocators[FrameBufferCount]; // a command allocator cannot be reused unless all of the commands that have been 
-                                                       // recorded into the command allocator have finished executing on the GPU.
-    // There must be at least one command allocator per render frame that is "in-flight" (at least one per command-list, per back buffer of the swap chain).
+    ComPtr<ID3D12GraphicsCommandList> m_endFrameCommandList; // transition to present, recorded after the scene lists when there are any
+    std::vector<ID3D12CommandList*> m_frameCommandLists; // everything submitted this frame, in order
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_stateFixupCommandLists; // barriers resolved at submission, in front of the scene lists needing them
+    // A command allocator cannot be reused unless all of the commands that have been recorded into it have finished executing on the GPU.
+    // There must be at least one command allocator per command list per frame that is "in-flight", the pools hand out allocators
+    // whose fence value has been reached and grow when every allocator is still in flight.
+    std::unique_ptr<CommandAllocatorPool> m_commandAllocatorPools[static_cast<UINT>(QueueType::Count)];
+
+    std::unique_ptr<JobSystem> m_jobSystem;
+    std::unique_ptr<ParallelRecorder_DX12> m_sceneRecorder; // records RecordScene() on the job system workers
+    UINT m_sceneCommandListCount { 0 }; // number of command lists the scene is split into, 0 records nothing but the clear
 
-    ComPtr<ID3D12CommandQueue> m_commandQueue;
+    ComPtr<ID3D12CommandQueue> m_commandQueues[static_cast<UINT>(QueueType::Count)]; // direct (also presents), async compute and copy
+    std::unique_ptr<QueueScheduler> m_queueScheduler; // turns cross queue dependencies into ID3D12CommandQueue::Wait
+    std::unique_ptr<GpuProfiler_DX12> m_gpuProfiler; // timestamp queries on the direct queue, per pass GPU times
+    std::unique_ptr<UploadRing_DX12> m_uploadRing; // persistently mapped, retired per frame on the direct timeline
+    UINT64 m_uploadRingSize { DefaultUploadRingSize };
+    std::unique_ptr<DescriptorAllocator_DX12> m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES]; // staging, by heap type
+    std::unique_ptr<DescriptorRing_DX12> m_descriptorRing; // shader visible CBV/SRV/UAV, retired per frame on the direct timeline
+    uint32_t m_descriptorRingSize { DefaultDescriptorRingSize };
+    std::unique_ptr<BindlessTable_DX12> m_bindlessTable; // front of the ring's heap, slots recycled on the direct timeline
+    uint32_t m_bindlessTableSize { DefaultBindlessTableSize };
+    std::unique_ptr<RootSignatureCache_DX12> m_rootSignatureCache;
+    std::string m_rootSignatureCachePath; // serialized blobs loaded at Init() and saved at Release()
+    std::unique_ptr<HeapAllocator_DX12> m_heapAllocator; // declared before the deferred release queues holding its allocations
+    std::unique_ptr<RenderGraph_DX12> m_renderGraph; // passes of the frame, rebuilt and compiled every frame
+    ResourceStateRegistry m_resourceStates; // states of the registered resources once the submitted frames have executed
+    std::vector<std::unique_ptr<ResourceStateTracker_DX12>> m_sceneStateTrackers; // one per scene list
     
     ComPtr<D3D12DeviceInterface> m_device; // display adapter. a system can also have a software display adapter that emulates 3D hardware functionality.
-    ComPtr<DXGISwapChainInterface> m_swapChain;
-    ComPtr<ID3D12Resource> m_backBuffers[FrameBufferCount]; // are basically textures (or render targets)
+    ComPtr<DXGISwapChainInterface> m_swapChain; // null in headless mode
+    std::unique_ptr<Presenter> m_presenter; // the swap chain, or the offscreen ring in headless mode
+    std::vector<ComPtr<ID3D12Resource>> m_backBuffers; // are basically textures (or render targets), m_backBufferCount of them
     UINT m_currentBackBufferIndex{ 0 }; // store the index of the current back buffer of the swap chain.
+    std::vector<uint64_t> m_backBufferFenceValues; // fence value of the last frame that rendered to each back buffer
+
+    // Resize() calls between two frames collapse into one ResizeBuffers: dragging a window edge sends dozens of WM_SIZE per frame.
+    bool m_resizePending { false };
+    UINT m_pendingWidth { 0 };
+    UINT m_pendingHeight { 0 };
+    uint64_t m_resizeRequests { 0 };
+    uint64_t m_resizesApplied { 0 };
 
     ComPtr<ID3D12DescriptorHeap> m_rtvDescriptorHeap; // a "view" is a synonym for "descriptor". view (or descriptors) describe the resource to the GPU
     // since the swap chain contains multiple back buffer textures, one descriptor is needed to describe each back buffer texture.
@@ -68,12 +206,24 @@ public:
     // Synchronization objects.
     // Each thread or GPU queue should have at least one fence object and a corresponding fence value.
     // The same fence object should not be signaled from more than one thread or GPU queue but more than one thread or queue can wait on the same fence to be signaled.
-    ComPtr<ID3D12Fence> m_fence;
-    UINT64 m_fenceValue { 0 };
-    uint64_t m_fenceValuesPerFrame[FrameBufferCount] = {};
-    HANDLE m_fenceEvent { }; // An OS event handle is used to allow the CPU thread to wait until the fence has been signaled with a particular value.
+    std::unique_ptr<Fence_DX12> m_fences[static_cast<UINT>(QueueType::Count)]; // one per queue, only ever signaled by its queue
+    QueueTimelines m_timelines; // caches the completed value of every queue's fence, polling a frame's fence value is cheap and only blocks when it has to.
+    std::vector<uint64_t> m_frameFenceValues; // fence value of the last frames submitted, indexed by frame index modulo the largest possible latency
+    uint64_t m_frameIndex { 0 }; // number of frames submitted so far
+    std::chrono::steady_clock::time_point m_lastFrameStart;
+
+    DeferredReleaseQueue<ComPtr<IUnknown>> m_deferredReleases; // objects whose last use is still in flight, released in bulk once their fence value is reached.
+    DeferredReleaseQueue<HeapAllocator_DX12::Allocation> m_deferredAllocations; // same for placed resources, their range is freed with them
+
+    // one thread waiting on the fences of every suspended coroutine, declared after the timelines and the job system it uses.
+    std::unique_ptr<FenceWaitMultiplexer_DX12> m_fenceWaitMultiplexer;
+    std::unique_ptr<FenceWaitService> m_fenceWaitService;
+
+    bool m_lowLatencyMode { false };
+    UINT m_maxFrameLatency { 1 };
+    HANDLE m_frameLatencyWaitableObject { }; // signaled when DXGI is ready to accept a new frame, only in low latency mode
+    PresentLatencyTracker m_presentLatency;
 
-    bool m_vSyncEnabled { false }; // controls whether the swap chain's present method should wait for the next vertical refresh before presenting the rendered image to the screen.
     bool m_supportTearing { false };
 
     bool m_useWarpDevice { false }; // controls whether to use a software rasterizer (Windows Advanced Rasterization Platform - WARP) or not
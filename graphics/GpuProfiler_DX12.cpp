@@ -0,0 +1,179 @@
+#include "stdafx.h"
+#include "GpuProfiler_DX12.h"
+#include "Clock_Win32.h"
+
+GpuProfiler_DX12::GpuProfiler_DX12(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> commandQueue, UINT frameSlots, const std::string& trackName)
+    : m_commandQueue(commandQueue)
+    , m_slots(new FrameSlot[std::max(1u, frameSlots)])
+    , m_slotCount(std::max(1u, frameSlots))
+    , m_track(Profiler::Get().CreateTrack(trackName))
+{
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = QueriesPerFrame * m_slotCount;
+    ThrowIfFailed(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)));
+
+    const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_READBACK);
+    const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(UINT64) * QueriesPerFrame * m_slotCount);
+    ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+        D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readbackBuffer)));
+
+    ThrowIfFailed(m_commandQueue->GetTimestampFrequency(&m_timestampFrequency));
+
+    INT64 cpuQpc = 0;
+    ThrowIfFailed(m_commandQueue->GetClockCalibration(&m_calibrationGpuTicks, reinterpret_cast<UINT64*>(&cpuQpc)));
+    m_calibrationCpuNs = Clock_Win32::QpcToNanoseconds(cpuQpc);
+}
+
+void GpuProfiler_DX12::BeginFrame(FenceTimeline& timeline)
+{
+    Collect(timeline);
+
+    m_currentSlot = static_cast<UINT>(m_frameCount % m_slotCount);
+    FrameSlot& slot = m_slots[m_currentSlot];
+    if (slot.pending)
+    {
+        // more frames in flight than slots, the oldest has to finish before its queries are reused.
+        timeline.Wait(slot.fenceValue);
+        ReadBack(slot, m_currentSlot);
+    }
+
+    slot.passes.clear();
+    slot.frame = m_frameCount;
+    slot.queryCount.store(0, std::memory_order_relaxed);
+    slot.resolvedQueries = 0;
+}
+
+UINT GpuProfiler_DX12::BeginPass(ID3D12GraphicsCommandList* commandList, const char* name)
+{
+    FrameSlot& slot = m_slots[m_currentSlot];
+    const UINT query = slot.queryCount.fetch_add(2, std::memory_order_relaxed);
+    if (query + 2 > QueriesPerFrame)
+    {
+        return InvalidPass;
+    }
+
+    const UINT firstQuery = m_currentSlot * QueriesPerFrame;
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery + query);
+
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.passes.push_back(Pass{ name, query, query + 1 });
+    return static_cast<UINT>(slot.passes.size() - 1);
+}
+
+void GpuProfiler_DX12::EndPass(ID3D12GraphicsCommandList* commandList, UINT pass)
+{
+    if (pass == InvalidPass)
+    {
+        return;
+    }
+
+    FrameSlot& slot = m_slots[m_currentSlot];
+    UINT endQuery = 0;
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        endQuery = slot.passes[pass].endQuery;
+    }
+
+    const UINT firstQuery = m_currentSlot * QueriesPerFrame;
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery + endQuery);
+}
+
+void GpuProfiler_DX12::ResolveFrame(ID3D12GraphicsCommandList* commandList)
+{
+    FrameSlot& slot = m_slots[m_currentSlot];
+    slot.resolvedQueries = std::min(slot.queryCount.load(std::memory_order_relaxed), QueriesPerFrame);
+    if (slot.resolvedQueries == 0)
+    {
+        return;
+    }
+
+    const UINT firstQuery = m_currentSlot * QueriesPerFrame;
+    commandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, slot.resolvedQueries,
+        m_readbackBuffer.Get(), sizeof(UINT64) * firstQuery);
+}
+
+void GpuProfiler_DX12::EndFrame(uint64_t fenceValue)
+{
+    FrameSlot& slot = m_slots[m_currentSlot];
+    slot.fenceValue = fenceValue;
+    slot.pending = slot.resolvedQueries > 0;
+    ++m_frameCount;
+}
+
+void GpuProfiler_DX12::Collect(FenceTimeline& timeline)
+{
+    bool calibrated = false;
+    for (UINT i = 0; i < m_slotCount; ++i)
+    {
+        FrameSlot& slot = m_slots[i];
+        if (slot.pending && timeline.IsComplete(slot.fenceValue))
+        {
+            if (!calibrated)
+            {
+                // the GPU and CPU clocks drift apart slowly, recalibrate once per read back.
+                INT64 cpuQpc = 0;
+                if (SUCCEEDED(m_commandQueue->GetClockCalibration(&m_calibrationGpuTicks, reinterpret_cast<UINT64*>(&cpuQpc))))
+                {
+                    m_calibrationCpuNs = Clock_Win32::QpcToNanoseconds(cpuQpc);
+                }
+                calibrated = true;
+            }
+            ReadBack(slot, i);
+        }
+    }
+}
+
+void GpuProfiler_DX12::ReadBack(FrameSlot& slot, UINT slotIndex)
+{
+    slot.pending = false;
+
+    const SIZE_T begin = sizeof(UINT64) * slotIndex * QueriesPerFrame;
+    const D3D12_RANGE readRange = { begin, begin + sizeof(UINT64) * slot.resolvedQueries };
+    void* data = nullptr;
+    ThrowIfFailed(m_readbackBuffer->Map(0, &readRange, &data));
+    const UINT64* timestamps = reinterpret_cast<const UINT64*>(static_cast<const BYTE*>(data) + begin);
+
+    const double ticksToMs = 1000.0 / static_cast<double>(m_timestampFrequency);
+    for (const Pass& pass : slot.passes)
+    {
+        if (pass.endQuery >= slot.resolvedQueries)
+        {
+            continue;
+        }
+
+        const UINT64 beginTicks = timestamps[pass.beginQuery];
+        const UINT64 endTicks = timestamps[pass.endQuery];
+        if (endTicks < beginTicks)
+        {
+            continue; // the pass wasn't ended, or the timestamps aren't comparable (disjoint)
+        }
+
+        const double milliseconds = static_cast<double>(endTicks - beginTicks) * ticksToMs;
+        m_passStatistics[pass.name].Add(milliseconds);
+        if (m_passCallback)
+        {
+            m_passCallback(slot.frame, pass.name, milliseconds);
+        }
+        Profiler::Record(m_track, pass.name, GpuTicksToCpuNanoseconds(beginTicks), GpuTicksToCpuNanoseconds(endTicks), 0);
+    }
+
+    const D3D12_RANGE writtenRange = { 0, 0 };
+    m_readbackBuffer->Unmap(0, &writtenRange);
+}
+
+int64_t GpuProfiler_DX12::GpuTicksToCpuNanoseconds(UINT64 ticks) const
+{
+    const double deltaTicks = static_cast<double>(static_cast<INT64>(ticks - m_calibrationGpuTicks));
+    return m_calibrationCpuNs + static_cast<int64_t>(deltaTicks * 1e9 / static_cast<double>(m_timestampFrequency));
+}
+
+std::vector<GpuProfiler_DX12::PassStatistics> GpuProfiler_DX12::GetPassStatistics() const
+{
+    std::vector<PassStatistics> statistics;
+    for (const auto& pass : m_passStatistics)
+    {
+        statistics.push_back(PassStatistics{ pass.first, pass.second.Summarize() });
+    }
+    return statistics;
+}
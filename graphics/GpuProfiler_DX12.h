@@ -0,0 +1,133 @@
+#pragma once
+#include "graphics.h"
+#include "core/FenceTimeline.h"
+#include "core/Profiler.h"
+#include "core/RollingStatistics.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// GPU time per pass from timestamp queries. Every frame in flight has its own range of the query heap and of the
+// readback buffer: passes write a timestamp at their start and end, the frame resolves its range once at the end, and
+// the results are read back when the frame's fence has been reached, never stalling the GPU.
+//
+// The timestamps are converted to the CPU clock with the queue's clock calibration and recorded on a profiler track,
+// next to the CPU zones of the same frame. Rolling statistics are kept per pass name.
+class GpuProfiler_DX12
+{
+public:
+    static const UINT MaxPassesPerFrame = 256;
+    static const UINT InvalidPass = ~0u;
+
+    struct PassStatistics
+    {
+        std::string name;
+        RollingStatistics::Summary milliseconds;
+    };
+
+    // Called for every pass read back, frame counts the BeginFrame() calls before the pass's frame.
+    using PassCallback = std::function<void(uint64_t frame, const char* name, double milliseconds)>;
+
+    // frameSlots: frames that can be in flight at once, plus the one being recorded.
+    GpuProfiler_DX12(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> commandQueue, UINT frameSlots, const std::string& trackName);
+
+    // Start a frame on the thread submitting it. Waits on timeline if the frame that last used the slot isn't complete yet.
+    void BeginFrame(FenceTimeline& timeline);
+
+    // Time the commands recorded into commandList between the two calls. Thread safe, passes of a frame can be recorded
+    // in parallel into different lists. Returns InvalidPass, ignored by EndPass(), when the frame has no query left.
+    UINT BeginPass(ID3D12GraphicsCommandList* commandList, const char* name);
+    void EndPass(ID3D12GraphicsCommandList* commandList, UINT pass);
+
+    // Copy the frame's timestamps to the readback buffer. Record into the last command list of the frame, after every EndPass().
+    void ResolveFrame(ID3D12GraphicsCommandList* commandList);
+    // The frame has been submitted, fenceValue on the profiled queue's timeline covers it.
+    void EndFrame(uint64_t fenceValue);
+
+    // Read back the frames whose fence has been reached. Doesn't block.
+    void Collect(FenceTimeline& timeline);
+
+    std::vector<PassStatistics> GetPassStatistics() const;
+    void SetPassCallback(PassCallback callback) { m_passCallback = std::move(callback); }
+    UINT64 GetTimestampFrequency() const { return m_timestampFrequency; }
+
+    // Times a pass for the duration of the scope.
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler_DX12* profiler, ID3D12GraphicsCommandList* commandList, const char* name)
+            : m_profiler(profiler)
+            , m_commandList(commandList)
+            , m_pass(profiler ? profiler->BeginPass(commandList, name) : InvalidPass)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_profiler)
+            {
+                m_profiler->EndPass(m_commandList, m_pass);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuProfiler_DX12* m_profiler;
+        ID3D12GraphicsCommandList* m_commandList;
+        UINT m_pass;
+    };
+
+private:
+    static const UINT QueriesPerFrame = MaxPassesPerFrame * 2;
+
+    struct Pass
+    {
+        const char* name { nullptr };
+        UINT beginQuery { 0 };
+        UINT endQuery { 0 };
+    };
+
+    struct FrameSlot
+    {
+        std::mutex mutex; // guards passes
+        std::vector<Pass> passes;
+        std::atomic<UINT> queryCount { 0 };
+        UINT resolvedQueries { 0 };
+        uint64_t fenceValue { 0 };
+        uint64_t frame { 0 };
+        bool pending { false }; // submitted, not read back yet
+    };
+
+    void ReadBack(FrameSlot& slot, UINT slotIndex);
+    int64_t GpuTicksToCpuNanoseconds(UINT64 ticks) const;
+
+    ComPtr<ID3D12CommandQueue> m_commandQueue;
+    ComPtr<ID3D12QueryHeap> m_queryHeap;
+    ComPtr<ID3D12Resource> m_readbackBuffer; // QueriesPerFrame timestamps per slot
+    UINT64 m_timestampFrequency { 1 };
+
+    // a GPU timestamp and the CPU time (in Profiler::NowNanoseconds() units) it corresponds to.
+    UINT64 m_calibrationGpuTicks { 0 };
+    int64_t m_calibrationCpuNs { 0 };
+
+    std::unique_ptr<FrameSlot[]> m_slots;
+    UINT m_slotCount { 0 };
+    UINT m_currentSlot { 0 };
+    uint64_t m_frameCount { 0 };
+
+    Profiler::Track& m_track;
+    std::map<std::string, RollingStatistics> m_passStatistics; // milliseconds per pass name
+    PassCallback m_passCallback;
+};
+
+#if CONF_BOOL_ENABLE_PROFILER
+#define GPU_PROFILE_ZONE(profiler, commandList, name) GpuProfiler_DX12::Scope PROFILE_CONCAT(gpuProfileZone, __LINE__)(profiler, commandList, name)
+#else
+#define GPU_PROFILE_ZONE(profiler, commandList, name) ((void)0)
+#endif
@@ -0,0 +1,219 @@
+#include "stdafx.h"
+#include "HeapAllocator_DX12.h"
+
+namespace
+{
+    UINT GetHeapTypeIndex(D3D12_HEAP_TYPE heapType)
+    {
+        switch (heapType)
+        {
+        case D3D12_HEAP_TYPE_UPLOAD: return 1;
+        case D3D12_HEAP_TYPE_READBACK: return 2;
+        default: return 0;
+        }
+    }
+}
+
+HeapAllocator_DX12::HeapAllocator_DX12(ComPtr<ID3D12Device> device, UINT64 blockSize)
+    : m_device(device)
+    , m_blockSize(TlsfAllocator::AlignUp(blockSize, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT))
+{
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+    {
+        m_resourceHeapTier = options.ResourceHeapTier;
+    }
+
+    static const D3D12_HEAP_TYPE heapTypes[HeapTypeCount] = { D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK };
+    static const D3D12_HEAP_FLAGS tier1Flags[] = { D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES };
+
+    for (UINT heapType = 0; heapType < HeapTypeCount; ++heapType)
+    {
+        for (UINT resourceClass = 0; resourceClass < static_cast<UINT>(ResourceClass::Count); ++resourceClass)
+        {
+            Pool& pool = m_pools[heapType * static_cast<UINT>(ResourceClass::Count) + resourceClass];
+            pool.heapType = heapTypes[heapType];
+
+            // tier 2 mixes every kind of resource in a heap, only the first class of each heap type is used.
+            pool.heapFlags = m_resourceHeapTier == D3D12_RESOURCE_HEAP_TIER_1 ? tier1Flags[resourceClass] : D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+
+            // MSAA textures need 4 MB placement alignment, which the heap itself must have.
+            const bool texturesAllowed = m_resourceHeapTier != D3D12_RESOURCE_HEAP_TIER_1 || resourceClass != static_cast<UINT>(ResourceClass::Buffer);
+            pool.heapAlignment = texturesAllowed ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+    }
+}
+
+UINT HeapAllocator_DX12::GetPoolIndex(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc) const
+{
+    ResourceClass resourceClass = ResourceClass::Buffer;
+    if (m_resourceHeapTier == D3D12_RESOURCE_HEAP_TIER_1 && desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        const D3D12_RESOURCE_FLAGS renderTargetFlags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+        resourceClass = (desc.Flags & renderTargetFlags) != 0 ? ResourceClass::RenderTargetTexture : ResourceClass::Texture;
+    }
+    return GetHeapTypeIndex(heapType) * static_cast<UINT>(ResourceClass::Count) + static_cast<UINT>(resourceClass);
+}
+
+HeapAllocator_DX12::Block HeapAllocator_DX12::CreateBlock(const Pool& pool, UINT64 size) const
+{
+    CD3DX12_HEAP_DESC heapDesc(size, pool.heapType, pool.heapAlignment, pool.heapFlags);
+
+    Block block;
+    ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&block.heap)));
+    block.allocator = std::make_unique<TlsfAllocator>(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    return block;
+}
+
+HeapAllocator_DX12::Allocation HeapAllocator_DX12::CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue)
+{
+    const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->GetResourceAllocationInfo(0, 1, &desc);
+    const UINT poolIndex = GetPoolIndex(heapType, desc);
+
+    Allocation allocation;
+    ID3D12Heap* heap = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Pool& pool = m_pools[poolIndex];
+
+        TlsfAllocator::Allocation range;
+        UINT blockIndex = 0;
+        for (; blockIndex < pool.blocks.size(); ++blockIndex)
+        {
+            if (pool.blocks[blockIndex].allocator)
+            {
+                range = pool.blocks[blockIndex].allocator->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+                if (range.IsValid())
+                {
+                    break;
+                }
+            }
+        }
+
+        if (!range.IsValid())
+        {
+            // every block is full (or too fragmented): reserve a new one, in a free slot if there is one. The heap is
+            // heapAlignment aligned, a resource that needs no more than that fits at offset 0 of a block of its size.
+            const UINT64 blockSize = std::max(m_blockSize, TlsfAllocator::AlignUp(allocationInfo.SizeInBytes, pool.heapAlignment));
+            Block block = CreateBlock(pool, blockSize);
+            range = block.allocator->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+            if (!range.IsValid())
+            {
+                // alignment larger than the heap's, not placeable in this pool.
+                ThrowIfFailed(E_OUTOFMEMORY);
+            }
+
+            blockIndex = 0;
+            while (blockIndex < pool.blocks.size() && pool.blocks[blockIndex].allocator)
+            {
+                ++blockIndex;
+            }
+            if (blockIndex == pool.blocks.size())
+            {
+                pool.blocks.emplace_back();
+            }
+            pool.blocks[blockIndex] = std::move(block);
+        }
+
+        allocation.offset = range.offset;
+        allocation.size = range.size;
+        allocation.m_owner = this;
+        allocation.m_pool = poolIndex;
+        allocation.m_block = blockIndex;
+        allocation.m_handle = range.handle;
+        heap = pool.blocks[blockIndex].heap.Get();
+    }
+
+    const HRESULT result = m_device->CreatePlacedResource(heap, allocation.offset, &desc, initialState, clearValue, IID_PPV_ARGS(&allocation.resource));
+    if (FAILED(result))
+    {
+        allocation.Release();
+        ThrowIfFailed(result);
+    }
+    return allocation;
+}
+
+HeapAllocator_DX12::Allocation& HeapAllocator_DX12::Allocation::operator=(Allocation&& other)
+{
+    if (this != &other)
+    {
+        Release();
+        resource = std::move(other.resource);
+        offset = other.offset;
+        size = other.size;
+        m_owner = other.m_owner;
+        m_pool = other.m_pool;
+        m_block = other.m_block;
+        m_handle = other.m_handle;
+        other.m_owner = nullptr;
+        other.m_handle = TlsfAllocator::InvalidHandle;
+    }
+    return *this;
+}
+
+void HeapAllocator_DX12::Allocation::Release()
+{
+    resource.Reset();
+    if (m_owner && m_handle != TlsfAllocator::InvalidHandle)
+    {
+        m_owner->Free(m_pool, m_block, m_handle);
+    }
+    m_owner = nullptr;
+    m_handle = TlsfAllocator::InvalidHandle;
+}
+
+void HeapAllocator_DX12::Free(UINT pool, UINT block, TlsfAllocator::Handle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pools[pool].blocks[block].allocator->Free(handle);
+}
+
+UINT64 HeapAllocator_DX12::ReleaseEmptyBlocks()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    UINT64 releasedBytes = 0;
+    for (Pool& pool : m_pools)
+    {
+        for (Block& block : pool.blocks)
+        {
+            if (block.allocator && block.allocator->IsEmpty())
+            {
+                releasedBytes += block.allocator->GetSize();
+                block = Block();
+            }
+        }
+    }
+    return releasedBytes;
+}
+
+HeapAllocator_DX12::Stats HeapAllocator_DX12::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats;
+    UINT64 freeBytes = 0;
+    for (const Pool& pool : m_pools)
+    {
+        for (const Block& block : pool.blocks)
+        {
+            if (!block.allocator)
+            {
+                continue;
+            }
+
+            const TlsfAllocator::Stats blockStats = block.allocator->GetStats();
+            ++stats.blocks;
+            stats.reservedBytes += blockStats.size;
+            stats.usedBytes += blockStats.usedBytes;
+            stats.allocations += blockStats.allocations;
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, blockStats.largestFreeBlock);
+            freeBytes += blockStats.freeBytes;
+        }
+    }
+
+    stats.utilization = stats.reservedBytes > 0 ? static_cast<double>(stats.usedBytes) / static_cast<double>(stats.reservedBytes) : 0.0;
+    stats.fragmentation = freeBytes > 0 ? 1.0 - static_cast<double>(stats.largestFreeBlock) / static_cast<double>(freeBytes) : 0.0;
+    return stats;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "graphics.h"
+#include "core/TlsfAllocator.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Placed resources suballocated out of large ID3D12Heap blocks instead of one committed resource (and one kernel
+// allocation) each. Blocks are reserved per heap type and, on resource heap tier 1 hardware, per resource class
+// (buffers, render target and depth stencil textures, other textures), and each block is split with a TlsfAllocator at
+// the 64 KB placement granularity. MSAA textures get their 4 MB alignment from the same allocator, texture blocks are
+// created 4 MB aligned.
+//
+// Thread safe. The allocator must outlive its allocations.
+class HeapAllocator_DX12
+{
+public:
+    static const UINT64 DefaultBlockSize = 64 * 1024 * 1024;
+
+    // Placed resource and its range in the heap. Move only, destroying it frees the range: it must outlive the GPU's
+    // use of the resource (Framework_DX12::DeferredRelease takes it over until then).
+    class Allocation
+    {
+    public:
+        Allocation() = default;
+        Allocation(Allocation&& other) { *this = std::move(other); }
+        Allocation& operator=(Allocation&& other);
+        ~Allocation() { Release(); }
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+
+        bool IsValid() const { return resource != nullptr; }
+        void Release(); // free now, the GPU must be done with the resource
+
+        ComPtr<ID3D12Resource> resource;
+        UINT64 offset { 0 }; // in the heap
+        UINT64 size { 0 };
+
+    private:
+        friend class HeapAllocator_DX12;
+
+        HeapAllocator_DX12* m_owner { nullptr };
+        UINT m_pool { 0 };
+        UINT m_block { 0 };
+        TlsfAllocator::Handle m_handle { TlsfAllocator::InvalidHandle };
+    };
+
+    struct Stats
+    {
+        UINT64 blocks { 0 };
+        UINT64 reservedBytes { 0 };  // heap memory
+        UINT64 usedBytes { 0 };      // placed resources, rounded up to the granularity
+        UINT64 allocations { 0 };
+        UINT64 largestFreeBlock { 0 };
+        double utilization { 0.0 };   // usedBytes / reservedBytes
+        double fragmentation { 0.0 }; // 1 - largest free block / free bytes, over every block
+    };
+
+    // blockSize: size of the heaps reserved, resources larger than it get a heap of their own.
+    explicit HeapAllocator_DX12(ComPtr<ID3D12Device> device, UINT64 blockSize = DefaultBlockSize);
+
+    HeapAllocator_DX12(const HeapAllocator_DX12&) = delete;
+    HeapAllocator_DX12& operator=(const HeapAllocator_DX12&) = delete;
+
+    // Create a placed resource, throws when the device is out of memory.
+    Allocation CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+    // Destroy the blocks nothing is placed in anymore, returns the bytes given back.
+    UINT64 ReleaseEmptyBlocks();
+
+    Stats GetStats() const;
+    D3D12_RESOURCE_HEAP_TIER GetResourceHeapTier() const { return m_resourceHeapTier; }
+
+private:
+    enum class ResourceClass : UINT
+    {
+        Buffer = 0,
+        Texture,             // neither render target nor depth stencil
+        RenderTargetTexture, // render target or depth stencil
+        Count
+    };
+
+    struct Block
+    {
+        ComPtr<ID3D12Heap> heap;
+        std::unique_ptr<TlsfAllocator> allocator;
+    };
+
+    struct Pool
+    {
+        D3D12_HEAP_TYPE heapType { D3D12_HEAP_TYPE_DEFAULT };
+        D3D12_HEAP_FLAGS heapFlags { D3D12_HEAP_FLAG_NONE };
+        UINT64 heapAlignment { D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+        std::vector<Block> blocks; // destroyed blocks leave an empty slot, allocations keep their block index
+    };
+
+    static const UINT HeapTypeCount = 3; // default, upload, readback
+
+    UINT GetPoolIndex(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc) const;
+    Block CreateBlock(const Pool& pool, UINT64 size) const;
+    void Free(UINT pool, UINT block, TlsfAllocator::Handle handle);
+
+    ComPtr<ID3D12Device> m_device;
+    UINT64 m_blockSize;
+    D3D12_RESOURCE_HEAP_TIER m_resourceHeapTier { D3D12_RESOURCE_HEAP_TIER_1 };
+
+    mutable std::mutex m_mutex;
+    Pool m_pools[HeapTypeCount * static_cast<UINT>(ResourceClass::Count)];
+};
@@ -0,0 +1,67 @@
+#include "stdafx.h"
+#include "ParallelRecorder_DX12.h"
+#include "core/Profiler.h"
+
+ParallelRecorder_DX12::ParallelRecorder_DX12(ComPtr<ID3D12Device> device, D3D12_COMMAND_LIST_TYPE type, CommandAllocatorPool& allocatorPool, JobSystem& jobSystem)
+    : m_device(device)
+    , m_type(type)
+    , m_allocatorPool(allocatorPool)
+    , m_jobSystem(jobSystem)
+{
+}
+
+void ParallelRecorder_DX12::Record(UINT listCount, const RecordFunction& record, std::vector<ID3D12CommandList*>& commandLists)
+{
+    if (listCount == 0)
+    {
+        return;
+    }
+
+    const size_t firstAllocator = m_allocatorsInUse.size();
+    for (UINT i = 0; i < listCount; ++i)
+    {
+        m_allocatorsInUse.push_back(m_allocatorPool.Acquire());
+    }
+
+    // lists are created lazily on the recording thread, creation is thread safe on the device.
+    // Lists recorded earlier but not submitted yet keep their slot.
+    const size_t firstList = firstAllocator;
+    if (m_commandLists.size() < firstList + listCount)
+    {
+        m_commandLists.resize(firstList + listCount);
+    }
+
+    m_jobSystem.ParallelFor(listCount, 1, [&](uint32_t listIndex)
+    {
+        auto& commandList = m_commandLists[firstList + listIndex];
+        ID3D12CommandAllocator* commandAllocator = m_allocatorsInUse[firstAllocator + listIndex].Get();
+
+        if (!commandList)
+        {
+            ThrowIfFailed(m_device->CreateCommandList(0, m_type, commandAllocator, nullptr, IID_PPV_ARGS(&commandList)));
+        }
+        else
+        {
+            ThrowIfFailed(commandList->Reset(commandAllocator, nullptr));
+        }
+
+        record(commandList.Get(), listIndex);
+
+        PROFILE_ZONE("Close");
+        ThrowIfFailed(commandList->Close());
+    });
+
+    for (UINT i = 0; i < listCount; ++i)
+    {
+        commandLists.push_back(m_commandLists[firstList + i].Get());
+    }
+}
+
+void ParallelRecorder_DX12::Submitted(uint64_t fenceValue)
+{
+    for (auto& commandAllocator : m_allocatorsInUse)
+    {
+        m_allocatorPool.Release(std::move(commandAllocator), fenceValue);
+    }
+    m_allocatorsInUse.clear();
+}
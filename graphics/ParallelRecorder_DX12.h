@@ -0,0 +1,35 @@
+#pragma once
+#include "graphics.h"
+#include "core/FencedPool.h"
+#include "core/JobSystem.h"
+#include <functional>
+#include <vector>
+
+// Splits the recording of a frame across the job system workers. Each list gets its own allocator from the pool and is
+// recorded on whichever worker picks it up, the closed lists are handed back in list index order so the whole frame
+// can be submitted with a single ExecuteCommandLists.
+class ParallelRecorder_DX12
+{
+public:
+    using CommandAllocatorPool = FencedPool<ComPtr<ID3D12CommandAllocator>>;
+    using RecordFunction = std::function<void(ID3D12GraphicsCommandList* commandList, UINT listIndex)>;
+
+    ParallelRecorder_DX12(ComPtr<ID3D12Device> device, D3D12_COMMAND_LIST_TYPE type, CommandAllocatorPool& allocatorPool, JobSystem& jobSystem);
+
+    // Record listCount command lists in parallel and append them, closed, to commandLists in listIndex order.
+    // Blocks until every list has been recorded (the calling thread records too). Can be called several times per submission.
+    void Record(UINT listCount, const RecordFunction& record, std::vector<ID3D12CommandList*>& commandLists);
+
+    // The lists recorded since the last call have been submitted and are followed by a signal of fenceValue,
+    // their allocators go back to the pool.
+    void Submitted(uint64_t fenceValue);
+
+private:
+    ComPtr<ID3D12Device> m_device;
+    D3D12_COMMAND_LIST_TYPE m_type;
+    CommandAllocatorPool& m_allocatorPool;
+    JobSystem& m_jobSystem;
+
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_commandLists; // grows to the largest list count per submission, a list can be reset as soon as it has been submitted
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_allocatorsInUse; // one per list recorded since the last submission, same index as the list
+};
@@ -0,0 +1,196 @@
+#include "stdafx.h"
+#include "RenderGraph_DX12.h"
+#include "Device_DX12.h"
+
+RenderGraph_DX12::RenderGraph_DX12(ComPtr<ID3D12Device> device, ReleaseFunction release)
+    : m_device(device)
+    , m_release(std::move(release))
+{
+}
+
+void RenderGraph_DX12::Reset()
+{
+    m_graph.Reset();
+    m_resources.clear();
+    m_textures.clear();
+    m_executes.clear();
+    m_nextCompiledPass = 0;
+}
+
+RenderGraph_DX12::ResourceHandle RenderGraph_DX12::ImportResource(const std::string& name, ID3D12Resource* resource,
+    ResourceState initialState, ResourceState finalState)
+{
+    const ResourceHandle handle = m_graph.ImportResource(name, initialState, finalState);
+    m_resources.push_back(resource);
+    m_textures.emplace_back();
+    return handle;
+}
+
+RenderGraph_DX12::ResourceHandle RenderGraph_DX12::CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+    const D3D12_CLEAR_VALUE* clearValue)
+{
+    const D3D12_RESOURCE_FLAGS renderTargetFlags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    assert(desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && (desc.Flags & renderTargetFlags) != 0 && "transient resources are render target or depth stencil textures");
+    (void)renderTargetFlags;
+
+    const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->GetResourceAllocationInfo(0, 1, &desc);
+    const ResourceHandle handle = m_graph.CreateTransient(name, allocationInfo.SizeInBytes, allocationInfo.Alignment);
+
+    Texture texture = {};
+    texture.desc = desc;
+    texture.hasClearValue = clearValue != nullptr;
+    if (clearValue)
+    {
+        texture.clearValue = *clearValue;
+    }
+
+    m_resources.push_back(nullptr);
+    m_textures.push_back(texture);
+    return handle;
+}
+
+RenderGraph_DX12::PassHandle RenderGraph_DX12::AddPass(const std::string& name, ExecuteFunction execute, bool sideEffects)
+{
+    const PassHandle pass = m_graph.AddPass(name, sideEffects);
+    m_executes.push_back(std::move(execute));
+    return pass;
+}
+
+bool RenderGraph_DX12::IsSameTexture(const Texture& a, const Texture& b)
+{
+    return memcmp(&a.desc, &b.desc, sizeof(a.desc)) == 0 && a.hasClearValue == b.hasClearValue &&
+        (!a.hasClearValue || memcmp(&a.clearValue, &b.clearValue, sizeof(a.clearValue)) == 0);
+}
+
+void RenderGraph_DX12::ReleaseCache()
+{
+    for (auto& cached : m_cache)
+    {
+        m_release(std::move(cached.resource));
+    }
+    m_cache.clear();
+}
+
+void RenderGraph_DX12::Compile()
+{
+    m_graph.Compile();
+    m_nextCompiledPass = 0;
+
+    // a larger heap replaces the current one, every texture placed in it goes with it. Grown by half again to settle quickly.
+    const UINT64 heapSize = m_graph.GetTransientHeapSize();
+    if (heapSize > m_heapSize)
+    {
+        ReleaseCache();
+        if (m_heap)
+        {
+            m_release(std::move(m_heap));
+        }
+
+        m_heapSize = TlsfAllocator::AlignUp(heapSize + heapSize / 2, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+        CD3DX12_HEAP_DESC heapDesc(m_heapSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+        ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+        NAME_D3D12_OBJECT(m_heap);
+    }
+
+    for (auto& cached : m_cache)
+    {
+        cached.used = false;
+    }
+
+    for (ResourceHandle handle = 0; handle < m_graph.GetResourceCount(); ++handle)
+    {
+        if (m_graph.IsImported(handle) || !m_graph.IsUsed(handle))
+        {
+            continue;
+        }
+
+        const Texture& texture = m_textures[handle];
+        const UINT64 offset = m_graph.GetTransientOffset(handle);
+        const ResourceState initialState = m_graph.GetInitialState(handle);
+
+        auto cached = std::find_if(m_cache.begin(), m_cache.end(), [&](const CachedTexture& candidate)
+        {
+            return !candidate.used && candidate.offset == offset && candidate.initialState == initialState && IsSameTexture(candidate.texture, texture);
+        });
+
+        if (cached == m_cache.end())
+        {
+            ComPtr<ID3D12Resource> resource;
+            ThrowIfFailed(m_device->CreatePlacedResource(m_heap.Get(), offset, &texture.desc, Device_DX12::ToD3D12(initialState),
+                texture.hasClearValue ? &texture.clearValue : nullptr, IID_PPV_ARGS(&resource)));
+            m_cache.push_back(CachedTexture{ texture, offset, initialState, resource, false });
+            cached = m_cache.end() - 1;
+        }
+
+        cached->used = true;
+        m_resources[handle] = cached->resource.Get();
+    }
+
+    // textures the graph doesn't need anymore.
+    auto unused = std::partition(m_cache.begin(), m_cache.end(), [](const CachedTexture& cached) { return cached.used; });
+    for (auto it = unused; it != m_cache.end(); ++it)
+    {
+        m_release(std::move(it->resource));
+    }
+    m_cache.erase(unused, m_cache.end());
+}
+
+void RenderGraph_DX12::RecordBarriers(ID3D12GraphicsCommandList* commandList, const RenderGraph::BarrierBatch& batch)
+{
+    if (batch.count == 0)
+    {
+        return;
+    }
+
+    m_barriers.clear();
+    const auto& barriers = m_graph.GetBarriers();
+    for (uint32_t i = batch.first; i < batch.first + batch.count; ++i)
+    {
+        const RenderGraph::Barrier& barrier = barriers[i];
+        ID3D12Resource* resource = m_resources[barrier.resource];
+        switch (barrier.type)
+        {
+        case RenderGraph::Barrier::Type::Aliasing:
+            m_barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(
+                barrier.resourceBefore != RenderGraph::InvalidHandle ? m_resources[barrier.resourceBefore] : nullptr, resource));
+            break;
+        case RenderGraph::Barrier::Type::UnorderedAccess:
+            m_barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+            break;
+        default:
+            m_barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, Device_DX12::ToD3D12(barrier.before), Device_DX12::ToD3D12(barrier.after)));
+            break;
+        }
+    }
+
+    commandList->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+}
+
+void RenderGraph_DX12::RecordPass(ID3D12GraphicsCommandList* commandList, uint32_t compiledIndex, bool execute)
+{
+    const RenderGraph::CompiledPass& compiled = m_graph.GetCompiledPasses()[compiledIndex];
+    RecordBarriers(commandList, compiled.barriers);
+    if (execute && m_executes[compiled.pass])
+    {
+        m_executes[compiled.pass](commandList);
+    }
+}
+
+void RenderGraph_DX12::RecordUntil(ID3D12GraphicsCommandList* commandList, PassHandle pass)
+{
+    const auto& compiledPasses = m_graph.GetCompiledPasses();
+    while (m_nextCompiledPass < compiledPasses.size() && compiledPasses[m_nextCompiledPass].pass <= pass)
+    {
+        const bool isPass = compiledPasses[m_nextCompiledPass].pass == pass;
+        RecordPass(commandList, m_nextCompiledPass++, !isPass);
+    }
+}
+
+void RenderGraph_DX12::RecordRemaining(ID3D12GraphicsCommandList* commandList)
+{
+    while (m_nextCompiledPass < m_graph.GetCompiledPasses().size())
+    {
+        RecordPass(commandList, m_nextCompiledPass++, true);
+    }
+    RecordBarriers(commandList, m_graph.GetFinalBarriers());
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "graphics.h"
+#include "core/RenderGraph.h"
+
+#include <functional>
+#include <vector>
+
+// RenderGraph recorded into D3D12 command lists. Transient textures are placed resources in one heap sized to the
+// compiled graph, created in the state of their first pass and kept from frame to frame as long as their description
+// and placement don't change. Each barrier batch of the plan is a single ResourceBarrier call.
+//
+// Transient resources are render target or depth stencil textures, the only kind a heap can mix on every resource heap
+// tier (D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES).
+class RenderGraph_DX12
+{
+public:
+    using ResourceHandle = RenderGraph::ResourceHandle;
+    using PassHandle = RenderGraph::PassHandle;
+    using ExecuteFunction = std::function<void(ID3D12GraphicsCommandList*)>;
+    // Releases a heap or resource once the frames using it are done (Framework_DX12::DeferredRelease).
+    using ReleaseFunction = std::function<void(ComPtr<IUnknown>)>;
+
+    RenderGraph_DX12(ComPtr<ID3D12Device> device, ReleaseFunction release);
+
+    RenderGraph_DX12(const RenderGraph_DX12&) = delete;
+    RenderGraph_DX12& operator=(const RenderGraph_DX12&) = delete;
+
+    // Start describing a new frame.
+    void Reset();
+
+    ResourceHandle ImportResource(const std::string& name, ID3D12Resource* resource, ResourceState initialState, ResourceState finalState);
+    ResourceHandle CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+    // execute records the pass, it may be empty for work recorded elsewhere (see RecordUntil()).
+    PassHandle AddPass(const std::string& name, ExecuteFunction execute, bool sideEffects = false);
+    void Read(PassHandle pass, ResourceHandle resource, ResourceState state) { m_graph.Read(pass, resource, state); }
+    void Write(PassHandle pass, ResourceHandle resource, ResourceState state) { m_graph.Write(pass, resource, state); }
+
+    // Cull, plan the barriers and place the transient textures, creating what's missing.
+    void Compile();
+
+    // Record the passes not recorded yet that come before pass, and the barriers of pass itself: pass can then be
+    // recorded in other command lists (in parallel for instance), its execute function isn't called.
+    void RecordUntil(ID3D12GraphicsCommandList* commandList, PassHandle pass);
+    // Record every pass left and the final barriers.
+    void RecordRemaining(ID3D12GraphicsCommandList* commandList);
+
+    // Valid once compiled, for the execute functions.
+    ID3D12Resource* GetResource(ResourceHandle resource) const { return m_resources[resource]; }
+
+    const RenderGraph& GetGraph() const { return m_graph; }
+    UINT64 GetHeapSize() const { return m_heapSize; }
+
+private:
+    struct Texture
+    {
+        D3D12_RESOURCE_DESC desc;
+        D3D12_CLEAR_VALUE clearValue;
+        bool hasClearValue;
+    };
+
+    // Placed resource kept for the next frames.
+    struct CachedTexture
+    {
+        Texture texture;
+        UINT64 offset;
+        ResourceState initialState;
+        ComPtr<ID3D12Resource> resource;
+        bool used; // this frame
+    };
+
+    static bool IsSameTexture(const Texture& a, const Texture& b);
+
+    void RecordPass(ID3D12GraphicsCommandList* commandList, uint32_t compiledIndex, bool execute);
+    void RecordBarriers(ID3D12GraphicsCommandList* commandList, const RenderGraph::BarrierBatch& batch);
+    void ReleaseCache();
+
+    ComPtr<ID3D12Device> m_device;
+    ReleaseFunction m_release;
+    RenderGraph m_graph;
+
+    std::vector<ID3D12Resource*> m_resources; // by handle
+    std::vector<Texture> m_textures;          // by handle, transient resources only
+    std::vector<ExecuteFunction> m_executes;  // by pass
+    uint32_t m_nextCompiledPass { 0 };        // first compiled pass not recorded yet
+
+    ComPtr<ID3D12Heap> m_heap;
+    UINT64 m_heapSize { 0 };
+    std::vector<CachedTexture> m_cache;
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers; // one batch, reused
+};
@@ -0,0 +1,65 @@
+#include "stdafx.h"
+#include "ResourceStateTracker_DX12.h"
+#include "Device_DX12.h"
+
+UINT ResourceStateTracker_DX12::GetSubresourceCount(ID3D12Device* device, ID3D12Resource* resource)
+{
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        return 1;
+    }
+
+    const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+    const UINT planeCount = std::max<UINT>(1, D3D12GetFormatPlaneCount(device, desc.Format));
+    return desc.MipLevels * arraySize * planeCount;
+}
+
+D3D12_RESOURCE_BARRIER ResourceStateTracker_DX12::ToD3D12(const ResourceStateTracker::Barrier& barrier)
+{
+    ID3D12Resource* resource = static_cast<ID3D12Resource*>(const_cast<void*>(barrier.resource));
+    if (barrier.type == ResourceStateTracker::Barrier::Type::UnorderedAccess)
+    {
+        return CD3DX12_RESOURCE_BARRIER::UAV(resource);
+    }
+
+    D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    if (barrier.split == ResourceStateTracker::Barrier::Split::Begin)
+    {
+        flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+    }
+    else if (barrier.split == ResourceStateTracker::Barrier::Split::End)
+    {
+        flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+    }
+
+    return CD3DX12_RESOURCE_BARRIER::Transition(resource, Device_DX12::ToD3D12(barrier.before), Device_DX12::ToD3D12(barrier.after),
+        barrier.subresource, flags);
+}
+
+void ResourceStateTracker_DX12::Flush(ID3D12GraphicsCommandList* commandList)
+{
+    m_barriers.clear();
+    if (m_tracker.Flush(m_barriers) == 0)
+    {
+        return;
+    }
+
+    m_d3d12Barriers.clear();
+    for (const auto& barrier : m_barriers)
+    {
+        m_d3d12Barriers.push_back(ToD3D12(barrier));
+    }
+    commandList->ResourceBarrier(static_cast<UINT>(m_d3d12Barriers.size()), m_d3d12Barriers.data());
+}
+
+size_t ResourceStateTracker_DX12::Resolve(ResourceStateRegistry& registry, std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+{
+    m_barriers.clear();
+    const size_t count = m_tracker.Resolve(registry, m_barriers);
+    for (const auto& barrier : m_barriers)
+    {
+        barriers.push_back(ToD3D12(barrier));
+    }
+    return count;
+}
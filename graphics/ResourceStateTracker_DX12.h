@@ -0,0 +1,39 @@
+#pragma once
+#include "graphics.h"
+#include "core/ResourceStateTracker.h"
+
+#include <vector>
+
+// ResourceStateTracker for an ID3D12GraphicsCommandList: transitions requested while recording are queued and go out
+// in one ResourceBarrier call per Flush(), the first use of each resource is resolved at submission into fixup barriers
+// executed right before the list.
+class ResourceStateTracker_DX12
+{
+public:
+    explicit ResourceStateTracker_DX12(const ResourceStateRegistry& registry) : m_tracker(registry) {}
+
+    // Subresources of resource as D3D12 counts them (mips x array slices x planes).
+    static UINT GetSubresourceCount(ID3D12Device* device, ID3D12Resource* resource);
+
+    void Reset() { m_tracker.Reset(); }
+
+    void Transition(ID3D12Resource* resource, ResourceState state, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) { m_tracker.Transition(resource, state, subresource); }
+    void BeginTransition(ID3D12Resource* resource, ResourceState state, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) { m_tracker.BeginTransition(resource, state, subresource); }
+    void EndTransition(ID3D12Resource* resource, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) { m_tracker.EndTransition(resource, subresource); }
+    void UnorderedAccessBarrier(ID3D12Resource* resource) { m_tracker.UnorderedAccessBarrier(resource); }
+
+    // Record the queued barriers, before any draw, dispatch or copy depending on them and before closing the list.
+    void Flush(ID3D12GraphicsCommandList* commandList);
+
+    // At submission, in submission order: append the barriers the list needs in front of it to barriers and commit its states.
+    size_t Resolve(ResourceStateRegistry& registry, std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+
+    const ResourceStateTracker::Stats& GetStats() const { return m_tracker.GetStats(); }
+
+    static D3D12_RESOURCE_BARRIER ToD3D12(const ResourceStateTracker::Barrier& barrier);
+
+private:
+    ResourceStateTracker m_tracker;
+    std::vector<ResourceStateTracker::Barrier> m_barriers; // reused
+    std::vector<D3D12_RESOURCE_BARRIER> m_d3d12Barriers;
+};
@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include "RootSignatureCache_DX12.h"
+
+RootSignatureCache_DX12::RootSignatureCache_DX12(ComPtr<ID3D12Device> device)
+    : m_device(device)
+{
+    D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+    featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData))))
+    {
+        m_version = featureData.HighestVersion;
+    }
+}
+
+ComPtr<ID3D12RootSignature> RootSignatureCache_DX12::GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.requests;
+
+    // a 1.0 description is serialized as 1.0 whatever the device supports.
+    m_key.Build(desc, desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0 ? D3D_ROOT_SIGNATURE_VERSION_1_0 : m_version);
+    const auto range = m_entries.equal_range(m_key.GetHash());
+    for (auto entry = range.first; entry != range.second; ++entry)
+    {
+        if (entry->second.key == m_key.GetWords())
+        {
+            ++m_stats.hits;
+            return entry->second.rootSignature;
+        }
+    }
+
+    Entry entry;
+    entry.key = m_key.GetWords();
+    entry.rootSignature = Create(desc);
+    m_entries.emplace(m_key.GetHash(), entry);
+    ++m_stats.rootSignatures;
+    return entry.rootSignature;
+}
+
+ComPtr<ID3D12RootSignature> RootSignatureCache_DX12::Create(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc)
+{
+    ComPtr<ID3D12RootSignature> rootSignature;
+
+    if (const BlobCache::Blob* blob = m_blobs.Find(m_key.GetWords()))
+    {
+        // a stale or corrupted blob is serialized again below.
+        if (SUCCEEDED(m_device->CreateRootSignature(0, blob->data(), blob->size(), IID_PPV_ARGS(&rootSignature))))
+        {
+            ++m_stats.blobHits;
+            return rootSignature;
+        }
+    }
+
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT result = E_INVALIDARG;
+    if (desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0)
+    {
+        result = D3D12SerializeRootSignature(&desc.Desc_1_0, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    }
+    else if (m_version == D3D_ROOT_SIGNATURE_VERSION_1_1)
+    {
+        result = D3D12SerializeVersionedRootSignature(&desc, &signature, &error);
+    }
+    else if (const D3D12_ROOT_SIGNATURE_DESC* desc10 = m_downgrade.Convert(desc.Desc_1_1))
+    {
+        result = D3D12SerializeRootSignature(desc10, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    }
+    if (error)
+    {
+        LOG("Root signature serialization: %s\n", static_cast<const char*>(error->GetBufferPointer()));
+    }
+    ThrowIfFailed(result);
+    ++m_stats.serializations;
+
+    ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature)));
+    m_blobs.Insert(m_key.GetWords(), signature->GetBufferPointer(), signature->GetBufferSize());
+    return rootSignature;
+}
+
+bool RootSignatureCache_DX12::LoadBlobs(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_blobs.Load(path);
+}
+
+bool RootSignatureCache_DX12::SaveBlobs(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_blobs.IsDirty() || m_blobs.Save(path);
+}
+
+RootSignatureCache_DX12::Stats RootSignatureCache_DX12::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
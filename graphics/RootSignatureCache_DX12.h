@@ -0,0 +1,62 @@
+#pragma once
+#include "graphics.h"
+#include "core/BlobCache.h"
+#include "core/RootSignatureDesc.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// One ID3D12RootSignature per distinct description: GetOrCreate() hashes the description (RootSignatureKey) and hands
+// back the root signature already created for an identical one, so pipelines built from the same layout share it and
+// the description is serialized once. 1.1 descriptions are downgraded in place on devices without 1.1 support
+// (RootSignatureDowngrade) rather than through D3DX12SerializeVersionedRootSignature, which allocates and frees the
+// converted arrays on every call. The serialized blobs can be kept on disk to skip serialization on the next run.
+// Thread safe.
+class RootSignatureCache_DX12
+{
+public:
+    struct Stats
+    {
+        uint64_t requests { 0 };
+        uint64_t hits { 0 }; // found in memory
+        uint64_t blobHits { 0 }; // created from a loaded blob, without serializing
+        uint64_t serializations { 0 };
+        uint64_t rootSignatures { 0 };
+    };
+
+    explicit RootSignatureCache_DX12(ComPtr<ID3D12Device> device);
+
+    RootSignatureCache_DX12(const RootSignatureCache_DX12&) = delete;
+    RootSignatureCache_DX12& operator=(const RootSignatureCache_DX12&) = delete;
+
+    ComPtr<ID3D12RootSignature> GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc);
+
+    // Highest version the device supports, the one 1.1 descriptions are serialized as.
+    D3D_ROOT_SIGNATURE_VERSION GetVersion() const { return m_version; }
+
+    // Serialized blobs from and to a file, a missing or unreadable file just starts empty. Save only writes when blobs were added.
+    bool LoadBlobs(const std::string& path);
+    bool SaveBlobs(const std::string& path);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry
+    {
+        std::vector<uint32_t> key;
+        ComPtr<ID3D12RootSignature> rootSignature;
+    };
+
+    ComPtr<ID3D12RootSignature> Create(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc);
+
+    ComPtr<ID3D12Device> m_device;
+    D3D_ROOT_SIGNATURE_VERSION m_version { D3D_ROOT_SIGNATURE_VERSION_1_0 };
+
+    mutable std::mutex m_mutex;
+    std::unordered_multimap<uint64_t, Entry> m_entries; // by key hash
+    RootSignatureKey m_key; // of the description being looked up, storage reused
+    RootSignatureDowngrade m_downgrade;
+    BlobCache m_blobs;
+    Stats m_stats;
+};
@@ -0,0 +1,29 @@
+#include "stdafx.h"
+#include "SwapChainPresenter_DX12.h"
+
+SwapChainPresenter_DX12::SwapChainPresenter_DX12(ComPtr<IDXGISwapChain4> swapChain, bool supportTearing)
+    : m_swapChain(swapChain)
+    , m_supportTearing(supportTearing)
+{
+}
+
+uint32_t SwapChainPresenter_DX12::GetBufferCount() const
+{
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    ThrowIfFailed(m_swapChain->GetDesc1(&swapChainDesc));
+    return swapChainDesc.BufferCount;
+}
+
+uint32_t SwapChainPresenter_DX12::GetCurrentBufferIndex() const
+{
+    return m_swapChain->GetCurrentBackBufferIndex();
+}
+
+void SwapChainPresenter_DX12::Present(bool vSync)
+{
+    // tearing is only allowed without vsync, it lets variable refresh rate displays show frames as soon as they are ready.
+    const UINT syncInterval = vSync ? 1 : 0;
+    const UINT presentFlags = m_supportTearing && !vSync ? DXGI_PRESENT_ALLOW_TEARING : 0;
+    ThrowIfFailed(m_swapChain->Present(syncInterval, presentFlags));
+    ++m_presentCount;
+}
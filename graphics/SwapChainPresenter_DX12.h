@@ -0,0 +1,21 @@
+#pragma once
+#include "graphics.h"
+#include "core/Presenter.h"
+
+// Presenter on top of a DXGI flip model swap chain, the back buffer index comes from the swap chain.
+class SwapChainPresenter_DX12 : public Presenter
+{
+public:
+    SwapChainPresenter_DX12(ComPtr<IDXGISwapChain4> swapChain, bool supportTearing);
+
+    virtual bool IsHeadless() const override { return false; }
+    virtual uint32_t GetBufferCount() const override;
+    virtual uint32_t GetCurrentBufferIndex() const override;
+    virtual void Present(bool vSync) override;
+
+    IDXGISwapChain4* GetSwapChain() const { return m_swapChain.Get(); }
+
+private:
+    ComPtr<IDXGISwapChain4> m_swapChain;
+    bool m_supportTearing;
+};
@@ -0,0 +1,41 @@
+#include "stdafx.h"
+#include "UploadRing_DX12.h"
+
+UploadRing_DX12::UploadRing_DX12(ComPtr<ID3D12Device> device, FenceTimeline& timeline, UINT64 capacity)
+    : m_allocator(timeline, capacity)
+{
+    const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+    ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_buffer)));
+    NAME_D3D12_OBJECT(m_buffer);
+
+    // upload heaps can stay mapped while the GPU reads them, the CPU never reads back.
+    const D3D12_RANGE readRange = { 0, 0 };
+    void* data = nullptr;
+    ThrowIfFailed(m_buffer->Map(0, &readRange, &data));
+    m_cpuBase = static_cast<BYTE*>(data);
+    m_gpuBase = m_buffer->GetGPUVirtualAddress();
+}
+
+UploadRing_DX12::~UploadRing_DX12()
+{
+    m_buffer->Unmap(0, nullptr);
+}
+
+UploadRing_DX12::Allocation UploadRing_DX12::Allocate(UINT64 size, UINT64 alignment)
+{
+    Allocation allocation;
+    const uint64_t offset = m_allocator.Allocate(size, alignment);
+    if (offset == LinearRingAllocator::InvalidOffset)
+    {
+        return allocation;
+    }
+
+    allocation.cpuAddress = m_cpuBase + offset;
+    allocation.gpuAddress = m_gpuBase + offset;
+    allocation.resource = m_buffer.Get();
+    allocation.offset = offset;
+    allocation.size = size;
+    return allocation;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "graphics.h"
+#include "core/LinearRingAllocator.h"
+
+// Upload heap buffer mapped once for its whole lifetime and suballocated linearly per frame (LinearRingAllocator), for
+// dynamic constants and vertex data written by the CPU each frame. No map/unmap and no resource creation per frame:
+// an allocation is a pointer to write through and the GPU address to bind.
+class UploadRing_DX12
+{
+public:
+    struct Allocation
+    {
+        void* cpuAddress { nullptr };
+        D3D12_GPU_VIRTUAL_ADDRESS gpuAddress { 0 };
+        ID3D12Resource* resource { nullptr };
+        UINT64 offset { 0 }; // in resource
+        UINT64 size { 0 };
+
+        bool IsValid() const { return cpuAddress != nullptr; }
+    };
+
+    // timeline is the one of the queue consuming the data.
+    UploadRing_DX12(ComPtr<ID3D12Device> device, FenceTimeline& timeline, UINT64 capacity);
+    ~UploadRing_DX12();
+
+    UploadRing_DX12(const UploadRing_DX12&) = delete;
+    UploadRing_DX12& operator=(const UploadRing_DX12&) = delete;
+
+    // size bytes aligned to alignment, invalid when the ring is full. Thread safe.
+    Allocation Allocate(UINT64 size, UINT64 alignment = 16);
+
+    // Constant buffer data: 256 byte placement alignment, size rounded up the same way.
+    Allocation AllocateConstants(UINT size) { return Allocate(CalculateConstantBufferByteSize(size), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT); }
+
+    // Once per frame, after the signal of the submission using this frame's allocations.
+    void EndFrame(uint64_t fenceValue) { m_allocator.EndFrame(fenceValue); }
+    // Hand back the space of the frames the GPU is done with, doesn't block.
+    void RetireCompleted() { m_allocator.RetireCompleted(); }
+
+    LinearRingAllocator::Stats GetStats() const { return m_allocator.GetStats(); }
+    ID3D12Resource* GetResource() const { return m_buffer.Get(); }
+
+private:
+    ComPtr<ID3D12Resource> m_buffer;
+    BYTE* m_cpuBase { nullptr };
+    D3D12_GPU_VIRTUAL_ADDRESS m_gpuBase { 0 };
+    LinearRingAllocator m_allocator;
+};
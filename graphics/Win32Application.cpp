@@ -12,12 +12,70 @@
 #include "stdafx.h"
 #include "Win32Application.h"
 #include "Resource.h"
+#include "Clock_Win32.h"
+#include "core/FramePacer.h"
+#include "core/HeadlessRunner.h"
 
 // In order to define a function called CreateWindow, the Windows macro needs to be undefined.
 #if defined(CreateWindow)
 #undef CreateWindow
 #endif
 
+namespace
+{
+    // Process CPU time (kernel + user, all threads) in 100ns units.
+    ULONGLONG GetProcessCpuTime()
+    {
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+
+        ULARGE_INTEGER kernel, user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+        return kernel.QuadPart + user.QuadPart;
+    }
+
+    // Logs the frame pacing statistics about once per second.
+    class FrameStatsReporter
+    {
+    public:
+        explicit FrameStatsReporter(const Clock& clock)
+            : m_clock(clock)
+            , m_lastReport(clock.Now())
+            , m_lastCpuTime(GetProcessCpuTime())
+        {
+        }
+
+        void Update(const FramePacer& pacer)
+        {
+            const auto now = m_clock.Now();
+            const auto elapsed = now - m_lastReport;
+            if (elapsed < std::chrono::seconds(1))
+            {
+                return;
+            }
+
+            const auto cpuTime = GetProcessCpuTime();
+            const double processCpu = static_cast<double>(cpuTime - m_lastCpuTime) * 100.0 / static_cast<double>(elapsed.count());
+
+            const auto stats = pacer.GetStats();
+            LOG("frame %.2f ms, jitter %.3f ms, max %.2f ms, pacing thread busy %.0f%% (spin %.0f%%), process cpu %.0f%% of a core, missed %llu\n",
+                stats.averageFrameMs, stats.jitterMs, stats.maxFrameMs, stats.cpuBusyFraction * 100.0, stats.spinFraction * 100.0,
+                processCpu * 100.0, static_cast<unsigned long long>(stats.missedDeadlines));
+
+            m_lastReport = now;
+            m_lastCpuTime = cpuTime;
+        }
+
+    private:
+        const Clock& m_clock;
+        Clock::Duration m_lastReport;
+        ULONGLONG m_lastCpuTime;
+    };
+}
+
 HWND Win32Application::m_hwnd = nullptr;
 std::wstring Win32Application::m_title = _T("graphics");
 
@@ -26,6 +84,10 @@ bool Win32Application::m_useFullScreen = false;
 
 Framework* Win32Application::m_framework = nullptr;
 
+RenderThread Win32Application::m_renderThread;
+bool Win32Application::m_useRenderThread = true;
+std::exception_ptr Win32Application::m_renderThreadError;
+
 
 void Win32Application::RegisterWindowClass(HINSTANCE hInst, const wchar_t* windowClassName)
 {
@@ -88,12 +150,18 @@ HWND Win32Application::CreateWindow(const wchar_t* windowClassName, HINSTANCE hI
 int Win32Application::Run(Framework* frameworkPtr, HINSTANCE hInstance, int nCmdShow)
 {
     m_framework = frameworkPtr;
+    PROFILE_THREAD_NAME("Main thread");
     // Parse the command line parameters
     int argc;
     LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
     frameworkPtr->ParseCommandLineArgs(argv, argc);
     LocalFree(argv);
 
+    if (frameworkPtr->IsHeadless())
+    {
+        return RunHeadless(frameworkPtr);
+    }
+
     // Windows 10 Creators update adds Per Monitor V2 DPI awareness context.
     // Using this awareness context allows the client area of the window 
     // to achieve 100% scaling while still allowing non-client window content to 
@@ -114,24 +182,209 @@ int Win32Application::Run(Framework* frameworkPtr, HINSTANCE hInstance, int nCmd
 
     ShowWindow(m_hwnd, nCmdShow);
 
-    // Main sample loop.
+    // Frames are paced to the target frame rate: a high resolution timer sleep plus a short final spin.
+    Clock_Win32 clock;
+    FramePacer pacer(clock, frameworkPtr->GetTargetFrameRate());
+    FrameStatsReporter statsReporter(clock);
+
+    // the simulation runs on the same clock as the pacing.
+    frameworkPtr->SetClock(clock);
+
+    if (frameworkPtr->IsBenchmark())
+    {
+        // measure the frames as they come, without pacing them.
+        pacer.SetTargetFrameRate(0);
+        frameworkPtr->StartBenchmark();
+    }
+
+    bool benchmarkComplete = false;
+    auto runFrame = [frameworkPtr, &pacer, &statsReporter, &benchmarkComplete]()
+    {
+        if (benchmarkComplete)
+        {
+            // the window is closing, nothing left to measure: no more frames until WM_CLOSE stops this loop.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return;
+        }
+
+        pacer.WaitForNextFrame();
+        frameworkPtr->RunFrame();
+        statsReporter.Update(pacer);
+
+        if (frameworkPtr->GetBenchmark().IsComplete())
+        {
+            // WM_CLOSE stops the render thread and waits for the GPU before the window is destroyed, the same way
+            // as closing the window by hand.
+            benchmarkComplete = true;
+            ::PostMessage(GetHwnd(), WM_CLOSE, 0, 0);
+        }
+    };
+
     MSG msg = {};
-    while (msg.message != WM_QUIT)
+
+    if (m_useRenderThread)
     {
-        // Process any messages in the queue.
-        if (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        // Update()/Render() run on the render thread, this one only pumps messages and forwards the window events.
+        RenderThread::Callbacks callbacks;
+        callbacks.onEvent = [frameworkPtr](const WindowEvent& event)
+        {
+            frameworkPtr->FlushFrames(); // the simulation of the next frame may still be running
+            switch (event.type)
+            {
+            case WindowEvent::Type::KeyDown: frameworkPtr->KeyDown(event.key); break;
+            case WindowEvent::Type::KeyUp:   frameworkPtr->KeyUp(event.key); break;
+            default: break;
+            }
+        };
+        callbacks.onResize = [frameworkPtr](uint32_t width, uint32_t height)
+        {
+            frameworkPtr->FlushFrames();
+            frameworkPtr->Resize(width, height);
+        };
+        callbacks.onFrame = runFrame;
+        callbacks.onExit = []() { ::PostMessage(GetHwnd(), WM_CLOSE, 0, 0); };
+
+        m_renderThread.Start(std::move(callbacks));
+
+        // Nothing to do on this thread between messages, block until the next one.
+        while (::GetMessage(&msg, NULL, 0, 0) > 0)
         {
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
         }
+
+        // already stopped when the window was closed.
+        StopRenderThread();
+        if (m_renderThreadError)
+        {
+            std::rethrow_exception(m_renderThreadError);
+        }
     }
+    else
+    {
+        // Main sample loop.
+        while (msg.message != WM_QUIT)
+        {
+            // Process every message in the queue once per frame, then render the next one.
+            while (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+            {
+                if (msg.message == WM_QUIT)
+                {
+                    break;
+                }
+
+                ::TranslateMessage(&msg);
+                ::DispatchMessage(&msg);
+            }
 
+            if (msg.message != WM_QUIT)
+            {
+                runFrame();
+            }
+        }
+    }
+
+    frameworkPtr->FlushFrames();
     frameworkPtr->Release();
 
+    ReportBenchmark(frameworkPtr);
+    SaveProfilerTrace(frameworkPtr);
+
     // Return this part of the WM_QUIT message to Windows.
     return static_cast<char>(msg.wParam);
 }
 
+int Win32Application::RunHeadless(Framework* frameworkPtr)
+{
+    // no window, no swap chain, no pacing: the frames render offscreen back to back.
+    frameworkPtr->Init();
+
+    Clock_Win32 clock;
+    frameworkPtr->SetClock(clock);
+
+    uint64_t frameCount = frameworkPtr->GetHeadlessFrameCount();
+    if (frameworkPtr->IsBenchmark())
+    {
+        frameworkPtr->StartBenchmark();
+        const auto& settings = frameworkPtr->GetBenchmark().GetSettings();
+        frameCount = static_cast<uint64_t>(settings.warmupFrames) + settings.measuredFrames;
+    }
+
+    HeadlessRunner runner(clock);
+    const auto report = runner.Run(frameCount, [frameworkPtr]() { frameworkPtr->RunFrame(); });
+
+    frameworkPtr->FlushFrames();
+    frameworkPtr->Release();
+
+    LOG("Headless: %llu frames at %ux%u in %.3f s, %.1f frames/s, frame %.3f ms avg, %.3f ms p50, %.3f ms p95, %.3f ms p99, %.3f ms max\n",
+        static_cast<unsigned long long>(report.frames), frameworkPtr->GetWidth(), frameworkPtr->GetHeight(), report.seconds,
+        report.framesPerSecond, report.frameMs.average, report.frameMs.p50, report.frameMs.p95, report.frameMs.p99, report.frameMs.max);
+
+    ReportBenchmark(frameworkPtr);
+    SaveProfilerTrace(frameworkPtr);
+    return 0;
+}
+
+void Win32Application::ReportBenchmark(Framework* frameworkPtr)
+{
+    const FrameBenchmark& benchmark = frameworkPtr->GetBenchmark();
+    if (!benchmark.IsEnabled())
+    {
+        return;
+    }
+
+    FrameBenchmark::Configuration configuration;
+    configuration.width = frameworkPtr->GetWidth();
+    configuration.height = frameworkPtr->GetHeight();
+    configuration.bufferCount = frameworkPtr->GetBackBufferCount();
+    configuration.vSync = frameworkPtr->IsVSync();
+    configuration.headless = frameworkPtr->IsHeadless();
+
+    // the GPU times of the last frames are read back by Release(), the report is taken after it.
+    const auto report = benchmark.GetReport(configuration);
+    LOG("Benchmark: %llu frames after %u warmup frames at %ux%u, %u buffers, vsync %s, %.3f s, %.1f frames/s\n",
+        static_cast<unsigned long long>(report.frames), report.settings.warmupFrames, configuration.width, configuration.height,
+        configuration.bufferCount, configuration.vSync ? "on" : "off", report.seconds, report.framesPerSecond);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(FrameBenchmark::Metric::Count); ++i)
+    {
+        const RollingStatistics::Summary& summary = report.milliseconds[i];
+        LOG("  %-12s %.3f ms avg, %.3f ms p50, %.3f ms p95, %.3f ms p99, %.3f ms max\n", FrameBenchmark::GetMetricName(static_cast<FrameBenchmark::Metric>(i)),
+            summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+    }
+
+    if (!FrameBenchmark::SaveJson(report.settings.reportFile, report))
+    {
+        LOG("Benchmark: failed to write %s\n", report.settings.reportFile.c_str());
+    }
+}
+
+void Win32Application::SaveProfilerTrace(Framework* frameworkPtr)
+{
+    if (frameworkPtr->GetTraceFile().empty())
+    {
+        return;
+    }
+
+    if (!Profiler::Get().SaveChromeTrace(frameworkPtr->GetTraceFile()))
+    {
+        LOG("Profiler: failed to write %s\n", frameworkPtr->GetTraceFile().c_str());
+    }
+}
+
+void Win32Application::StopRenderThread()
+{
+    // an exception can't go through the window procedure, it is rethrown once the message loop is done.
+    try
+    {
+        m_renderThread.Stop();
+    }
+    catch (...)
+    {
+        m_renderThreadError = std::current_exception();
+    }
+}
+
 void Win32Application::SetCustomWindowText(LPCWSTR text)
 {
     std::wstring windowText = m_title + L": " + text;
@@ -200,11 +453,9 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
         }
         return 0;
     case WM_PAINT:
-        if (frameworkPtr && frameworkPtr->HasInitialized())
-        {
-            frameworkPtr->Update();
-            frameworkPtr->Render();
-        }
+        // frames are only rendered by the paced loop (or the render thread), which presents continuously. The window
+        // must be validated either way, Windows keeps sending WM_PAINT until it is and the message loop never drains.
+        ::ValidateRect(hWnd, nullptr);
         return 0;
     case WM_SIZE:
         {
@@ -216,7 +467,15 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
                 const auto width = clientRect.right - clientRect.left;
                 const auto height = clientRect.bottom - clientRect.top;
 
-                frameworkPtr->Resize(width, height);
+                if (m_renderThread.IsRunning())
+                {
+                    m_renderThread.Post(WindowEvent::Resize(static_cast<uint32_t>(width), static_cast<uint32_t>(height)));
+                }
+                else
+                {
+                    frameworkPtr->FlushFrames();
+                    frameworkPtr->Resize(width, height);
+                }
             }
         }
         return 0;
@@ -244,14 +503,30 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
 
             if (frameworkPtr && propagateKeyPress)
             {
-                frameworkPtr->KeyDown(static_cast<UINT8>(wParam));
+                if (m_renderThread.IsRunning())
+                {
+                    m_renderThread.Post(WindowEvent::KeyDown(static_cast<UINT8>(wParam)));
+                }
+                else
+                {
+                    frameworkPtr->FlushFrames();
+                    frameworkPtr->KeyDown(static_cast<UINT8>(wParam));
+                }
             }
         }
         return 0;
     case WM_KEYUP:
         if (frameworkPtr)
         {
-            frameworkPtr->KeyUp(static_cast<UINT8>(wParam));
+            if (m_renderThread.IsRunning())
+            {
+                m_renderThread.Post(WindowEvent::KeyUp(static_cast<UINT8>(wParam)));
+            }
+            else
+            {
+                frameworkPtr->FlushFrames();
+                frameworkPtr->KeyUp(static_cast<UINT8>(wParam));
+            }
         }
         return 0;
     case WM_SYSCHAR:
@@ -260,6 +535,19 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
             // Alt+Enter keyboard combination if this message is not handled.
         }
         return 0;
+    case WM_CLOSE:
+        {
+            // the render thread may be presenting to this window: stop it and let the GPU finish with the swap chain
+            // before the window goes away.
+            StopRenderThread();
+            if (frameworkPtr && frameworkPtr->HasInitialized())
+            {
+                frameworkPtr->FlushFrames();
+                frameworkPtr->WaitForGpu();
+            }
+            ::DestroyWindow(hWnd);
+        }
+        return 0;
     case WM_DESTROY:
         {
             PostQuitMessage(0);
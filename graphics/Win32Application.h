@@ -12,6 +12,7 @@
 #pragma once
 
 #include "Framework.h"
+#include "core/RenderThread.h"
 
 class Win32Application
 {
@@ -26,7 +27,11 @@ protected:
     static HWND CreateWindow(const wchar_t* windowClassName, HINSTANCE hInst, const wchar_t* windowTitle, uint32_t width, uint32_t height, void* param);
 
     static LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+    static int RunHeadless(Framework* frameworkPtr); // offscreen frames back to back, no window
+    static void SaveProfilerTrace(Framework* frameworkPtr);
+    static void ReportBenchmark(Framework* frameworkPtr); // prints the benchmark report and writes it as JSON
     static void SetFullScreen(bool goFullScreen);
+    static void StopRenderThread(); // joins the render thread, keeps what stopped it for Run() to rethrow
 
 private:
     static HWND m_hwnd;
@@ -36,4 +41,8 @@ private:
     static bool m_useFullScreen;
 
     static Framework* m_framework;
+
+    static RenderThread m_renderThread; // runs Update()/Render(), window events are forwarded to it
+    static bool m_useRenderThread;
+    static std::exception_ptr m_renderThreadError;
 };
@@ -0,0 +1,194 @@
+#pragma once
+
+// Stable descriptor indices for a bindless table: shaders index one large descriptor heap with the integer they get in
+// root constants, so a resource keeps the same index for its whole lifetime. A handle is the index and the generation
+// of its slot, freeing bumps the generation right away so a stale handle is recognized, but the slot itself is only
+// handed out again once the frame that may still read it has completed on the timeline. A slot freed while a frame is
+// recorded waits for the end of frame signal passed to EndFrame(), not for the next value signaled: the frame may
+// signal the queue more than once. Allocating, freeing and retiring are O(1) per slot.
+//
+// Thread safe.
+//
+// Platform independent.
+
+#include "FenceTimeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class BindlessIndexAllocator
+{
+public:
+    static const uint32_t InvalidIndex = ~0u;
+
+    struct Handle
+    {
+        uint32_t index { InvalidIndex };
+        uint32_t generation { 0 };
+
+        bool IsValid() const { return index != InvalidIndex; }
+    };
+
+    struct Stats
+    {
+        uint32_t capacity { 0 };
+        uint32_t allocated { 0 };
+        uint32_t pendingFree { 0 };        // freed, waiting for the GPU
+        uint32_t highWater { 0 };          // largest allocated + pendingFree seen
+        uint64_t failedAllocations { 0 };  // table full
+    };
+
+    // timeline is the one of the queue reading the table.
+    BindlessIndexAllocator(FenceTimeline& timeline, uint32_t capacity)
+        : m_timeline(timeline)
+        , m_generations(capacity, 0)
+        , m_capacity(capacity)
+    {
+    }
+
+    BindlessIndexAllocator(const BindlessIndexAllocator&) = delete;
+    BindlessIndexAllocator& operator=(const BindlessIndexAllocator&) = delete;
+
+    // Invalid handle when every slot is in use or waiting for the GPU, after retiring what has completed.
+    Handle Allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty() && m_next == m_capacity)
+        {
+            RetireLocked();
+        }
+
+        Handle handle;
+        if (!m_free.empty())
+        {
+            handle.index = m_free.back();
+            m_free.pop_back();
+        }
+        else if (m_next < m_capacity)
+        {
+            handle.index = m_next++;
+        }
+        else
+        {
+            ++m_failedAllocations;
+            return handle;
+        }
+
+        handle.generation = m_generations[handle.index];
+        ++m_allocated;
+        m_highWater = std::max(m_highWater, m_allocated + static_cast<uint32_t>(m_pending.size() + m_frameFrees.size()));
+        return handle;
+    }
+
+    // The slot may still be read by the frame being recorded: it is reused once the timeline reaches the value passed to
+    // the next EndFrame(). The handle is invalid from now on.
+    void Free(Handle handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ReleaseLocked(handle))
+        {
+            m_frameFrees.push_back(handle.index);
+        }
+    }
+
+    // Same, the last use is covered by fenceValue.
+    void Free(Handle handle, uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ReleaseLocked(handle))
+        {
+            m_pending.push_back(Pending{ handle.index, fenceValue });
+        }
+    }
+
+    // The frame has been submitted, fenceValue is its end of frame signal: the slots it freed wait for it.
+    void EndFrame(uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t index : m_frameFrees)
+        {
+            m_pending.push_back(Pending{ index, fenceValue });
+        }
+        m_frameFrees.clear();
+    }
+
+    // Make the slots the GPU is done with available again. Only polls the timeline.
+    void RetireCompleted()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RetireLocked();
+    }
+
+    // The handle refers to the slot's current resource.
+    bool IsValid(Handle handle) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return IsValidLocked(handle);
+    }
+
+    uint32_t GetCapacity() const { return m_capacity; }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats;
+        stats.capacity = m_capacity;
+        stats.allocated = m_allocated;
+        stats.pendingFree = static_cast<uint32_t>(m_pending.size() + m_frameFrees.size());
+        stats.highWater = m_highWater;
+        stats.failedAllocations = m_failedAllocations;
+        return stats;
+    }
+
+private:
+    struct Pending
+    {
+        uint32_t index;
+        uint64_t fenceValue;
+    };
+
+    bool IsValidLocked(Handle handle) const
+    {
+        return handle.index < m_capacity && m_generations[handle.index] == handle.generation;
+    }
+
+    bool ReleaseLocked(Handle handle)
+    {
+        assert(IsValidLocked(handle) && "freeing a stale handle");
+        if (!IsValidLocked(handle))
+        {
+            return false;
+        }
+
+        ++m_generations[handle.index];
+        --m_allocated;
+        return true;
+    }
+
+    // Pending slots are in fence order as long as they are freed with the values the caller just signaled (or the next one).
+    void RetireLocked()
+    {
+        while (!m_pending.empty() && m_timeline.IsComplete(m_pending.front().fenceValue))
+        {
+            m_free.push_back(m_pending.front().index);
+            m_pending.pop_front();
+        }
+    }
+
+    FenceTimeline& m_timeline;
+
+    mutable std::mutex m_mutex;
+    std::vector<uint32_t> m_generations; // by slot, bumped when the slot is freed
+    std::vector<uint32_t> m_free;        // slots ready for reuse
+    std::deque<Pending> m_pending;       // freed slots waiting for their fence value, in fence order
+    std::vector<uint32_t> m_frameFrees;  // freed during the frame being recorded, waiting for EndFrame()
+    const uint32_t m_capacity;
+    uint32_t m_next { 0 };               // slots never used start here
+    uint32_t m_allocated { 0 };
+    uint32_t m_highWater { 0 };
+    uint64_t m_failedAllocations { 0 };
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+// Binary blobs by key, with a file to keep them from one run to the next (serialized root signatures, the key being
+// the RootSignatureKey words). The file is a cache: a missing, truncated or foreign file loads as empty and the blobs
+// are built again.
+//
+// File: magic, version, entry count, then for each entry the key size in words, the key, the blob size in bytes and
+// the blob.
+//
+// Platform independent.
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class BlobCache
+{
+public:
+    typedef std::vector<uint32_t> Key;
+    typedef std::vector<uint8_t> Blob;
+
+    static const uint32_t Magic = 0x42534742; // "BGSB"
+    static const uint32_t Version = 1;
+    // Anything bigger in a file is taken for corruption.
+    static const uint32_t MaxKeyWords = 1u << 20;
+    static const uint32_t MaxBlobSize = 1u << 26;
+
+    const Blob* Find(const Key& key) const
+    {
+        auto found = m_blobs.find(key);
+        return found != m_blobs.end() ? &found->second : nullptr;
+    }
+
+    void Insert(const Key& key, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        Blob& blob = m_blobs[key];
+        blob.assign(bytes, bytes + size);
+        m_dirty = true;
+    }
+
+    size_t GetCount() const { return m_blobs.size(); }
+    bool IsDirty() const { return m_dirty; }
+
+    // Replace the content with the file's, false (and empty) when it can't be read.
+    bool Load(const std::string& path)
+    {
+        m_blobs.clear();
+        m_dirty = false;
+
+        std::ifstream file(path, std::ios::binary);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t count = 0;
+        if (!Read(file, magic) || !Read(file, version) || !Read(file, count) || magic != Magic || version != Version)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t keyWords = 0;
+            uint32_t blobSize = 0;
+            Key key;
+            Blob blob;
+            if (!Read(file, keyWords) || keyWords > MaxKeyWords)
+            {
+                m_blobs.clear();
+                return false;
+            }
+            key.resize(keyWords);
+            if (!ReadBytes(file, key.data(), keyWords * sizeof(uint32_t)) || !Read(file, blobSize) || blobSize > MaxBlobSize)
+            {
+                m_blobs.clear();
+                return false;
+            }
+            blob.resize(blobSize);
+            if (!ReadBytes(file, blob.data(), blobSize))
+            {
+                m_blobs.clear();
+                return false;
+            }
+            m_blobs[std::move(key)] = std::move(blob);
+        }
+        return true;
+    }
+
+    bool Save(const std::string& path)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        Write(file, Magic);
+        Write(file, Version);
+        Write(file, static_cast<uint32_t>(m_blobs.size()));
+        for (const auto& entry : m_blobs)
+        {
+            Write(file, static_cast<uint32_t>(entry.first.size()));
+            file.write(reinterpret_cast<const char*>(entry.first.data()), entry.first.size() * sizeof(uint32_t));
+            Write(file, static_cast<uint32_t>(entry.second.size()));
+            file.write(reinterpret_cast<const char*>(entry.second.data()), entry.second.size());
+        }
+        file.flush();
+        if (!file)
+        {
+            return false;
+        }
+        m_dirty = false;
+        return true;
+    }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            // FNV-1a over the words.
+            uint64_t hash = 14695981039346656037ull;
+            for (uint32_t word : key)
+            {
+                hash ^= word;
+                hash *= 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    static bool ReadBytes(std::ifstream& file, void* data, size_t size)
+    {
+        if (size == 0)
+        {
+            return true;
+        }
+        file.read(static_cast<char*>(data), size);
+        return static_cast<size_t>(file.gcount()) == size;
+    }
+
+    static bool Read(std::ifstream& file, uint32_t& value) { return ReadBytes(file, &value, sizeof(value)); }
+
+    static void Write(std::ofstream& file, uint32_t value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    std::unordered_map<Key, Blob, KeyHash> m_blobs;
+    bool m_dirty { false };
+};
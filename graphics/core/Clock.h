@@ -0,0 +1,89 @@
+#pragma once
+
+// Time source used by the frame loop. Everything that paces or schedules frames goes through a Clock so it can run
+// against the real time (SteadyClock, or the waitable timer clock on windows) or a fully deterministic SimulatedClock.
+//
+// Platform independent.
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+class Clock
+{
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    virtual ~Clock() {}
+
+    // Monotonic time since an arbitrary epoch.
+    virtual Duration Now() const = 0;
+
+    // Coarse sleep, may overshoot by up to the scheduler granularity.
+    virtual void Sleep(Duration duration) = 0;
+
+    // Called on every iteration of a busy wait, a cpu pause or a yield.
+    virtual void Relax() {}
+};
+
+// std::chrono::steady_clock and std::this_thread::sleep_for, the precision depends on the platform's scheduler.
+class SteadyClock : public Clock
+{
+public:
+    virtual Duration Now() const override
+    {
+        return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now().time_since_epoch());
+    }
+
+    virtual void Sleep(Duration duration) override
+    {
+        std::this_thread::sleep_for(duration);
+    }
+
+    virtual void Relax() override
+    {
+        std::this_thread::yield();
+    }
+};
+
+// Manually driven clock. Time only moves when something sleeps, relaxes or calls Advance(), which makes the pacing and
+// scheduling logic reproducible.
+class SimulatedClock : public Clock
+{
+public:
+    virtual Duration Now() const override { return m_now; }
+
+    virtual void Sleep(Duration duration) override
+    {
+        if (duration > Duration::zero())
+        {
+            m_now += duration + m_oversleep;
+        }
+        ++m_sleepCount;
+    }
+
+    virtual void Relax() override
+    {
+        m_now += m_relaxStep;
+        ++m_relaxCount;
+    }
+
+    // Simulate work (or the passing of time) between two calls.
+    void Advance(Duration duration) { m_now += duration; }
+
+    // Every Sleep() overshoots by oversleep, like a real scheduler waking up late.
+    void SetOversleep(Duration oversleep) { m_oversleep = oversleep; }
+
+    // Time spent in one busy wait iteration.
+    void SetRelaxStep(Duration step) { m_relaxStep = step; }
+
+    uint64_t GetSleepCount() const { return m_sleepCount; }
+    uint64_t GetRelaxCount() const { return m_relaxCount; }
+
+private:
+    Duration m_now { 0 };
+    Duration m_oversleep { 0 };
+    Duration m_relaxStep { std::chrono::microseconds(1) };
+    uint64_t m_sleepCount { 0 };
+    uint64_t m_relaxCount { 0 };
+};
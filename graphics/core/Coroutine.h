@@ -0,0 +1,75 @@
+#pragma once
+
+// Coroutine support shared by the async code, on the standard C++20 coroutines. AsyncTask is the coroutine type async
+// code returns.
+//
+// Platform independent.
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+// Eagerly started coroutine with no result, typically a piece of loading or readback code written as straight-line code
+// with co_await on GPU work in between. The task runs until its first suspension when called; the handle only observes
+// it, dropping the handle doesn't cancel anything.
+class AsyncTask
+{
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done { false };
+        std::exception_ptr error;
+
+        void Finish(std::exception_ptr exception)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = exception;
+                done = true;
+            }
+            condition.notify_all();
+        }
+    };
+
+public:
+    struct promise_type
+    {
+        std::shared_ptr<State> state { std::make_shared<State>() };
+
+        AsyncTask get_return_object() { return AsyncTask(state); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; } // the frame destroys itself, the state outlives it
+        void return_void() { state->Finish(nullptr); }
+        void unhandled_exception() { state->Finish(std::current_exception()); }
+    };
+
+    AsyncTask() = default;
+
+    bool IsValid() const { return m_state != nullptr; }
+
+    bool IsDone() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->done;
+    }
+
+    // Block the calling thread until the task has finished, rethrows what escaped the coroutine if anything.
+    // Meant for tools and shutdown, async code should co_await instead of blocking a thread.
+    void Wait() const
+    {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->condition.wait(lock, [this]() { return m_state->done; });
+        if (m_state->error)
+        {
+            std::rethrow_exception(m_state->error);
+        }
+    }
+
+private:
+    explicit AsyncTask(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+    std::shared_ptr<State> m_state;
+};
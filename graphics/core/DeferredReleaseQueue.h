@@ -0,0 +1,178 @@
+#pragma once
+
+// Deferred destruction of objects the GPU may still be using. An object is retired together with the sync point of its
+// last use and actually released in bulk once the timeline of that queue has passed it, instead of draining the whole
+// queue before every release.
+//
+// Objects used by the frame being recorded don't know their sync point yet: the frame may signal its queue more than
+// once before its own end of frame signal. They are retired with the frame and get its sync point at EndFrame().
+//
+// Platform independent: Object is anything movable whose destruction releases the underlying resource
+// (ComPtr<IUnknown> in the renderer).
+
+#include "FenceTimeline.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+template <class Object>
+class DeferredReleaseQueue
+{
+public:
+    struct Stats
+    {
+        uint64_t pendingObjects { 0 };
+        uint64_t pendingBytes { 0 };
+        uint64_t releasedObjects { 0 };
+        uint64_t releasedBytes { 0 };
+    };
+
+    DeferredReleaseQueue() = default;
+    DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+    DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+
+    ~DeferredReleaseQueue()
+    {
+        // whoever owns the queue must have waited for the GPU before tearing it down.
+        ReleaseAll();
+    }
+
+    // Keep object alive until lastUse has been reached. byteSize is only used for the statistics.
+    // Thread safe, any thread can retire objects.
+    void Retire(Object&& object, const SyncPoint& lastUse, uint64_t byteSize = 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Each queue is kept in retire order, which is also fence order as long as the callers retire with the values
+        // they just signaled. An entry retired with an older value behind a newer one is released late but never early.
+        m_pending[static_cast<uint32_t>(lastUse.queue)].push_back(Entry{ std::move(object), lastUse.value, byteSize });
+
+        ++m_stats.pendingObjects;
+        m_stats.pendingBytes += byteSize;
+    }
+
+    // Keep object alive until the frame being recorded has completed, the sync point is the one passed to the next
+    // EndFrame(). Thread safe.
+    void RetireWithFrame(Object&& object, uint64_t byteSize = 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frame.push_back(Entry{ std::move(object), 0, byteSize });
+
+        ++m_stats.pendingObjects;
+        m_stats.pendingBytes += byteSize;
+    }
+
+    // The frame has been submitted, frameEnd is its last signal: what it retired waits for it.
+    void EndFrame(const SyncPoint& frameEnd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& pending = m_pending[static_cast<uint32_t>(frameEnd.queue)];
+        for (auto& entry : m_frame)
+        {
+            entry.fenceValue = frameEnd.value;
+            pending.push_back(std::move(entry));
+        }
+        m_frame.clear();
+    }
+
+    // Release every object whose sync point has been reached. Only polls the timelines (never blocks), returns
+    // the number of released objects.
+    size_t Collect(QueueTimelines& timelines)
+    {
+        std::vector<Entry> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (uint32_t queue = 0; queue < static_cast<uint32_t>(QueueType::Count); ++queue)
+            {
+                auto& pending = m_pending[queue];
+                if (pending.empty())
+                {
+                    continue;
+                }
+
+                FenceTimeline& timeline = timelines[static_cast<QueueType>(queue)];
+                if (!timeline.IsBound())
+                {
+                    continue;
+                }
+
+                // a single poll of the fence for the newest candidate, the rest is answered by the cached value. The
+                // front can be newer than the back when it was retired out of order, it is the one releases wait on.
+                timeline.IsComplete(std::max(pending.front().fenceValue, pending.back().fenceValue));
+                const uint64_t completedValue = timeline.GetCachedCompletedValue();
+
+                while (!pending.empty() && pending.front().fenceValue <= completedValue)
+                {
+                    ready.push_back(std::move(pending.front()));
+                    pending.pop_front();
+                }
+            }
+
+            AccountReleased(ready);
+        }
+
+        // objects are destroyed outside the lock, releasing a d3d12 object isn't free.
+        return ready.size();
+    }
+
+    // Release everything right away. Only valid once the GPU is idle (after QueueTimelines::WaitIdle()).
+    size_t ReleaseAll()
+    {
+        std::vector<Entry> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (auto& pending : m_pending)
+            {
+                for (auto& entry : pending)
+                {
+                    ready.push_back(std::move(entry));
+                }
+                pending.clear();
+            }
+            for (auto& entry : m_frame)
+            {
+                ready.push_back(std::move(entry));
+            }
+            m_frame.clear();
+
+            AccountReleased(ready);
+        }
+        return ready.size();
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct Entry
+    {
+        Object object;
+        uint64_t fenceValue;
+        uint64_t byteSize;
+    };
+
+    void AccountReleased(const std::vector<Entry>& released)
+    {
+        for (const auto& entry : released)
+        {
+            --m_stats.pendingObjects;
+            m_stats.pendingBytes -= entry.byteSize;
+            ++m_stats.releasedObjects;
+            m_stats.releasedBytes += entry.byteSize;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_pending[static_cast<uint32_t>(QueueType::Count)];
+    std::vector<Entry> m_frame; // retired with the frame being recorded, no sync point yet
+    Stats m_stats;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+// Abstract device layer: the subset of a D3D12 style API the CPU side of the frame loop relies on (queues, command
+// allocators and lists, fences, descriptor heaps, resources). NullDevice implements it without any GPU so the
+// allocators, the recording and the synchronization can be run and tested anywhere (FrameSubmissionModel). The renderer
+// drives D3D12 directly, Device_DX12 converts the enums for the D3D12 code built on the platform independent parts.
+//
+// Fences are FenceBackends (FenceTimeline.h), created for the queue that signals them.
+//
+// Platform independent.
+
+#include "FenceTimeline.h"
+
+#include <cstdint>
+#include <memory>
+
+enum class ResourceState : uint32_t
+{
+    Present = 0, // also the common state
+    RenderTarget,
+    CopySource,
+    CopyDest,
+    ShaderResource,
+    UnorderedAccess,
+    GenericRead, // upload heaps
+    DepthWrite,
+    DepthRead,
+};
+
+enum class Format : uint32_t
+{
+    Unknown = 0,
+    RGBA8Unorm,
+    BGRA8Unorm,
+    R32Float,
+    D32Float,
+};
+
+enum class HeapKind : uint32_t
+{
+    Default = 0, // GPU memory
+    Upload,      // CPU writes, GPU reads
+    Readback,    // GPU writes, CPU reads
+};
+
+struct ResourceDesc
+{
+    enum class Dimension : uint32_t
+    {
+        Buffer,
+        Texture2D,
+    };
+
+    Dimension dimension { Dimension::Buffer };
+    uint64_t width { 0 }; // bytes for buffers
+    uint32_t height { 1 };
+    Format format { Format::Unknown };
+    HeapKind heap { HeapKind::Default };
+    bool renderTarget { false };
+
+    static ResourceDesc Buffer(uint64_t size, HeapKind heap = HeapKind::Default)
+    {
+        ResourceDesc desc;
+        desc.width = size;
+        desc.heap = heap;
+        return desc;
+    }
+
+    static ResourceDesc RenderTarget(uint32_t width, uint32_t height, Format format)
+    {
+        ResourceDesc desc;
+        desc.dimension = Dimension::Texture2D;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        desc.renderTarget = true;
+        return desc;
+    }
+};
+
+enum class DescriptorHeapType : uint32_t
+{
+    RenderTarget = 0,
+    DepthStencil,
+    ShaderResource, // CBV, SRV and UAV
+    Sampler,
+};
+
+struct DescriptorHandle
+{
+    uint64_t cpu { 0 };
+    uint64_t gpu { 0 }; // 0 unless the heap is shader visible
+};
+
+class GpuResource
+{
+public:
+    virtual ~GpuResource() {}
+
+    virtual const ResourceDesc& GetDesc() const = 0;
+
+    // Upload and readback buffers only. The pointer stays valid until Unmap().
+    virtual void* Map() = 0;
+    virtual void Unmap() = 0;
+};
+
+class GpuDescriptorHeap
+{
+public:
+    virtual ~GpuDescriptorHeap() {}
+
+    virtual DescriptorHeapType GetType() const = 0;
+    virtual uint32_t GetCapacity() const = 0;
+    virtual bool IsShaderVisible() const = 0;
+    virtual DescriptorHandle GetHandle(uint32_t index) const = 0;
+};
+
+class GpuCommandAllocator
+{
+public:
+    virtual ~GpuCommandAllocator() {}
+
+    // Only once the GPU has finished every list recorded with it.
+    virtual void Reset() = 0;
+};
+
+class GpuCommandList
+{
+public:
+    virtual ~GpuCommandList() {}
+
+    virtual QueueType GetType() const = 0;
+
+    virtual void Reset(GpuCommandAllocator& allocator) = 0;
+    virtual void Close() = 0;
+
+    virtual void ResourceBarrier(GpuResource& resource, ResourceState before, ResourceState after) = 0;
+    virtual void ClearRenderTarget(const DescriptorHandle& renderTarget, const float color[4]) = 0;
+    virtual void CopyBufferRegion(GpuResource& destination, uint64_t destinationOffset, GpuResource& source, uint64_t sourceOffset, uint64_t size) = 0;
+    virtual void Draw(uint32_t vertexCount, uint32_t instanceCount) = 0;
+};
+
+class GpuCommandQueue
+{
+public:
+    virtual ~GpuCommandQueue() {}
+
+    virtual QueueType GetType() const = 0;
+    virtual void ExecuteCommandLists(uint32_t count, GpuCommandList* const* commandLists) = 0;
+
+    // The work submitted after this call waits on the GPU until fence has reached value.
+    virtual void Wait(FenceBackend& fence, uint64_t value) = 0;
+};
+
+class GpuDevice
+{
+public:
+    virtual ~GpuDevice() {}
+
+    virtual std::unique_ptr<GpuCommandQueue> CreateCommandQueue(QueueType type) = 0;
+    // Fence signaled by queue only.
+    virtual std::unique_ptr<FenceBackend> CreateFence(GpuCommandQueue& queue, uint64_t initialValue = 0) = 0;
+    virtual std::unique_ptr<GpuCommandAllocator> CreateCommandAllocator(QueueType type) = 0;
+    // Created open, recording with allocator.
+    virtual std::unique_ptr<GpuCommandList> CreateCommandList(QueueType type, GpuCommandAllocator& allocator) = 0;
+    virtual std::unique_ptr<GpuDescriptorHeap> CreateDescriptorHeap(DescriptorHeapType type, uint32_t capacity, bool shaderVisible) = 0;
+    virtual std::unique_ptr<GpuResource> CreateResource(const ResourceDesc& desc, ResourceState initialState) = 0;
+
+    virtual void CreateRenderTargetView(GpuResource& resource, const DescriptorHandle& handle) = 0;
+};
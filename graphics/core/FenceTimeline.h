@@ -0,0 +1,268 @@
+#pragma once
+
+// Platform independent fence timeline. Doesn't include any windows or d3d12 header so the synchronization logic can be
+// built and exercised without a GPU (see SoftwareFence).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Each GPU queue owns exactly one fence and is the only one signaling it, any thread or queue can wait on it.
+enum class QueueType : uint32_t
+{
+    Direct = 0,
+    Compute,
+    Copy,
+    Count
+};
+
+// A point on the timeline of a queue. All the work submitted to the queue before the signal of value is complete
+// once the fence of the queue has reached value.
+struct SyncPoint
+{
+    QueueType queue { QueueType::Direct };
+    uint64_t value { 0 };
+};
+
+// The actual fence behind a timeline: ID3D12Fence in the renderer (see Fence_DX12), SoftwareFence everywhere else.
+class FenceBackend
+{
+public:
+    virtual ~FenceBackend() {}
+
+    // Enqueue a signal of value, the fence reaches it once all the work submitted before is complete.
+    virtual void Signal(uint64_t value) = 0;
+
+    // Query the last value the fence has reached. Can be expensive, with d3d12 it is a round trip through the driver.
+    virtual uint64_t GetCompletedValue() const = 0;
+
+    // Block the calling thread until the fence has reached value or timeout has elapsed, return true if value was reached.
+    // Must be safe to call from several threads at once, possibly for different values.
+    virtual bool Wait(uint64_t value, std::chrono::milliseconds timeout) = 0;
+};
+
+// CPU only fence. Signal() only records the value, the "GPU" progress is simulated by calling Complete() (or by
+// enabling auto completion, in which case a signal is complete as soon as it is issued).
+class SoftwareFence : public FenceBackend
+{
+public:
+    explicit SoftwareFence(bool autoComplete = false)
+        : m_autoComplete(autoComplete)
+    {
+    }
+
+    virtual void Signal(uint64_t value) override
+    {
+        AtomicMax(m_lastSignaledValue, value);
+        if (m_autoComplete)
+        {
+            Complete(value);
+        }
+    }
+
+    virtual uint64_t GetCompletedValue() const override
+    {
+        m_completedValueQueries.fetch_add(1, std::memory_order_relaxed);
+        return m_completedValue.load(std::memory_order_acquire);
+    }
+
+    virtual bool Wait(uint64_t value, std::chrono::milliseconds timeout) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto reached = [this, value]() { return m_completedValue.load(std::memory_order_acquire) >= value; };
+
+        if (timeout == std::chrono::milliseconds::max())
+        {
+            m_condition.wait(lock, reached);
+            return true;
+        }
+        return m_condition.wait_for(lock, timeout, reached);
+    }
+
+    // Simulate the GPU reaching value, wakes up every waiter whose value is now reached. Values never go backwards.
+    void Complete(uint64_t value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            AtomicMax(m_completedValue, value);
+        }
+        m_condition.notify_all();
+    }
+
+    // Complete everything that has been signaled so far.
+    void CompleteAll() { Complete(GetLastSignaledValue()); }
+
+    uint64_t GetLastSignaledValue() const { return m_lastSignaledValue.load(std::memory_order_acquire); }
+
+    // Number of GetCompletedValue() calls, lets the callers check how often the timeline actually hits the fence.
+    uint64_t GetCompletedValueQueryCount() const { return m_completedValueQueries.load(std::memory_order_relaxed); }
+
+    static void AtomicMax(std::atomic<uint64_t>& target, uint64_t value)
+    {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_acq_rel))
+        {
+        }
+    }
+
+private:
+    std::atomic<uint64_t> m_lastSignaledValue { 0 };
+    std::atomic<uint64_t> m_completedValue { 0 };
+    mutable std::atomic<uint64_t> m_completedValueQueries { 0 };
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    bool m_autoComplete { false };
+};
+
+// Timeline of a single queue: hands out monotonically increasing fence values and answers "is this value done yet".
+// The last completed value is cached, IsComplete() only goes to the fence when the cache says the value isn't reached,
+// and a blocking Wait() is only issued when the fence itself says it isn't reached either.
+//
+// Signal() must be called from one thread only (the one submitting to the queue), everything else is thread safe.
+class FenceTimeline
+{
+public:
+    struct Stats
+    {
+        uint64_t completionPolls { 0 };   // IsComplete()/Wait() calls
+        uint64_t fenceQueries { 0 };      // calls that had to query the fence
+        uint64_t blockingWaits { 0 };     // calls that had to block on the fence
+        uint64_t blockedNanoseconds { 0 }; // total time spent blocked
+    };
+
+    FenceTimeline() = default;
+    explicit FenceTimeline(FenceBackend* backend, uint64_t initialValue = 0) { Bind(backend, initialValue); }
+
+    FenceTimeline(const FenceTimeline&) = delete;
+    FenceTimeline& operator=(const FenceTimeline&) = delete;
+
+    // initialValue must be the value the fence was created with.
+    void Bind(FenceBackend* backend, uint64_t initialValue = 0)
+    {
+        m_backend = backend;
+        m_lastSignaledValue.store(initialValue, std::memory_order_release);
+        m_completedValue.store(initialValue, std::memory_order_release);
+    }
+
+    bool IsBound() const { return m_backend != nullptr; }
+
+    // Signal the next value on the timeline and return it.
+    uint64_t Signal()
+    {
+        const uint64_t value = m_lastSignaledValue.load(std::memory_order_relaxed) + 1;
+        m_backend->Signal(value);
+        m_lastSignaledValue.store(value, std::memory_order_release);
+        return value;
+    }
+
+    // Non blocking poll, only queries the fence when the cached value is behind.
+    bool IsComplete(uint64_t value)
+    {
+        m_completionPolls.fetch_add(1, std::memory_order_relaxed);
+
+        if (value <= m_completedValue.load(std::memory_order_acquire))
+        {
+            return true;
+        }
+        return value <= RefreshCompletedValue();
+    }
+
+    // Block until value is reached. Several threads can wait on the same timeline at the same time.
+    bool Wait(uint64_t value, std::chrono::milliseconds timeout = std::chrono::milliseconds::max())
+    {
+        if (IsComplete(value))
+        {
+            return true;
+        }
+
+        m_blockingWaits.fetch_add(1, std::memory_order_relaxed);
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool reached = m_backend->Wait(value, timeout);
+        const auto blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        m_blockedNanoseconds.fetch_add(static_cast<uint64_t>(blocked.count()), std::memory_order_relaxed);
+
+        if (reached)
+        {
+            SoftwareFence::AtomicMax(m_completedValue, value);
+        }
+        return reached;
+    }
+
+    // Wait for everything signaled so far.
+    void WaitIdle() { Wait(GetLastSignaledValue()); }
+
+    // Signal a new value and wait for it: drains the queue.
+    uint64_t Flush()
+    {
+        const uint64_t value = Signal();
+        Wait(value);
+        return value;
+    }
+
+    // Query the fence and update the cache.
+    uint64_t RefreshCompletedValue()
+    {
+        m_fenceQueries.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t completedValue = m_backend->GetCompletedValue();
+        SoftwareFence::AtomicMax(m_completedValue, completedValue);
+        return m_completedValue.load(std::memory_order_acquire);
+    }
+
+    uint64_t GetCachedCompletedValue() const { return m_completedValue.load(std::memory_order_acquire); }
+    uint64_t GetLastSignaledValue() const { return m_lastSignaledValue.load(std::memory_order_acquire); }
+    FenceBackend* GetBackend() const { return m_backend; }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.completionPolls = m_completionPolls.load(std::memory_order_relaxed);
+        stats.fenceQueries = m_fenceQueries.load(std::memory_order_relaxed);
+        stats.blockingWaits = m_blockingWaits.load(std::memory_order_relaxed);
+        stats.blockedNanoseconds = m_blockedNanoseconds.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    FenceBackend* m_backend { nullptr };
+
+    std::atomic<uint64_t> m_lastSignaledValue { 0 };
+    std::atomic<uint64_t> m_completedValue { 0 }; // cached, only ever moves forward
+
+    std::atomic<uint64_t> m_completionPolls { 0 };
+    std::atomic<uint64_t> m_fenceQueries { 0 };
+    std::atomic<uint64_t> m_blockingWaits { 0 };
+    std::atomic<uint64_t> m_blockedNanoseconds { 0 };
+};
+
+// One timeline per queue type.
+class QueueTimelines
+{
+public:
+    FenceTimeline& operator[](QueueType queue) { return m_timelines[static_cast<uint32_t>(queue)]; }
+    const FenceTimeline& operator[](QueueType queue) const { return m_timelines[static_cast<uint32_t>(queue)]; }
+
+    SyncPoint Signal(QueueType queue) { return SyncPoint{ queue, (*this)[queue].Signal() }; }
+    bool IsComplete(const SyncPoint& point) { return (*this)[point.queue].IsComplete(point.value); }
+    bool Wait(const SyncPoint& point) { return (*this)[point.queue].Wait(point.value); }
+
+    // Wait for everything signaled so far on every bound queue.
+    void WaitIdle()
+    {
+        for (auto& timeline : m_timelines)
+        {
+            if (timeline.IsBound())
+            {
+                timeline.WaitIdle();
+            }
+        }
+    }
+
+private:
+    FenceTimeline m_timelines[static_cast<uint32_t>(QueueType::Count)];
+};
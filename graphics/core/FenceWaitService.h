@@ -0,0 +1,317 @@
+#pragma once
+
+// One background thread waiting on many fences at once. Callers register (timeline, value, callback); the service
+// thread blocks on all the pending fence values together through a FenceWaitMultiplexer (SetEventOnCompletion +
+// WaitForMultipleObjects in the renderer) and runs the callback once its value is reached. On top of it, co_await
+// AwaitableTimeline::Until(value) suspends a coroutine until the fence completes and resumes it on a job system worker,
+// so async code doesn't hold a thread while the GPU works. A wait still pending when the service is destroyed is cancelled:
+// the awaiting coroutine resumes with a FenceWaitCancelled exception, which unwinds its frame.
+//
+// Platform independent. PollingFenceWaitMultiplexer works with any FenceBackend, SoftwareFence included.
+
+#include "Coroutine.h"
+#include "FenceTimeline.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct FenceWait
+{
+    FenceTimeline* timeline { nullptr };
+    uint64_t value { 0 };
+};
+
+// Blocks the service thread until one of the waits may have completed.
+class FenceWaitMultiplexer
+{
+public:
+    virtual ~FenceWaitMultiplexer() {}
+
+    // Return once at least one of waits may be complete, Wake() has been called or timeout has elapsed.
+    // Spurious returns are fine, the service checks every wait again.
+    virtual void WaitAny(const std::vector<FenceWait>& waits, std::chrono::milliseconds timeout) = 0;
+
+    // Interrupt WaitAny(), callable from any thread. A wake before WaitAny() makes the next one return immediately.
+    virtual void Wake() = 0;
+};
+
+// Fallback for backends without an OS level completion event: sleeps pollInterval at a time.
+class PollingFenceWaitMultiplexer : public FenceWaitMultiplexer
+{
+public:
+    explicit PollingFenceWaitMultiplexer(std::chrono::microseconds pollInterval = std::chrono::microseconds(200))
+        : m_pollInterval(pollInterval)
+    {
+    }
+
+    virtual void WaitAny(const std::vector<FenceWait>& /*waits*/, std::chrono::milliseconds timeout) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto interval = std::min<std::chrono::microseconds>(m_pollInterval, timeout);
+        m_condition.wait_for(lock, interval, [this]() { return m_woken; });
+        m_woken = false;
+    }
+
+    virtual void Wake() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_woken = true;
+        }
+        m_condition.notify_one();
+    }
+
+private:
+    std::chrono::microseconds m_pollInterval;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_woken { false };
+};
+
+// Thrown from co_await AwaitableTimeline::Until() when the service is destroyed before the fence reaches the value.
+class FenceWaitCancelled : public std::runtime_error
+{
+public:
+    FenceWaitCancelled() : std::runtime_error("fence wait cancelled, the fence wait service was destroyed") {}
+};
+
+class FenceWaitService
+{
+public:
+    using Callback = std::function<void()>;
+
+    struct Stats
+    {
+        uint64_t registered { 0 };
+        uint64_t completed { 0 };
+        uint64_t cancelled { 0 };
+        uint64_t multiplexedWaits { 0 }; // times the service thread blocked on the multiplexer
+    };
+
+    // Coroutines are resumed on jobSystem workers if given, on the service thread otherwise. Destroying the service runs
+    // the callbacks of the waits already complete and the cancel callbacks of the others.
+    explicit FenceWaitService(FenceWaitMultiplexer& multiplexer, JobSystem* jobSystem = nullptr)
+        : m_multiplexer(multiplexer)
+        , m_jobSystem(jobSystem)
+    {
+        m_thread = std::thread([this]() { ThreadMain(); });
+    }
+
+    ~FenceWaitService()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_condition.notify_one();
+        m_multiplexer.Wake();
+        m_thread.join();
+    }
+
+    FenceWaitService(const FenceWaitService&) = delete;
+    FenceWaitService& operator=(const FenceWaitService&) = delete;
+
+    // Run callback on the service thread once timeline has reached value. If the service is destroyed first, cancel runs
+    // in its place, on the service thread too. Thread safe.
+    void Register(FenceTimeline& timeline, uint64_t value, Callback callback, Callback cancel = nullptr)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_incoming.push_back(Pending{ FenceWait{ &timeline, value }, std::move(callback), std::move(cancel) });
+            ++m_stats.registered;
+        }
+        m_condition.notify_one();
+        m_multiplexer.Wake();
+    }
+
+    // Resume a suspended coroutine, on a worker if there is a job system.
+    void Resume(std::coroutine_handle<> handle)
+    {
+        if (m_jobSystem)
+        {
+            m_jobSystem->Schedule([handle]() { handle.resume(); });
+        }
+        else
+        {
+            handle.resume();
+        }
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct Pending
+    {
+        FenceWait wait;
+        Callback callback;
+        Callback cancel;
+    };
+
+    void ThreadMain()
+    {
+        PROFILE_THREAD_NAME("Fence wait service");
+
+        std::vector<Pending> pending;
+        std::vector<FenceWait> waits;
+        std::vector<Callback> ready;
+
+        for (;;)
+        {
+            bool stopping = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (pending.empty())
+                {
+                    // nothing to wait for, sleep until something is registered.
+                    m_condition.wait(lock, [this]() { return !m_incoming.empty() || !m_running; });
+                }
+
+                for (auto& incoming : m_incoming)
+                {
+                    pending.push_back(std::move(incoming));
+                }
+                m_incoming.clear();
+                stopping = !m_running;
+            }
+
+            // the timelines' cached values answer most of these without touching the fence.
+            for (size_t i = 0; i < pending.size();)
+            {
+                if (pending[i].wait.timeline->IsComplete(pending[i].wait.value))
+                {
+                    ready.push_back(std::move(pending[i].callback));
+                    pending[i] = std::move(pending.back());
+                    pending.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+
+            const bool completedAny = !ready.empty();
+            if (completedAny)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.completed += ready.size();
+                }
+                for (auto& callback : ready)
+                {
+                    callback();
+                }
+                ready.clear();
+            }
+
+            if (stopping)
+            {
+                // the waits still pending won't complete anymore, their owners are told so.
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.cancelled += pending.size();
+                }
+                for (auto& entry : pending)
+                {
+                    if (entry.cancel)
+                    {
+                        entry.cancel();
+                    }
+                }
+                break;
+            }
+
+            if (!completedAny && !pending.empty())
+            {
+                waits.clear();
+                for (const auto& entry : pending)
+                {
+                    waits.push_back(entry.wait);
+                }
+
+                m_multiplexer.WaitAny(waits, std::chrono::milliseconds(100));
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_stats.multiplexedWaits;
+            }
+        }
+    }
+
+    FenceWaitMultiplexer& m_multiplexer;
+    JobSystem* m_jobSystem;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Pending> m_incoming;
+    bool m_running { true };
+    Stats m_stats;
+
+    std::thread m_thread;
+};
+
+// co_await timeline.Until(value): suspends until the fence has reached value, doesn't suspend at all if it already has.
+// Throws FenceWaitCancelled if the service is destroyed first.
+class AwaitableTimeline
+{
+public:
+    class Awaiter
+    {
+    public:
+        Awaiter(FenceTimeline& timeline, FenceWaitService& service, uint64_t value)
+            : m_timeline(timeline)
+            , m_service(service)
+            , m_value(value)
+        {
+        }
+
+        bool await_ready() { return m_timeline.IsComplete(m_value); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // the awaiter lives in the suspended frame, the cancel callback can flag it. The job system may be going
+            // away with the service, a cancelled coroutine resumes on the service thread.
+            FenceWaitService& service = m_service;
+            m_service.Register(m_timeline, m_value, [&service, handle]() { service.Resume(handle); },
+                [this, handle]() { m_cancelled = true; handle.resume(); });
+        }
+
+        void await_resume()
+        {
+            if (m_cancelled)
+            {
+                throw FenceWaitCancelled();
+            }
+        }
+
+    private:
+        FenceTimeline& m_timeline;
+        FenceWaitService& m_service;
+        uint64_t m_value;
+        bool m_cancelled { false };
+    };
+
+    AwaitableTimeline(FenceTimeline& timeline, FenceWaitService& service)
+        : m_timeline(&timeline)
+        , m_service(&service)
+    {
+    }
+
+    Awaiter Until(uint64_t value) const { return Awaiter(*m_timeline, *m_service, value); }
+
+    FenceTimeline& GetTimeline() const { return *m_timeline; }
+
+private:
+    FenceTimeline* m_timeline;
+    FenceWaitService* m_service;
+};
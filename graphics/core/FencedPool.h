@@ -0,0 +1,110 @@
+#pragma once
+
+// Pool of objects that can only be reused once the GPU is done with them (command allocators for instance: an allocator
+// cannot be reset while the commands recorded into it are still executing). Objects are returned together with the fence
+// value of the submission that used them and handed out again only once the timeline has passed it. When nothing is
+// ready a new object is created, so the pool grows to however many objects are really in flight (one per recording
+// thread per frame in flight).
+//
+// Platform independent: the pool only knows about FenceTimeline, creating and recycling objects is left to the caller.
+
+#include "FenceTimeline.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+template <class Object>
+class FencedPool
+{
+public:
+    using Factory = std::function<Object()>;
+    using Recycler = std::function<void(Object&)>; // called on an object about to be reused, its fence value has been reached.
+
+    struct Stats
+    {
+        uint64_t created { 0 };   // objects created so far (the size of the pool)
+        uint64_t acquired { 0 };  // Acquire() calls
+        uint64_t recycled { 0 };  // Acquire() calls served by an object returned earlier
+        uint64_t available { 0 }; // objects waiting in the pool, in flight or not
+    };
+
+    FencedPool(FenceTimeline& timeline, Factory create, Recycler recycle = Recycler())
+        : m_timeline(timeline)
+        , m_create(std::move(create))
+        , m_recycle(std::move(recycle))
+    {
+    }
+
+    FencedPool(const FencedPool&) = delete;
+    FencedPool& operator=(const FencedPool&) = delete;
+
+    // Thread safe. Never blocks on the GPU: if the oldest returned object is still in flight a new one is created.
+    Object Acquire()
+    {
+        Object object;
+        bool recycled = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.acquired;
+
+            // objects come back in submission order, if the oldest one isn't done none of the others are.
+            if (!m_returned.empty() && m_timeline.IsComplete(m_returned.front().fenceValue))
+            {
+                object = std::move(m_returned.front().object);
+                m_returned.pop_front();
+                recycled = true;
+                ++m_stats.recycled;
+            }
+            else
+            {
+                ++m_stats.created;
+            }
+        }
+
+        if (!recycled)
+        {
+            return m_create();
+        }
+
+        if (m_recycle)
+        {
+            m_recycle(object);
+        }
+        return object;
+    }
+
+    // Thread safe. fenceValue is the value signaled on the pool's timeline after the last submission using the object.
+    void Release(Object&& object, uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_returned.push_back(Entry{ std::move(object), fenceValue });
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        stats.available = m_returned.size();
+        return stats;
+    }
+
+    FenceTimeline& GetTimeline() const { return m_timeline; }
+
+private:
+    struct Entry
+    {
+        Object object;
+        uint64_t fenceValue;
+    };
+
+    FenceTimeline& m_timeline;
+    Factory m_create;
+    Recycler m_recycle;
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_returned;
+    Stats m_stats;
+};
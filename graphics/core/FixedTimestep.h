@@ -0,0 +1,120 @@
+#pragma once
+
+// Fixed timestep simulation. The time elapsed between frames goes into an accumulator, and the simulation advances in
+// steps of exactly one timestep for as long as the accumulator holds one, so the simulation cost depends on the
+// simulated time and not on the frame rate. What is left in the accumulator, as a fraction of a step, is the
+// interpolation alpha: rendering blends the last two simulated states with it.
+//
+// After a long frame (a hitch, a breakpoint, a window drag) the steps owed could take longer than the time they catch
+// up on; at most maxStepsPerFrame run per frame and the rest of the backlog is dropped, the simulation slows down
+// instead of spiraling.
+//
+// Platform independent, the time comes from a Clock (SimulatedClock for deterministic runs).
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <cstdint>
+
+class FixedTimestep
+{
+public:
+    using Duration = Clock::Duration;
+
+    struct Stats
+    {
+        uint64_t frames { 0 };          // Advance() calls
+        uint64_t steps { 0 };           // fixed steps run
+        uint64_t droppedSteps { 0 };    // steps owed but skipped by the catch-up cap
+        uint32_t maxStepsInFrame { 0 };
+    };
+
+    static Duration StepFromRate(uint32_t stepsPerSecond)
+    {
+        return Duration(std::chrono::seconds(1)) / std::max(1u, stepsPerSecond);
+    }
+
+    explicit FixedTimestep(Clock& clock, Duration step = StepFromRate(60), uint32_t maxStepsPerFrame = 5)
+        : m_clock(&clock)
+        , m_step(step)
+        , m_maxStepsPerFrame(std::max(1u, maxStepsPerFrame))
+    {
+    }
+
+    // Time restarts from the next Advance(), nothing is owed for the time before.
+    void SetClock(Clock& clock)
+    {
+        m_clock = &clock;
+        Reset();
+    }
+
+    void SetStep(Duration step) { m_step = std::max(Duration(1), step); }
+    void SetMaxStepsPerFrame(uint32_t maxSteps) { m_maxStepsPerFrame = std::max(1u, maxSteps); }
+
+    // Forget the accumulated time, after a pause for instance. The next Advance() runs no step.
+    void Reset()
+    {
+        m_started = false;
+        m_accumulator = Duration::zero();
+    }
+
+    // Accumulate the time since the previous call and run step(stepSeconds) once per whole timestep, at most
+    // maxStepsPerFrame times. Returns the number of steps run.
+    template<class StepFunction>
+    uint32_t Advance(StepFunction&& step)
+    {
+        const Duration now = m_clock->Now();
+        ++m_stats.frames;
+
+        if (!m_started)
+        {
+            m_started = true;
+            m_lastTime = now;
+            return 0;
+        }
+
+        m_accumulator += now - m_lastTime;
+        m_lastTime = now;
+
+        const double stepSeconds = GetStepSeconds();
+        uint32_t steps = 0;
+        while (m_accumulator >= m_step && steps < m_maxStepsPerFrame)
+        {
+            step(stepSeconds);
+            m_accumulator -= m_step;
+            ++steps;
+        }
+
+        if (m_accumulator >= m_step)
+        {
+            // over the cap, drop the whole steps still owed but keep the fraction so alpha stays continuous.
+            m_stats.droppedSteps += static_cast<uint64_t>(m_accumulator / m_step);
+            m_accumulator %= m_step;
+        }
+
+        m_stats.steps += steps;
+        m_stats.maxStepsInFrame = std::max(m_stats.maxStepsInFrame, steps);
+        return steps;
+    }
+
+    // Fraction of a step elapsed since the last step, in [0, 1).
+    double GetAlpha() const
+    {
+        return static_cast<double>(m_accumulator.count()) / static_cast<double>(m_step.count());
+    }
+
+    Duration GetStep() const { return m_step; }
+    double GetStepSeconds() const { return std::chrono::duration<double>(m_step).count(); }
+    uint32_t GetMaxStepsPerFrame() const { return m_maxStepsPerFrame; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    Clock* m_clock;
+    Duration m_step;
+    uint32_t m_maxStepsPerFrame;
+
+    bool m_started { false };
+    Duration m_lastTime { 0 };
+    Duration m_accumulator { 0 };
+    Stats m_stats;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+// Frame benchmark: a number of warmup frames that aren't measured (shader compilation, pools growing, clocks ramping
+// up), then a number of measured frames. Samples of each metric are tagged with the frame they belong to, so the GPU
+// times read back frames later still land in the right bucket, and the report summarizes every measured frame (average,
+// p50, p95, p99, max). The report is written as JSON for the nightly regression runs.
+//
+// Platform independent.
+
+#include "Clock.h"
+#include "RollingStatistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+class FrameBenchmark
+{
+public:
+    enum class Metric : uint32_t
+    {
+        CpuFrame = 0, // frame start to frame start on the thread rendering
+        GpuFrame,     // first to last command of the frame on the GPU
+        FenceWait,    // CPU blocked on the frames in flight limit
+        Present,      // Present() call
+        Count
+    };
+
+    struct Settings
+    {
+        uint32_t warmupFrames { 100 };
+        uint32_t measuredFrames { 1000 };
+        std::string reportFile { "benchmark.json" };
+    };
+
+    // How the frames were rendered, copied as is into the report.
+    struct Configuration
+    {
+        uint32_t width { 0 };
+        uint32_t height { 0 };
+        uint32_t bufferCount { 0 };
+        bool vSync { false };
+        bool headless { false };
+    };
+
+    struct Report
+    {
+        Settings settings;
+        Configuration configuration;
+        uint64_t frames { 0 };  // measured frames actually run
+        double seconds { 0.0 }; // wall time of the measured frames
+        double framesPerSecond { 0.0 };
+        RollingStatistics::Summary milliseconds[static_cast<uint32_t>(Metric::Count)];
+    };
+
+    static const char* GetMetricName(Metric metric)
+    {
+        static const char* const names[] = { "cpuFrameMs", "gpuFrameMs", "fenceWaitMs", "presentMs" };
+        static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Metric::Count), "one name per metric");
+        return names[static_cast<uint32_t>(metric)];
+    }
+
+    // Enable the benchmark, now is the start of frame 0 on the benchmark's clock.
+    void Start(const Settings& settings, Clock::Duration now)
+    {
+        m_settings = settings;
+        m_enabled = true;
+        m_frame = 0;
+        m_measureStart = m_lastFrameEnd = now;
+        m_measureEnd = Clock::Duration::zero();
+        for (auto& metric : m_metrics)
+        {
+            metric = RollingStatistics(std::max(1u, settings.measuredFrames));
+        }
+    }
+
+    bool IsEnabled() const { return m_enabled; }
+    const Settings& GetSettings() const { return m_settings; }
+    uint64_t GetFrame() const { return m_frame; } // frame being rendered
+
+    // Frames warmed up and measured.
+    bool IsComplete() const { return m_enabled && m_frame >= TotalFrames(); }
+
+    // Sample of the frame being rendered.
+    void Record(Metric metric, double milliseconds) { Record(metric, m_frame, milliseconds); }
+
+    // Sample of an earlier frame. Dropped unless the frame is a measured one.
+    void Record(Metric metric, uint64_t frame, double milliseconds)
+    {
+        if (m_enabled && frame >= m_settings.warmupFrames && frame < TotalFrames())
+        {
+            m_metrics[static_cast<uint32_t>(metric)].Add(milliseconds);
+        }
+    }
+
+    // The frame has been rendered, now is its end on the benchmark's clock.
+    void EndFrame(Clock::Duration now)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        ++m_frame;
+        m_lastFrameEnd = now;
+        if (m_frame == m_settings.warmupFrames)
+        {
+            m_measureStart = now;
+        }
+        if (m_frame == TotalFrames())
+        {
+            m_measureEnd = now;
+        }
+    }
+
+    Report GetReport(const Configuration& configuration) const
+    {
+        Report report;
+        report.settings = m_settings;
+        report.configuration = configuration;
+        report.frames = m_frame > m_settings.warmupFrames ? std::min<uint64_t>(m_frame, TotalFrames()) - m_settings.warmupFrames : 0;
+
+        const Clock::Duration end = IsComplete() ? m_measureEnd : m_lastFrameEnd;
+        report.seconds = report.frames > 0 ? std::chrono::duration<double>(end - m_measureStart).count() : 0.0;
+        report.framesPerSecond = report.seconds > 0.0 ? report.frames / report.seconds : 0.0;
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(Metric::Count); ++i)
+        {
+            report.milliseconds[i] = m_metrics[i].Summarize();
+        }
+        return report;
+    }
+
+    static void WriteJson(std::ostream& out, const Report& report)
+    {
+        out << "{\n";
+        out << "  \"warmupFrames\": " << report.settings.warmupFrames << ",\n";
+        out << "  \"measuredFrames\": " << report.frames << ",\n";
+        out << "  \"width\": " << report.configuration.width << ",\n";
+        out << "  \"height\": " << report.configuration.height << ",\n";
+        out << "  \"bufferCount\": " << report.configuration.bufferCount << ",\n";
+        out << "  \"vSync\": " << (report.configuration.vSync ? "true" : "false") << ",\n";
+        out << "  \"headless\": " << (report.configuration.headless ? "true" : "false") << ",\n";
+        out << "  \"seconds\": " << report.seconds << ",\n";
+        out << "  \"framesPerSecond\": " << report.framesPerSecond;
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(Metric::Count); ++i)
+        {
+            const RollingStatistics::Summary& summary = report.milliseconds[i];
+            out << ",\n  \"" << GetMetricName(static_cast<Metric>(i)) << "\": { \"samples\": " << summary.samples
+                << ", \"average\": " << summary.average << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+                << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << " }";
+        }
+        out << "\n}\n";
+    }
+
+    static bool SaveJson(const std::string& path, const Report& report)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+        WriteJson(file, report);
+        return static_cast<bool>(file);
+    }
+
+private:
+    uint64_t TotalFrames() const { return static_cast<uint64_t>(m_settings.warmupFrames) + m_settings.measuredFrames; }
+
+    Settings m_settings;
+    bool m_enabled { false };
+    uint64_t m_frame { 0 };
+    Clock::Duration m_lastFrameEnd { Clock::Duration::zero() };
+    Clock::Duration m_measureStart { Clock::Duration::zero() };
+    Clock::Duration m_measureEnd { Clock::Duration::zero() };
+    RollingStatistics m_metrics[static_cast<uint32_t>(Metric::Count)];
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+// Picks the number of frames in flight automatically: the smallest latency that keeps the GPU busy.
+//
+// Every frame reports whether the GPU had already finished all the previous work when the frame was submitted (the GPU
+// went idle, a bubble) and how long the CPU waited on the fence of the frame it is about to reuse. Over a window of
+// frames:
+//   - bubbles in more than a few frames mean the GPU is starving, one more frame in flight is allowed;
+//   - no bubble at all while the CPU keeps waiting on the fence means frames are queuing up for nothing but latency,
+//     one frame in flight less is tried. A latency that produced bubbles isn't retried for a while.
+//
+// Platform independent.
+
+#include <algorithm>
+#include <cstdint>
+
+class FrameLatencyController
+{
+public:
+    struct Settings
+    {
+        uint32_t minLatency { 1 };
+        uint32_t maxLatency { 4 };
+        uint32_t windowFrames { 60 };       // frames per decision
+        double bubbleRatioToGrow { 0.05 };  // share of frames with a GPU bubble above which the latency grows
+        double waitRatioToShrink { 0.10 };  // share of the frame time spent waiting on the fence above which the latency shrinks
+        uint32_t cooldownWindows { 10 };    // windows to wait before shrinking again to a latency that produced bubbles
+    };
+
+    explicit FrameLatencyController(uint32_t initialLatency = 2)
+        : FrameLatencyController(Settings(), initialLatency)
+    {
+    }
+
+    FrameLatencyController(const Settings& settings, uint32_t initialLatency)
+        : m_settings(settings)
+        , m_latency(std::min(std::max(initialLatency, settings.minLatency), settings.maxLatency))
+    {
+    }
+
+    // gpuIdleAtSubmit: all the previous frames were complete when this one was submitted.
+    // fenceWaitMs: time the CPU blocked waiting for a frame in flight to complete. frameMs: CPU frame time.
+    // Returns true if the latency changed.
+    bool RecordFrame(bool gpuIdleAtSubmit, double fenceWaitMs, double frameMs)
+    {
+        ++m_frames;
+        m_bubbles += gpuIdleAtSubmit ? 1 : 0;
+        m_waitMs += fenceWaitMs;
+        m_frameMs += frameMs;
+
+        if (m_frames < m_settings.windowFrames)
+        {
+            return false;
+        }
+
+        const uint32_t previousLatency = m_latency;
+        const double bubbleRatio = static_cast<double>(m_bubbles) / m_frames;
+        const double waitRatio = m_frameMs > 0.0 ? m_waitMs / m_frameMs : 0.0;
+
+        if (m_cooldown > 0)
+        {
+            --m_cooldown;
+        }
+
+        if (bubbleRatio > m_settings.bubbleRatioToGrow)
+        {
+            if (m_latency < m_settings.maxLatency)
+            {
+                ++m_latency;
+                // the latency we came from starves the GPU, don't go back to it right away.
+                m_cooldown = m_settings.cooldownWindows;
+            }
+        }
+        else if (m_bubbles == 0 && waitRatio > m_settings.waitRatioToShrink && m_latency > m_settings.minLatency && m_cooldown == 0)
+        {
+            --m_latency;
+        }
+
+        m_frames = 0;
+        m_bubbles = 0;
+        m_waitMs = 0.0;
+        m_frameMs = 0.0;
+
+        return m_latency != previousLatency;
+    }
+
+    uint32_t GetLatency() const { return m_latency; }
+    const Settings& GetSettings() const { return m_settings; }
+
+private:
+    Settings m_settings;
+    uint32_t m_latency;
+
+    uint32_t m_frames { 0 };
+    uint32_t m_bubbles { 0 };
+    double m_waitMs { 0.0 };
+    double m_frameMs { 0.0 };
+    uint32_t m_cooldown { 0 };
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+// Paces the frame loop to a target rate. Each frame has a deadline one period after the previous one; the pacer sleeps
+// until shortly before it and spins the rest of the way, so the coarse sleep granularity doesn't show up as jitter and
+// the spin is short enough not to burn a core. A frame that is late by more than a period restarts the schedule from
+// now instead of rushing several frames to catch up.
+//
+// Platform independent, time comes from a Clock.
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class FramePacer
+{
+public:
+    using Duration = Clock::Duration;
+
+    struct Stats
+    {
+        uint64_t frames { 0 };
+        double averageFrameMs { 0.0 };   // over the last SampleCount frames
+        double jitterMs { 0.0 };         // standard deviation of the frame time over the last SampleCount frames
+        double maxFrameMs { 0.0 };
+        double cpuBusyFraction { 0.0 };  // share of the frame time the pacing thread wasn't sleeping (spinning counts as busy)
+        double spinFraction { 0.0 };     // share of the frame time spent in the final spin
+        uint64_t missedDeadlines { 0 };  // frames that were already late when WaitForNextFrame() was called
+    };
+
+    static const uint32_t SampleCount = 128;
+
+    // targetFrameRate of 0 doesn't pace at all, frames are only measured.
+    explicit FramePacer(Clock& clock, uint32_t targetFrameRate = 60)
+        : m_clock(clock)
+    {
+        SetTargetFrameRate(targetFrameRate);
+    }
+
+    void SetTargetFrameRate(uint32_t targetFrameRate)
+    {
+        m_targetFrameRate = targetFrameRate;
+        m_period = targetFrameRate > 0 ? Duration(std::chrono::seconds(1)) / targetFrameRate : Duration::zero();
+        m_nextDeadline = Duration::zero();
+    }
+
+    uint32_t GetTargetFrameRate() const { return m_targetFrameRate; }
+
+    // Sleeping this close to the deadline risks overshooting it, the rest is spent spinning.
+    // Should be a bit more than the sleep granularity of the clock.
+    void SetSpinThreshold(Duration threshold) { m_spinThreshold = threshold; }
+
+    // Block until the next frame should start. Call once per frame, right before starting it.
+    void WaitForNextFrame()
+    {
+        Duration now = m_clock.Now();
+        Duration slept = Duration::zero();
+        Duration spun = Duration::zero();
+
+        if (m_period > Duration::zero())
+        {
+            if (m_nextDeadline == Duration::zero())
+            {
+                m_nextDeadline = now;
+            }
+
+            if (now > m_nextDeadline + m_period)
+            {
+                // too late to catch up, start over from now.
+                ++m_missedDeadlines;
+                m_nextDeadline = now;
+            }
+            else if (now > m_nextDeadline)
+            {
+                ++m_missedDeadlines;
+            }
+
+            const Duration sleepUntil = m_nextDeadline - m_spinThreshold;
+            if (now < sleepUntil)
+            {
+                m_clock.Sleep(sleepUntil - now);
+                const Duration afterSleep = m_clock.Now();
+                slept = afterSleep - now;
+                now = afterSleep;
+            }
+
+            const Duration spinStart = now;
+            while (now < m_nextDeadline)
+            {
+                m_clock.Relax();
+                now = m_clock.Now();
+            }
+            spun = now - spinStart;
+
+            m_nextDeadline += m_period;
+        }
+
+        Record(now, slept, spun);
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.frames = m_frames;
+        stats.missedDeadlines = m_missedDeadlines;
+
+        const uint32_t samples = static_cast<uint32_t>(std::min<uint64_t>(m_frames > 0 ? m_frames - 1 : 0, SampleCount));
+        if (samples == 0)
+        {
+            return stats;
+        }
+
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        double maxFrame = 0.0;
+        double slept = 0.0;
+        double spun = 0.0;
+        for (uint32_t i = 0; i < samples; ++i)
+        {
+            const double frameMs = m_frameMs[i];
+            sum += frameMs;
+            sumSquares += frameMs * frameMs;
+            maxFrame = std::max(maxFrame, frameMs);
+            slept += m_sleptMs[i];
+            spun += m_spunMs[i];
+        }
+
+        const double mean = sum / samples;
+        stats.averageFrameMs = mean;
+        stats.jitterMs = std::sqrt(std::max(0.0, sumSquares / samples - mean * mean));
+        stats.maxFrameMs = maxFrame;
+        stats.cpuBusyFraction = sum > 0.0 ? 1.0 - slept / sum : 1.0;
+        stats.spinFraction = sum > 0.0 ? spun / sum : 0.0;
+        return stats;
+    }
+
+private:
+    static double ToMilliseconds(Duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+    void Record(Duration frameStart, Duration slept, Duration spun)
+    {
+        if (m_frames > 0)
+        {
+            const uint32_t sample = static_cast<uint32_t>((m_frames - 1) % SampleCount);
+            m_frameMs[sample] = ToMilliseconds(frameStart - m_lastFrameStart);
+            m_sleptMs[sample] = ToMilliseconds(slept);
+            m_spunMs[sample] = ToMilliseconds(spun);
+        }
+
+        m_lastFrameStart = frameStart;
+        ++m_frames;
+    }
+
+    Clock& m_clock;
+    uint32_t m_targetFrameRate { 0 };
+    Duration m_period { 0 };
+    Duration m_nextDeadline { 0 };
+    Duration m_spinThreshold { std::chrono::microseconds(1500) };
+
+    Duration m_lastFrameStart { 0 };
+    uint64_t m_frames { 0 };
+    uint64_t m_missedDeadlines { 0 };
+
+    double m_frameMs[SampleCount] = {};
+    double m_sleptMs[SampleCount] = {};
+    double m_spunMs[SampleCount] = {};
+};
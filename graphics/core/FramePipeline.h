@@ -0,0 +1,186 @@
+#pragma once
+
+// Two-stage frame pipeline: the simulation of frame N+1 runs on a job system worker while the render stage records and
+// submits frame N. The stages hand frames over through a double-buffered packet (FramePackets): the simulation only
+// writes the back packet, the render stage only reads the front one, and the packets are swapped by Publish() at the
+// start of every frame, when the simulation of the previous frame has finished and the render stage hasn't started.
+//
+//   frame      | N-1          | N            | N+1
+//   worker     | simulate N   | simulate N+1 | simulate N+2
+//   this thread| render N-1   | render N     | render N+1
+//
+// The simulation is scheduled with JobSystem::ScheduleOnWorker(): the render stage waits on jobs of its own (parallel
+// recording) and would otherwise run the simulation inline in one of those waits, back to back with the render.
+//
+// Without a job system (or disabled) the stages run back to back on the calling thread, in the same order.
+//
+// Platform independent.
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+
+// Double-buffered frame state, written by the simulation stage and read by the render stage.
+template<class Packet>
+class FramePackets
+{
+public:
+    Packet& Back() { return m_packets[m_front ^ 1]; }
+    const Packet& Front() const { return m_packets[m_front]; }
+
+    // The back packet becomes the snapshot the render stage reads. Only call with neither stage running.
+    void Publish() { m_front ^= 1; }
+
+private:
+    Packet m_packets[2] {};
+    uint32_t m_front { 0 };
+};
+
+class FramePipeline
+{
+public:
+    using Stage = std::function<void()>;
+
+    struct Stats
+    {
+        uint64_t frames { 0 };
+        uint64_t pipelinedFrames { 0 }; // frames whose simulation overlapped the previous render
+        double averageSimulateMs { 0.0 };
+        double averageRenderMs { 0.0 };
+        double averageStallMs { 0.0 };  // render stage waiting for the simulation to finish, the cost the overlap didn't hide
+    };
+
+    FramePipeline() = default;
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    ~FramePipeline()
+    {
+        try
+        {
+            Flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    // Run one frame. simulate fills the back packet of the next frame, publish swaps the packets, render consumes the
+    // front one. With a job system, simulate of the next frame is still running on a worker when this returns.
+    // Rethrows what the simulation of the previous frame threw.
+    void RunFrame(JobSystem* jobSystem, const Stage& simulate, const Stage& publish, const Stage& render)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // the simulation of this frame: started by the previous call, left over by Flush(), or not started at all.
+        const auto stallStart = clock::now();
+        WaitForSimulation();
+        if (m_state == State::Idle)
+        {
+            m_state = State::Ready;
+            RunSimulation(simulate);
+            WaitForSimulation();
+        }
+        const double stallMs = MillisecondsSince(stallStart);
+
+        Accumulate(m_stats.averageSimulateMs, m_simulateMs);
+        publish();
+        m_state = State::Idle;
+
+        const bool pipelined = m_enabled && jobSystem;
+        if (pipelined)
+        {
+            // the next frame's simulation overlaps this frame's render.
+            m_jobSystem = jobSystem;
+            m_state = State::Running;
+            jobSystem->ScheduleOnWorker([this, simulate]() { RunSimulation(simulate); }, &m_simulation);
+        }
+
+        const auto renderStart = clock::now();
+        render();
+        const double renderMs = MillisecondsSince(renderStart);
+
+        ++m_stats.frames;
+        m_stats.pipelinedFrames += pipelined ? 1 : 0;
+        Accumulate(m_stats.averageRenderMs, renderMs);
+        Accumulate(m_stats.averageStallMs, stallMs);
+    }
+
+    // Wait for the simulation in flight, if any. Its packet is published by the next RunFrame(). Call before touching
+    // the simulation state from outside the pipeline (release, resize of the scene...).
+    void Flush()
+    {
+        WaitForSimulation();
+    }
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    enum class State
+    {
+        Idle,    // nothing simulated for the next frame
+        Running, // scheduled on the job system
+        Ready,   // simulated, not published yet
+    };
+
+    static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // exponential moving average, reacts within a few dozen frames.
+    static void Accumulate(double& average, double sample)
+    {
+        average += (sample - average) * 0.05;
+    }
+
+    void RunSimulation(const Stage& simulate)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            simulate();
+        }
+        catch (...)
+        {
+            m_error = std::current_exception();
+        }
+        m_simulateMs = MillisecondsSince(start);
+    }
+
+    void WaitForSimulation()
+    {
+        if (m_state == State::Running)
+        {
+            m_jobSystem->Wait(m_simulation);
+            m_state = State::Ready;
+        }
+
+        if (m_error)
+        {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            m_state = State::Idle;
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool m_enabled { false }; // opt in, the stages must only share state through FramePackets
+    JobSystem* m_jobSystem { nullptr };
+    JobCounter m_simulation;
+
+    State m_state { State::Idle }; // only touched by the thread calling RunFrame()
+
+    // written by the simulation, read after waiting on the counter.
+    double m_simulateMs { 0.0 };
+    std::exception_ptr m_error;
+
+    Stats m_stats;
+};
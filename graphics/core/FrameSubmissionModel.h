@@ -0,0 +1,226 @@
+#pragma once
+
+// Model of the submission side of a frame, written against the abstract device layer (Device.h) to run on a
+// NullDevice: pooled command allocators, transition to render target, clear, scene command lists, transition back, one
+// submission, present into an offscreen ring, frame fence and frames in flight limit. It isn't Framework_DX12::Render(),
+// which drives D3D12 directly and adds the render graph, the upload and descriptor rings, the resource state tracking
+// and the GPU profiler; it's only the synchronization between the CPU and a simulated GPU, so the pools, the fence
+// waits and the latency limit can be tested without a GPU (tests/FrameSubmissionModelTests.cpp).
+//
+// Platform independent.
+
+#include "Clock.h"
+#include "Device.h"
+#include "FencedPool.h"
+#include "FenceTimeline.h"
+#include "Presenter.h"
+#include "Profiler.h"
+#include "RollingStatistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class FrameSubmissionModel
+{
+public:
+    struct Settings
+    {
+        uint32_t width { 1280 };
+        uint32_t height { 720 };
+        uint32_t bufferCount { 4 };      // offscreen render targets standing in for the back buffers
+        uint32_t frameLatency { 3 };     // frames in flight, counting the one being recorded
+        uint32_t sceneCommandListCount { 0 };
+    };
+
+    struct Stats
+    {
+        uint64_t frames { 0 };
+        RollingStatistics::Summary cpuFrameMs; // Frame() call to Frame() call
+        RollingStatistics::Summary fenceWaitMs; // frames in flight limit
+        FenceTimeline::Stats fence;
+        FencedPool<std::unique_ptr<GpuCommandAllocator>>::Stats allocators;
+    };
+
+    // Records part of the scene into commandList, listIndex in [0, listCount).
+    using RecordScene = std::function<void(GpuCommandList& commandList, uint32_t listIndex, uint32_t listCount)>;
+
+    static const uint32_t StatisticsWindow = 1024;
+
+    FrameSubmissionModel(GpuDevice& device, Clock& clock)
+        : FrameSubmissionModel(device, clock, Settings())
+    {
+    }
+
+    FrameSubmissionModel(GpuDevice& device, Clock& clock, const Settings& settings)
+        : m_device(device)
+        , m_clock(clock)
+        , m_settings(settings)
+        , m_commandQueue(device.CreateCommandQueue(QueueType::Direct))
+        , m_fence(device.CreateFence(*m_commandQueue))
+        , m_timeline(m_fence.get())
+        , m_allocatorPool(m_timeline,
+            [&device]() { return device.CreateCommandAllocator(QueueType::Direct); },
+            [](std::unique_ptr<GpuCommandAllocator>& allocator) { allocator->Reset(); })
+        , m_frameFenceValues(std::max(1u, settings.frameLatency), 0)
+        , m_cpuFrameMs(StatisticsWindow)
+        , m_fenceWaitMs(StatisticsWindow)
+    {
+        m_settings.bufferCount = std::max(1u, m_settings.bufferCount);
+        m_settings.frameLatency = std::max(1u, m_settings.frameLatency);
+
+        auto commandAllocator = m_allocatorPool.Acquire();
+        m_commandList = device.CreateCommandList(QueueType::Direct, *commandAllocator);
+        m_commandList->Close();
+        m_endFrameCommandList = device.CreateCommandList(QueueType::Direct, *commandAllocator);
+        m_endFrameCommandList->Close();
+        for (uint32_t i = 0; i < m_settings.sceneCommandListCount; ++i)
+        {
+            m_sceneCommandLists.push_back(device.CreateCommandList(QueueType::Direct, *commandAllocator));
+            m_sceneCommandLists.back()->Close();
+        }
+        m_allocatorPool.Release(std::move(commandAllocator), 0);
+
+        m_rtvHeap = device.CreateDescriptorHeap(DescriptorHeapType::RenderTarget, m_settings.bufferCount, false);
+        for (uint32_t i = 0; i < m_settings.bufferCount; ++i)
+        {
+            m_renderTargets.push_back(device.CreateResource(ResourceDesc::RenderTarget(m_settings.width, m_settings.height, Format::RGBA8Unorm), ResourceState::Present));
+            device.CreateRenderTargetView(*m_renderTargets.back(), m_rtvHeap->GetHandle(i));
+        }
+
+        m_presenter.reset(new OffscreenPresenter(m_timeline, m_settings.bufferCount));
+    }
+
+    ~FrameSubmissionModel()
+    {
+        Flush();
+    }
+
+    FrameSubmissionModel(const FrameSubmissionModel&) = delete;
+    FrameSubmissionModel& operator=(const FrameSubmissionModel&) = delete;
+
+    void SetRecordScene(RecordScene recordScene) { m_recordScene = std::move(recordScene); }
+
+    void Frame()
+    {
+        PROFILE_ZONE("FrameSubmissionModel::Frame");
+
+        const Clock::Duration frameStart = m_clock.Now();
+        if (m_frameIndex > 0)
+        {
+            m_cpuFrameMs.Add(std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count());
+        }
+        m_lastFrameStart = frameStart;
+
+        auto commandAllocator = m_allocatorPool.Acquire(); // already reset by the pool
+        const uint32_t bufferIndex = m_presenter->GetCurrentBufferIndex();
+        GpuResource& renderTarget = *m_renderTargets[bufferIndex];
+
+        std::vector<GpuCommandList*> commandLists;
+
+        m_commandList->Reset(*commandAllocator);
+        m_commandList->ResourceBarrier(renderTarget, ResourceState::Present, ResourceState::RenderTarget);
+        const float clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
+        m_commandList->ClearRenderTarget(m_rtvHeap->GetHandle(bufferIndex), clearColor);
+
+        GpuCommandList* endFrameCommandList = m_commandList.get();
+        if (!m_sceneCommandLists.empty())
+        {
+            m_commandList->Close();
+            commandLists.push_back(m_commandList.get());
+
+            const uint32_t listCount = static_cast<uint32_t>(m_sceneCommandLists.size());
+            for (uint32_t i = 0; i < listCount; ++i)
+            {
+                GpuCommandList& sceneCommandList = *m_sceneCommandLists[i];
+                sceneCommandList.Reset(*commandAllocator);
+                if (m_recordScene)
+                {
+                    m_recordScene(sceneCommandList, i, listCount);
+                }
+                sceneCommandList.Close();
+                commandLists.push_back(&sceneCommandList);
+            }
+
+            endFrameCommandList = m_endFrameCommandList.get();
+            endFrameCommandList->Reset(*commandAllocator);
+        }
+
+        endFrameCommandList->ResourceBarrier(renderTarget, ResourceState::RenderTarget, ResourceState::Present);
+        endFrameCommandList->Close();
+        commandLists.push_back(endFrameCommandList);
+
+        {
+            PROFILE_ZONE("ExecuteCommandLists");
+            m_commandQueue->ExecuteCommandLists(static_cast<uint32_t>(commandLists.size()), commandLists.data());
+        }
+        m_presenter->Present(false);
+
+        const uint64_t frameFenceValue = m_timeline.Signal();
+        m_frameFenceValues[m_frameIndex % m_frameFenceValues.size()] = frameFenceValue;
+        ++m_frameIndex;
+
+        m_allocatorPool.Release(std::move(commandAllocator), frameFenceValue);
+        m_presenter->FrameSubmitted(frameFenceValue);
+
+        // at most frameLatency frames in flight, counting the next one.
+        const Clock::Duration waitStart = m_clock.Now();
+        if (m_frameIndex >= m_settings.frameLatency)
+        {
+            PROFILE_ZONE("Frame latency wait");
+            m_timeline.Wait(m_frameFenceValues[(m_frameIndex - m_settings.frameLatency) % m_frameFenceValues.size()]);
+        }
+        m_fenceWaitMs.Add(std::chrono::duration<double, std::milli>(m_clock.Now() - waitStart).count());
+    }
+
+    // Wait for every frame submitted so far.
+    void Flush()
+    {
+        m_timeline.WaitIdle();
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.frames = m_frameIndex;
+        stats.cpuFrameMs = m_cpuFrameMs.Summarize();
+        stats.fenceWaitMs = m_fenceWaitMs.Summarize();
+        stats.fence = m_timeline.GetStats();
+        stats.allocators = m_allocatorPool.GetStats();
+        return stats;
+    }
+
+    GpuDevice& GetDevice() const { return m_device; }
+    GpuCommandQueue& GetCommandQueue() const { return *m_commandQueue; }
+    FenceTimeline& GetTimeline() { return m_timeline; }
+    Presenter& GetPresenter() const { return *m_presenter; }
+
+private:
+    GpuDevice& m_device;
+    Clock& m_clock;
+    Settings m_settings;
+
+    std::unique_ptr<GpuCommandQueue> m_commandQueue;
+    std::unique_ptr<FenceBackend> m_fence;
+    FenceTimeline m_timeline;
+    FencedPool<std::unique_ptr<GpuCommandAllocator>> m_allocatorPool;
+
+    std::unique_ptr<GpuCommandList> m_commandList;
+    std::unique_ptr<GpuCommandList> m_endFrameCommandList;
+    std::vector<std::unique_ptr<GpuCommandList>> m_sceneCommandLists;
+    RecordScene m_recordScene;
+
+    std::unique_ptr<GpuDescriptorHeap> m_rtvHeap;
+    std::vector<std::unique_ptr<GpuResource>> m_renderTargets;
+    std::unique_ptr<Presenter> m_presenter;
+
+    std::vector<uint64_t> m_frameFenceValues; // fence value of the last frameLatency frames
+    uint64_t m_frameIndex { 0 };
+    Clock::Duration m_lastFrameStart { Clock::Duration::zero() };
+
+    RollingStatistics m_cpuFrameMs;
+    RollingStatistics m_fenceWaitMs;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+// Drives a fixed number of frames back to back, as fast as the frame function allows, and reports the throughput.
+// Used by the headless mode (batch jobs, performance runs) in place of the windowed main loop.
+//
+// Platform independent, the time comes from a Clock.
+
+#include "Clock.h"
+#include "RollingStatistics.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+class HeadlessRunner
+{
+public:
+    struct Report
+    {
+        uint64_t frames { 0 };
+        double seconds { 0.0 };
+        double framesPerSecond { 0.0 };
+        RollingStatistics::Summary frameMs; // over the last WindowSize frames
+    };
+
+    static const uint32_t WindowSize = 4096;
+
+    explicit HeadlessRunner(Clock& clock)
+        : m_clock(clock)
+    {
+    }
+
+    // Run frame frameCount times. shouldStop, if given, is checked after every frame and ends the run early.
+    Report Run(uint64_t frameCount, const std::function<void()>& frame, const std::function<bool()>& shouldStop = nullptr)
+    {
+        RollingStatistics frameTimes(WindowSize);
+
+        const Clock::Duration start = m_clock.Now();
+        Clock::Duration frameStart = start;
+
+        Report report;
+        for (; report.frames < frameCount; )
+        {
+            frame();
+            ++report.frames;
+
+            const Clock::Duration frameEnd = m_clock.Now();
+            frameTimes.Add(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            frameStart = frameEnd;
+
+            if (shouldStop && shouldStop())
+            {
+                break;
+            }
+        }
+
+        report.seconds = std::chrono::duration<double>(m_clock.Now() - start).count();
+        report.framesPerSecond = report.seconds > 0.0 ? report.frames / report.seconds : 0.0;
+        report.frameMs = frameTimes.Summarize();
+        return report;
+    }
+
+private:
+    Clock& m_clock;
+};
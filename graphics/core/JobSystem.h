@@ -0,0 +1,361 @@
+#pragma once
+
+// Work-stealing job system. Every worker owns a queue it pushes to and pops from at the back (newest first, cache warm),
+// idle workers steal from the front of the other queues (oldest first, usually the biggest chunks of work). Threads that
+// aren't workers push to a shared queue every worker steals from. A thread waiting on a JobCounter runs jobs meanwhile
+// instead of blocking. An exception thrown by a job is kept by its counter and rethrown by Wait() once every job of the
+// counter has run. Jobs scheduled with ScheduleOnWorker() are never run by a waiting thread, only by a worker looking
+// for new work.
+//
+// Platform independent, only relies on the standard library threads.
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Number of jobs still pending in a group of jobs. Wait on it with JobSystem::Wait().
+class JobCounter
+{
+public:
+    bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending { 0 };
+    std::mutex m_exceptionMutex;
+    std::exception_ptr m_exception; // first one thrown by the group's jobs
+};
+
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    struct Stats
+    {
+        uint64_t executed { 0 }; // jobs run
+        uint64_t stolen { 0 };   // jobs run by a thread other than the one that scheduled them
+        uint64_t sleeps { 0 };   // times a worker ran out of work and went to sleep
+        uint64_t failed { 0 };   // jobs that threw, the exceptions of jobs without a counter are dropped
+    };
+
+    // One worker per hardware thread but the calling one, which is expected to schedule and help with Wait().
+    static uint32_t DefaultWorkerCount()
+    {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        return std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+    }
+
+    explicit JobSystem(uint32_t workerCount = DefaultWorkerCount())
+        : m_workerCount(std::max(1u, workerCount))
+    {
+        // the last queue is shared by every thread that isn't a worker.
+        for (uint32_t i = 0; i < m_workerCount + 1; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        for (uint32_t i = 0; i < m_workerCount; ++i)
+        {
+            m_workers.emplace_back([this, i]() { WorkerMain(i); });
+        }
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_running.store(false, std::memory_order_seq_cst);
+        }
+        m_wake.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t GetWorkerCount() const { return m_workerCount; }
+
+    // Index of the calling thread if it is one of this system's workers, GetWorkerCount() otherwise.
+    uint32_t GetCurrentThreadIndex() const
+    {
+        const ThreadContext& context = GetThreadContext();
+        return context.owner == this ? context.index : m_workerCount;
+    }
+
+    // Thread safe. counter, if any, is incremented now and decremented once the job has run.
+    void Schedule(Job job, JobCounter* counter = nullptr)
+    {
+        if (counter)
+        {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Push(*m_queues[GetCurrentThreadIndex()], std::move(job), counter);
+    }
+
+    // Thread safe. Like Schedule(), but the job is left to a worker and never run inline by Wait(), even by the thread
+    // that scheduled it. For a long job meant to run alongside that thread (the pipelined simulation): its own Wait()
+    // would otherwise pick it up and serialize both. Workers take these jobs before any other.
+    void ScheduleOnWorker(Job job, JobCounter* counter = nullptr)
+    {
+        if (counter)
+        {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Push(m_workerOnlyQueue, std::move(job), counter);
+    }
+
+    // Run jobs until counter reaches zero. Can be called from any thread, including from within a job. Rethrows the
+    // first exception thrown by the counter's jobs, once all of them have run.
+    void Wait(JobCounter& counter)
+    {
+        const uint32_t self = GetCurrentThreadIndex();
+        while (!counter.IsDone())
+        {
+            if (!TryRunOne(self, true))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(counter.m_exceptionMutex);
+            std::swap(exception, counter.m_exception);
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // Run body(i) for i in [0, count), batchSize indices per job, and wait for all of them. An exception thrown by body
+    // stops the rest of its batch and is rethrown here.
+    template <class Body>
+    void ParallelFor(uint32_t count, uint32_t batchSize, const Body& body)
+    {
+        JobCounter counter;
+        batchSize = std::max(1u, batchSize);
+
+        for (uint32_t begin = 0; begin < count; begin += batchSize)
+        {
+            const uint32_t end = std::min(count, begin + batchSize);
+            Schedule([&body, begin, end]()
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    body(i);
+                }
+            }, &counter);
+        }
+
+        Wait(counter);
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.executed = m_executed.load(std::memory_order_relaxed);
+        stats.stolen = m_stolen.load(std::memory_order_relaxed);
+        stats.sleeps = m_sleeps.load(std::memory_order_relaxed);
+        stats.failed = m_failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Task
+    {
+        Job job;
+        JobCounter* counter { nullptr };
+        uint32_t queueIndex { 0 };
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct ThreadContext
+    {
+        const JobSystem* owner { nullptr };
+        uint32_t index { 0 };
+    };
+
+    static ThreadContext& GetThreadContext()
+    {
+        thread_local ThreadContext context;
+        return context;
+    }
+
+    void Push(WorkQueue& queue, Job job, JobCounter* counter)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(Task{ std::move(job), counter, GetCurrentThreadIndex() });
+        }
+
+        m_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+        {
+            // a sleeper between its predicate check and the actual wait still holds the mutex, don't notify before it waits.
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_wake.notify_one();
+        }
+    }
+
+    bool PopOwn(uint32_t self, Task& task)
+    {
+        WorkQueue& queue = *m_queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static bool Steal(WorkQueue& queue, Task& task)
+    {
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    // waiting: called by Wait(), jobs scheduled with ScheduleOnWorker() are left alone.
+    bool TryRunOne(uint32_t self, bool waiting)
+    {
+        if (m_queuedJobs.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+
+        Task task;
+        bool found = !waiting && Steal(m_workerOnlyQueue, task);
+        found = found || PopOwn(self, task);
+
+        const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+        for (uint32_t i = 1; !found && i < queueCount; ++i)
+        {
+            found = Steal(*m_queues[(self + i) % queueCount], task);
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+        // the counter is decremented whatever happens, a waiter would spin forever otherwise.
+        try
+        {
+            task.job();
+        }
+        catch (...)
+        {
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            if (task.counter)
+            {
+                std::lock_guard<std::mutex> lock(task.counter->m_exceptionMutex);
+                if (!task.counter->m_exception)
+                {
+                    task.counter->m_exception = std::current_exception();
+                }
+            }
+        }
+
+        m_executed.fetch_add(1, std::memory_order_relaxed);
+        if (task.queueIndex != self)
+        {
+            m_stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (task.counter)
+        {
+            task.counter->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        return true;
+    }
+
+    void WorkerMain(uint32_t index)
+    {
+        ThreadContext& context = GetThreadContext();
+        context.owner = this;
+        context.index = index;
+        PROFILE_THREAD_NAME("Worker " + std::to_string(index));
+
+        const uint32_t SpinCount = 64;
+        uint32_t idleSpins = 0;
+
+        while (m_running.load(std::memory_order_acquire))
+        {
+            if (TryRunOne(index, false))
+            {
+                idleSpins = 0;
+                continue;
+            }
+
+            if (++idleSpins < SpinCount)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // out of work, sleep until something is scheduled. The sleeping count and the queued count are both
+            // sequentially consistent so either Schedule() sees the sleeper or the sleeper sees the job.
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            m_sleeps.fetch_add(1, std::memory_order_relaxed);
+            m_wake.wait(lock, [this]()
+            {
+                return m_queuedJobs.load(std::memory_order_seq_cst) > 0 || !m_running.load(std::memory_order_seq_cst);
+            });
+            m_sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            idleSpins = 0;
+        }
+
+        context.owner = nullptr;
+    }
+
+    const uint32_t m_workerCount;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    WorkQueue m_workerOnlyQueue;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<bool> m_running { true };
+    std::atomic<uint32_t> m_queuedJobs { 0 };
+    std::atomic<uint32_t> m_sleepingWorkers { 0 };
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+
+    std::atomic<uint64_t> m_executed { 0 };
+    std::atomic<uint64_t> m_stolen { 0 };
+    std::atomic<uint64_t> m_sleeps { 0 };
+    std::atomic<uint64_t> m_failed { 0 };
+};
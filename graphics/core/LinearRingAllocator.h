@@ -0,0 +1,157 @@
+#pragma once
+
+// Linear suballocation out of a ring of capacity bytes, for data written by the CPU every frame and read by the GPU
+// once (dynamic constants, vertices, upload staging). Allocating bumps the head, nothing is freed individually: at the
+// end of a frame its region of the ring is closed with the fence value that covers it, and the whole region is handed
+// back once the timeline has reached that value. Allocation is O(1), retiring is O(1) per frame.
+//
+// Only offsets are managed here, the memory behind them is up to the caller (a persistently mapped upload buffer in
+// UploadRing_DX12).
+//
+// Platform independent.
+
+#include "FenceTimeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+class LinearRingAllocator
+{
+public:
+    static const uint64_t InvalidOffset = ~0ull;
+
+    struct Stats
+    {
+        uint64_t capacity { 0 };
+        uint64_t allocations { 0 };
+        uint64_t allocatedBytes { 0 };     // requested, since the start
+        uint64_t paddingBytes { 0 };       // lost to alignment and to skipping the end of the ring, since the start
+        uint64_t failedAllocations { 0 };  // ring full, or larger than the ring
+        uint64_t inFlightBytes { 0 };      // between the oldest region not retired yet and the head
+        uint64_t highWaterBytes { 0 };     // largest inFlightBytes seen: the capacity actually needed
+        uint64_t maxFrameBytes { 0 };      // largest single frame region
+        uint64_t framesInFlight { 0 };     // closed regions not retired yet
+    };
+
+    LinearRingAllocator(FenceTimeline& timeline, uint64_t capacity)
+        : m_timeline(timeline)
+        , m_capacity(capacity)
+    {
+    }
+
+    LinearRingAllocator(const LinearRingAllocator&) = delete;
+    LinearRingAllocator& operator=(const LinearRingAllocator&) = delete;
+
+    // Offset of size bytes aligned to alignment (a power of two), InvalidOffset if the ring is full. Never blocks:
+    // a full ring first retires the completed frames, then gives up. Thread safe.
+    uint64_t Allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t offset = TryAllocate(size, alignment);
+        if (offset == InvalidOffset)
+        {
+            RetireLocked();
+            offset = TryAllocate(size, alignment);
+        }
+
+        if (offset == InvalidOffset)
+        {
+            ++m_stats.failedAllocations;
+            return InvalidOffset;
+        }
+
+        ++m_stats.allocations;
+        m_stats.allocatedBytes += size;
+        return offset;
+    }
+
+    // Close the region allocated since the last call, the submission that uses it is covered by fenceValue. Call once per
+    // frame on the submitting thread, after the frame's signal.
+    void EndFrame(uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.maxFrameBytes = std::max(m_stats.maxFrameBytes, m_head - m_frameStart);
+        m_frames.push_back(Region{ m_head, fenceValue });
+        m_frameStart = m_head;
+    }
+
+    // Hand back the regions whose fence value has been reached. Only polls the timeline.
+    void RetireCompleted()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RetireLocked();
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        stats.capacity = m_capacity;
+        stats.inFlightBytes = m_head - m_tail;
+        stats.framesInFlight = m_frames.size();
+        return stats;
+    }
+
+    uint64_t GetCapacity() const { return m_capacity; }
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+private:
+    // Closed frame region: everything before end is released once fenceValue is reached.
+    struct Region
+    {
+        uint64_t end;
+        uint64_t fenceValue;
+    };
+
+    // m_head and m_tail only grow, the offset in the ring is their value modulo the capacity.
+    uint64_t TryAllocate(uint64_t size, uint64_t alignment)
+    {
+        if (size > m_capacity)
+        {
+            return InvalidOffset;
+        }
+
+        const uint64_t position = m_head % m_capacity;
+        uint64_t offset = AlignUp(position, alignment);
+        if (offset + size > m_capacity)
+        {
+            offset = 0; // skip the end of the ring, the allocation must be contiguous
+        }
+
+        const uint64_t consumed = (offset >= position ? offset - position : m_capacity - position + offset) + size;
+        if (m_head - m_tail + consumed > m_capacity)
+        {
+            return InvalidOffset;
+        }
+
+        m_stats.paddingBytes += consumed - size;
+        m_head += consumed;
+        m_stats.highWaterBytes = std::max(m_stats.highWaterBytes, m_head - m_tail);
+        return offset;
+    }
+
+    void RetireLocked()
+    {
+        while (!m_frames.empty() && m_timeline.IsComplete(m_frames.front().fenceValue))
+        {
+            m_tail = m_frames.front().end;
+            m_frames.pop_front();
+        }
+    }
+
+    FenceTimeline& m_timeline;
+    const uint64_t m_capacity;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_head { 0 };       // next byte to allocate
+    uint64_t m_tail { 0 };       // oldest byte still in flight
+    uint64_t m_frameStart { 0 }; // head at the start of the current frame
+    std::deque<Region> m_frames; // closed regions not retired yet, in fence order
+    Stats m_stats;
+};
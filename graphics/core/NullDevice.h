@@ -0,0 +1,504 @@
+#pragma once
+
+// GpuDevice without a GPU. Every call is counted (and optionally logged), nothing is rendered, and the fences complete
+// at the time a GPU would have finished the work: each queue executes its submissions one after the other, a submission
+// starts no earlier than submitLatency after ExecuteCommandLists() and costs a fixed amount per command list and per
+// recorded command. The time comes from a Clock, so the whole frame loop (pools, latency waits, presenter throttling)
+// runs and can be measured on any platform, in real time with a SteadyClock or reproducibly with a SimulatedClock.
+//
+// Upload and readback buffers have real CPU memory behind Map(), GPU copies aren't performed.
+//
+// Platform independent.
+
+#include "Clock.h"
+#include "Device.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class NullDevice : public GpuDevice
+{
+public:
+    enum class Call : uint32_t
+    {
+        CreateCommandQueue = 0,
+        CreateFence,
+        CreateCommandAllocator,
+        CreateCommandList,
+        CreateDescriptorHeap,
+        CreateResource,
+        CreateRenderTargetView,
+        ExecuteCommandLists,
+        QueueWait,
+        Signal,
+        GetCompletedValue,
+        FenceWait,
+        ResetCommandAllocator,
+        ResetCommandList,
+        CloseCommandList,
+        ResourceBarrier,
+        ClearRenderTarget,
+        CopyBufferRegion,
+        Draw,
+        Map,
+        Unmap,
+        Count
+    };
+
+    struct Settings
+    {
+        Clock::Duration submitLatency { std::chrono::microseconds(50) };    // ExecuteCommandLists() to the GPU starting on it
+        Clock::Duration commandListCost { std::chrono::microseconds(20) };  // GPU time per command list
+        Clock::Duration commandCost { std::chrono::nanoseconds(500) };      // GPU time per recorded command
+    };
+
+    explicit NullDevice(Clock& clock)
+        : NullDevice(clock, Settings())
+    {
+    }
+
+    NullDevice(Clock& clock, const Settings& settings)
+        : m_clock(clock)
+        , m_settings(settings)
+    {
+        for (auto& count : m_callCounts)
+        {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static const char* GetCallName(Call call)
+    {
+        static const char* const names[] =
+        {
+            "CreateCommandQueue", "CreateFence", "CreateCommandAllocator", "CreateCommandList", "CreateDescriptorHeap",
+            "CreateResource", "CreateRenderTargetView", "ExecuteCommandLists", "QueueWait", "Signal", "GetCompletedValue",
+            "FenceWait", "ResetCommandAllocator", "ResetCommandList", "CloseCommandList", "ResourceBarrier",
+            "ClearRenderTarget", "CopyBufferRegion", "Draw", "Map", "Unmap",
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Call::Count), "one name per call");
+        return names[static_cast<uint32_t>(call)];
+    }
+
+    // Change the simulated GPU costs, applies to the next submissions.
+    void SetSettings(const Settings& settings)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_settings = settings;
+    }
+
+    Settings GetSettings() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_settings;
+    }
+
+    Clock& GetClock() const { return m_clock; }
+
+    uint64_t GetCallCount(Call call) const { return m_callCounts[static_cast<uint32_t>(call)].load(std::memory_order_relaxed); }
+
+    // Keep every call in order, for tests checking what was recorded. Off by default, the log grows without bound.
+    void SetCallLogEnabled(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_callLogEnabled = enable;
+    }
+
+    std::vector<Call> GetCallLog() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_callLog;
+    }
+
+    void ClearCallLog()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_callLog.clear();
+    }
+
+    void RecordCall(Call call)
+    {
+        m_callCounts[static_cast<uint32_t>(call)].fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_callLogEnabled)
+        {
+            m_callLog.push_back(call);
+        }
+    }
+
+    class Resource : public GpuResource
+    {
+    public:
+        Resource(NullDevice& device, const ResourceDesc& desc)
+            : m_device(device)
+            , m_desc(desc)
+        {
+            if (desc.dimension == ResourceDesc::Dimension::Buffer && desc.heap != HeapKind::Default)
+            {
+                m_storage.resize(static_cast<size_t>(desc.width));
+            }
+        }
+
+        virtual const ResourceDesc& GetDesc() const override { return m_desc; }
+
+        virtual void* Map() override
+        {
+            m_device.RecordCall(Call::Map);
+            return m_storage.empty() ? nullptr : m_storage.data();
+        }
+
+        virtual void Unmap() override
+        {
+            m_device.RecordCall(Call::Unmap);
+        }
+
+    private:
+        NullDevice& m_device;
+        ResourceDesc m_desc;
+        std::vector<uint8_t> m_storage;
+    };
+
+    class DescriptorHeap : public GpuDescriptorHeap
+    {
+    public:
+        static const uint64_t DescriptorSize = 32;
+
+        DescriptorHeap(DescriptorHeapType type, uint32_t capacity, bool shaderVisible, uint64_t cpuBase, uint64_t gpuBase)
+            : m_type(type)
+            , m_capacity(capacity)
+            , m_shaderVisible(shaderVisible)
+            , m_cpuBase(cpuBase)
+            , m_gpuBase(gpuBase)
+        {
+        }
+
+        virtual DescriptorHeapType GetType() const override { return m_type; }
+        virtual uint32_t GetCapacity() const override { return m_capacity; }
+        virtual bool IsShaderVisible() const override { return m_shaderVisible; }
+
+        virtual DescriptorHandle GetHandle(uint32_t index) const override
+        {
+            DescriptorHandle handle;
+            handle.cpu = m_cpuBase + index * DescriptorSize;
+            handle.gpu = m_shaderVisible ? m_gpuBase + index * DescriptorSize : 0;
+            return handle;
+        }
+
+    private:
+        DescriptorHeapType m_type;
+        uint32_t m_capacity;
+        bool m_shaderVisible;
+        uint64_t m_cpuBase;
+        uint64_t m_gpuBase;
+    };
+
+    class CommandAllocator : public GpuCommandAllocator
+    {
+    public:
+        explicit CommandAllocator(NullDevice& device) : m_device(device) {}
+
+        virtual void Reset() override { m_device.RecordCall(Call::ResetCommandAllocator); }
+
+    private:
+        NullDevice& m_device;
+    };
+
+    class CommandList : public GpuCommandList
+    {
+    public:
+        CommandList(NullDevice& device, QueueType type)
+            : m_device(device)
+            , m_type(type)
+        {
+        }
+
+        virtual QueueType GetType() const override { return m_type; }
+
+        virtual void Reset(GpuCommandAllocator& /*allocator*/) override
+        {
+            m_device.RecordCall(Call::ResetCommandList);
+            m_commandCount = 0;
+            m_open = true;
+        }
+
+        virtual void Close() override
+        {
+            m_device.RecordCall(Call::CloseCommandList);
+            m_open = false;
+        }
+
+        virtual void ResourceBarrier(GpuResource& /*resource*/, ResourceState /*before*/, ResourceState /*after*/) override { Command(Call::ResourceBarrier); }
+        virtual void ClearRenderTarget(const DescriptorHandle& /*renderTarget*/, const float /*color*/[4]) override { Command(Call::ClearRenderTarget); }
+        virtual void CopyBufferRegion(GpuResource& /*destination*/, uint64_t /*destinationOffset*/, GpuResource& /*source*/, uint64_t /*sourceOffset*/, uint64_t /*size*/) override { Command(Call::CopyBufferRegion); }
+        virtual void Draw(uint32_t /*vertexCount*/, uint32_t /*instanceCount*/) override { Command(Call::Draw); }
+
+        bool IsOpen() const { return m_open; }
+        uint64_t GetCommandCount() const { return m_commandCount; }
+
+    private:
+        void Command(Call call)
+        {
+            m_device.RecordCall(call);
+            ++m_commandCount;
+        }
+
+        NullDevice& m_device;
+        QueueType m_type;
+        uint64_t m_commandCount { 0 };
+        bool m_open { true };
+    };
+
+    class CommandQueue;
+
+    // Completes every signaled value at the time its queue gets there.
+    class Fence : public FenceBackend
+    {
+    public:
+        Fence(NullDevice& device, CommandQueue& queue, uint64_t initialValue)
+            : m_device(device)
+            , m_queue(queue)
+            , m_completedValue(initialValue)
+        {
+        }
+
+        virtual void Signal(uint64_t value) override
+        {
+            m_device.RecordCall(Call::Signal);
+            const Clock::Duration completion = m_queue.Signal();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(std::make_pair(value, completion));
+        }
+
+        virtual uint64_t GetCompletedValue() const override
+        {
+            m_device.RecordCall(Call::GetCompletedValue);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return Update(m_device.GetClock().Now());
+        }
+
+        virtual bool Wait(uint64_t value, std::chrono::milliseconds timeout) override
+        {
+            m_device.RecordCall(Call::FenceWait);
+
+            Clock& clock = m_device.GetClock();
+            const Clock::Duration start = clock.Now();
+            for (;;)
+            {
+                Clock::Duration completion = Clock::Duration::max();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (Update(clock.Now()) >= value)
+                    {
+                        return true;
+                    }
+                    completion = CompletionTime(value);
+                }
+
+                const Clock::Duration now = clock.Now();
+                const bool infinite = timeout == std::chrono::milliseconds::max();
+                if (!infinite && now - start >= timeout)
+                {
+                    return false;
+                }
+
+                // not signaled yet: another thread may still signal it, check again every millisecond.
+                Clock::Duration sleep = completion == Clock::Duration::max() ? std::chrono::milliseconds(1) : completion - now;
+                if (!infinite)
+                {
+                    sleep = std::min<Clock::Duration>(sleep, start + timeout - now);
+                }
+                clock.Sleep(std::max<Clock::Duration>(sleep, Clock::Duration(1)));
+            }
+        }
+
+        // When value completes (or has completed), Clock::Duration::max() if it hasn't been signaled yet.
+        Clock::Duration GetCompletionTime(uint64_t value) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return CompletionTime(value);
+        }
+
+    private:
+        // Caller holds m_mutex.
+        Clock::Duration CompletionTime(uint64_t value) const
+        {
+            if (value <= m_completedValue)
+            {
+                return Clock::Duration::zero();
+            }
+
+            for (const auto& pending : m_pending)
+            {
+                if (pending.first >= value)
+                {
+                    return pending.second;
+                }
+            }
+            return Clock::Duration::max();
+        }
+
+        // Caller holds m_mutex.
+        uint64_t Update(Clock::Duration now) const
+        {
+            while (!m_pending.empty() && m_pending.front().second <= now)
+            {
+                m_completedValue = std::max(m_completedValue, m_pending.front().first);
+                m_pending.pop_front();
+            }
+            return m_completedValue;
+        }
+
+        NullDevice& m_device;
+        CommandQueue& m_queue;
+
+        mutable std::mutex m_mutex;
+        mutable std::deque<std::pair<uint64_t, Clock::Duration>> m_pending; // signaled value, time it completes
+        mutable uint64_t m_completedValue;
+    };
+
+    // Executes submissions in order, the GPU being busy until m_busyUntil.
+    class CommandQueue : public GpuCommandQueue
+    {
+    public:
+        CommandQueue(NullDevice& device, QueueType type)
+            : m_device(device)
+            , m_type(type)
+        {
+        }
+
+        virtual QueueType GetType() const override { return m_type; }
+
+        virtual void ExecuteCommandLists(uint32_t count, GpuCommandList* const* commandLists) override
+        {
+            m_device.RecordCall(Call::ExecuteCommandLists);
+
+            const Settings settings = m_device.GetSettings();
+            Clock::Duration cost = Clock::Duration::zero();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const auto* commandList = static_cast<const CommandList*>(commandLists[i]);
+                cost += settings.commandListCost + settings.commandCost * static_cast<int64_t>(commandList->GetCommandCount());
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const Clock::Duration start = std::max(m_busyUntil, m_device.GetClock().Now() + settings.submitLatency);
+            m_busyUntil = start + cost;
+            m_gpuBusyTime += cost;
+            ++m_submissions;
+        }
+
+        virtual void Wait(FenceBackend& fence, uint64_t value) override
+        {
+            m_device.RecordCall(Call::QueueWait);
+
+            // a wait on a value nobody signaled yet would hang the real queue, here it is ignored.
+            const Clock::Duration completion = static_cast<Fence&>(fence).GetCompletionTime(value);
+            if (completion != Clock::Duration::max())
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busyUntil = std::max(m_busyUntil, completion);
+            }
+        }
+
+        // Time everything submitted so far completes.
+        Clock::Duration Signal()
+        {
+            const Clock::Duration now = m_device.GetClock().Now();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return std::max(m_busyUntil, now);
+        }
+
+        uint64_t GetSubmissionCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_submissions;
+        }
+
+        // Simulated GPU execution time of every submission so far.
+        Clock::Duration GetGpuBusyTime() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_gpuBusyTime;
+        }
+
+    private:
+        NullDevice& m_device;
+        QueueType m_type;
+
+        mutable std::mutex m_mutex;
+        Clock::Duration m_busyUntil { Clock::Duration::zero() };
+        Clock::Duration m_gpuBusyTime { Clock::Duration::zero() };
+        uint64_t m_submissions { 0 };
+    };
+
+    virtual std::unique_ptr<GpuCommandQueue> CreateCommandQueue(QueueType type) override
+    {
+        RecordCall(Call::CreateCommandQueue);
+        return std::unique_ptr<GpuCommandQueue>(new CommandQueue(*this, type));
+    }
+
+    virtual std::unique_ptr<FenceBackend> CreateFence(GpuCommandQueue& queue, uint64_t initialValue = 0) override
+    {
+        RecordCall(Call::CreateFence);
+        return std::unique_ptr<FenceBackend>(new Fence(*this, static_cast<CommandQueue&>(queue), initialValue));
+    }
+
+    virtual std::unique_ptr<GpuCommandAllocator> CreateCommandAllocator(QueueType /*type*/) override
+    {
+        RecordCall(Call::CreateCommandAllocator);
+        return std::unique_ptr<GpuCommandAllocator>(new CommandAllocator(*this));
+    }
+
+    virtual std::unique_ptr<GpuCommandList> CreateCommandList(QueueType type, GpuCommandAllocator& /*allocator*/) override
+    {
+        RecordCall(Call::CreateCommandList);
+        return std::unique_ptr<GpuCommandList>(new CommandList(*this, type));
+    }
+
+    virtual std::unique_ptr<GpuDescriptorHeap> CreateDescriptorHeap(DescriptorHeapType type, uint32_t capacity, bool shaderVisible) override
+    {
+        RecordCall(Call::CreateDescriptorHeap);
+
+        // fake, non overlapping address ranges.
+        const uint64_t size = static_cast<uint64_t>(capacity) * DescriptorHeap::DescriptorSize;
+        const uint64_t base = m_nextDescriptorAddress.fetch_add(size + DescriptorHeap::DescriptorSize, std::memory_order_relaxed);
+        return std::unique_ptr<GpuDescriptorHeap>(new DescriptorHeap(type, capacity, shaderVisible, base, base | GpuAddressBit));
+    }
+
+    virtual std::unique_ptr<GpuResource> CreateResource(const ResourceDesc& desc, ResourceState /*initialState*/) override
+    {
+        RecordCall(Call::CreateResource);
+        return std::unique_ptr<GpuResource>(new Resource(*this, desc));
+    }
+
+    virtual void CreateRenderTargetView(GpuResource& /*resource*/, const DescriptorHandle& /*handle*/) override
+    {
+        RecordCall(Call::CreateRenderTargetView);
+    }
+
+private:
+    static const uint64_t GpuAddressBit = 1ull << 62;
+
+    Clock& m_clock;
+
+    mutable std::mutex m_mutex;
+    Settings m_settings;
+    bool m_callLogEnabled { false };
+    std::vector<Call> m_callLog;
+
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Call::Count)> m_callCounts;
+    std::atomic<uint64_t> m_nextDescriptorAddress { 0x10000 };
+};
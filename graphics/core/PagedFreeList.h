@@ -0,0 +1,102 @@
+#pragma once
+
+// Free list of indices growing a page at a time, for persistent descriptors in CPU only descriptor heaps
+// (DescriptorAllocator_DX12): each page is one heap of pageSize descriptors, an index is page * pageSize + slot.
+// The free indices are linked through a next array, allocating pops the head and freeing pushes back, both O(1); a page
+// is only added when every index is in use. The last freed index is handed out first, it's the most likely to be warm.
+//
+// Not thread safe.
+//
+// Platform independent.
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+class PagedFreeList
+{
+public:
+    static const uint32_t InvalidIndex = ~0u;
+
+    struct Stats
+    {
+        uint32_t pages { 0 };
+        uint32_t capacity { 0 };
+        uint32_t allocated { 0 };
+        uint32_t highWater { 0 }; // largest allocated count seen
+        double occupancy { 0.0 }; // allocated / capacity
+    };
+
+    explicit PagedFreeList(uint32_t pageSize) : m_pageSize(pageSize)
+    {
+        assert(pageSize > 0);
+    }
+
+    // Whether the next Allocate() adds a page. Create the storage behind the page first: if that fails the list is left
+    // as it was, no page without storage.
+    bool NeedsPage() const { return m_freeHead == InvalidIndex; }
+
+    // Index of a free slot, in a new page when NeedsPage().
+    uint32_t Allocate()
+    {
+        if (NeedsPage())
+        {
+            AddPage();
+        }
+
+        const uint32_t index = m_freeHead;
+        m_freeHead = m_next[index];
+        m_next[index] = Allocated;
+
+        ++m_allocated;
+        m_highWater = m_allocated > m_highWater ? m_allocated : m_highWater;
+        return index;
+    }
+
+    void Free(uint32_t index)
+    {
+        assert(index < m_next.size() && m_next[index] == Allocated && "index not allocated");
+
+        m_next[index] = m_freeHead;
+        m_freeHead = index;
+        --m_allocated;
+    }
+
+    bool IsAllocated(uint32_t index) const { return index < m_next.size() && m_next[index] == Allocated; }
+
+    uint32_t GetPageSize() const { return m_pageSize; }
+    uint32_t GetPageCount() const { return static_cast<uint32_t>(m_next.size() / m_pageSize); }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.pages = GetPageCount();
+        stats.capacity = static_cast<uint32_t>(m_next.size());
+        stats.allocated = m_allocated;
+        stats.highWater = m_highWater;
+        stats.occupancy = stats.capacity > 0 ? static_cast<double>(m_allocated) / stats.capacity : 0.0;
+        return stats;
+    }
+
+private:
+    // next of an allocated index.
+    static const uint32_t Allocated = ~0u - 1;
+
+    void AddPage()
+    {
+        const uint32_t first = static_cast<uint32_t>(m_next.size());
+        m_next.resize(m_next.size() + m_pageSize);
+        for (uint32_t i = 0; i + 1 < m_pageSize; ++i)
+        {
+            m_next[first + i] = first + i + 1;
+        }
+        m_next[first + m_pageSize - 1] = InvalidIndex;
+        m_freeHead = first;
+    }
+
+    const uint32_t m_pageSize;
+    std::vector<uint32_t> m_next; // next free index, InvalidIndex at the end of the list, Allocated when in use
+    uint32_t m_freeHead { InvalidIndex };
+    uint32_t m_allocated { 0 };
+    uint32_t m_highWater { 0 };
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+// Measures the time between a Present() call and the moment that present actually reached the display.
+// The caller reports every present with its present count and the time of the call, and whenever the swap chain
+// statistics tell which present was last displayed and when, the two are matched up.
+//
+// Platform independent, times are in nanoseconds from whatever monotonic clock the caller uses for both.
+
+#include <algorithm>
+#include <cstdint>
+
+class PresentLatencyTracker
+{
+public:
+    struct Stats
+    {
+        uint64_t samples { 0 };
+        double averageMs { 0.0 }; // over the last SampleCount matched presents
+        double minMs { 0.0 };
+        double maxMs { 0.0 };
+        double lastMs { 0.0 };
+    };
+
+    static const uint32_t HistorySize = 64;  // presents remembered, statistics lag behind by a few frames at most
+    static const uint32_t SampleCount = 128;
+
+    void OnPresent(uint64_t presentCount, int64_t timeNs)
+    {
+        PresentRecord& record = m_presents[presentCount % HistorySize];
+        record.presentCount = presentCount;
+        record.timeNs = timeNs;
+    }
+
+    // presentCount was displayed at timeNs. Returns false if that present is unknown (too old, or reported twice).
+    bool OnDisplayed(uint64_t presentCount, int64_t timeNs)
+    {
+        if (presentCount <= m_lastDisplayedPresent)
+        {
+            return false;
+        }
+
+        const PresentRecord& record = m_presents[presentCount % HistorySize];
+        if (record.presentCount != presentCount || timeNs < record.timeNs)
+        {
+            return false;
+        }
+
+        m_lastDisplayedPresent = presentCount;
+        m_latencyMs[m_samples % SampleCount] = static_cast<double>(timeNs - record.timeNs) / 1e6;
+        ++m_samples;
+        return true;
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.samples = m_samples;
+
+        const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(m_samples, SampleCount));
+        if (count == 0)
+        {
+            return stats;
+        }
+
+        double sum = 0.0;
+        stats.minMs = m_latencyMs[0];
+        stats.maxMs = m_latencyMs[0];
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sum += m_latencyMs[i];
+            stats.minMs = std::min(stats.minMs, m_latencyMs[i]);
+            stats.maxMs = std::max(stats.maxMs, m_latencyMs[i]);
+        }
+        stats.averageMs = sum / count;
+        stats.lastMs = m_latencyMs[(m_samples - 1) % SampleCount];
+        return stats;
+    }
+
+private:
+    struct PresentRecord
+    {
+        uint64_t presentCount { 0 };
+        int64_t timeNs { 0 };
+    };
+
+    PresentRecord m_presents[HistorySize];
+    uint64_t m_lastDisplayedPresent { 0 };
+
+    double m_latencyMs[SampleCount] = {};
+    uint64_t m_samples { 0 };
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+// Where rendered frames go. The frame loop renders into the buffer GetCurrentBufferIndex() names, calls Present() and,
+// once the frame has been submitted, FrameSubmitted() with its fence value; the presenter then picks the next buffer.
+// A swap chain on screen is one presenter (SwapChainPresenter_DX12), a ring of offscreen render targets standing in for
+// the back buffers of headless runs is another.
+//
+// Platform independent.
+
+#include "FenceTimeline.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class Presenter
+{
+public:
+    virtual ~Presenter() {}
+
+    virtual bool IsHeadless() const = 0;
+    virtual uint32_t GetBufferCount() const = 0;
+    virtual uint32_t GetCurrentBufferIndex() const = 0;
+
+    // Hand the current buffer over for display, vSync waits for the vertical blank when there is a display.
+    virtual void Present(bool vSync) = 0;
+
+    // The frame rendered into the buffer just presented is complete once fenceValue is reached.
+    virtual void FrameSubmitted(uint64_t /*fenceValue*/) {}
+
+    // The buffers were destroyed and created again (resize), nothing in flight references them.
+    virtual void BuffersRecreated() {}
+
+    uint64_t GetPresentCount() const { return m_presentCount; }
+
+protected:
+    uint64_t m_presentCount { 0 };
+};
+
+// Ring of offscreen render targets used in place of a swap chain. Nothing is displayed: Present() only counts, and a
+// buffer is handed out again once the frame that last rendered into it has completed, which is the throttling a swap
+// chain would otherwise do inside Present().
+class OffscreenPresenter : public Presenter
+{
+public:
+    OffscreenPresenter(FenceTimeline& timeline, uint32_t bufferCount)
+        : m_timeline(timeline)
+        , m_lastUse(std::max(1u, bufferCount), 0)
+    {
+    }
+
+    virtual bool IsHeadless() const override { return true; }
+    virtual uint32_t GetBufferCount() const override { return static_cast<uint32_t>(m_lastUse.size()); }
+    virtual uint32_t GetCurrentBufferIndex() const override { return m_current; }
+
+    virtual void Present(bool /*vSync*/) override
+    {
+        ++m_presentCount;
+    }
+
+    virtual void FrameSubmitted(uint64_t fenceValue) override
+    {
+        m_lastUse[m_current] = fenceValue;
+        m_current = (m_current + 1) % GetBufferCount();
+
+        // only blocks when every buffer of the ring is still in flight.
+        m_timeline.Wait(m_lastUse[m_current]);
+    }
+
+    virtual void BuffersRecreated() override
+    {
+        std::fill(m_lastUse.begin(), m_lastUse.end(), 0);
+        m_current = 0;
+    }
+
+private:
+    FenceTimeline& m_timeline;
+    std::vector<uint64_t> m_lastUse; // fence value of the last frame rendered into each buffer
+    uint32_t m_current { 0 };
+};
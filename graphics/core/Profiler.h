@@ -0,0 +1,286 @@
+#pragma once
+
+// Hierarchical CPU profiler. PROFILE_ZONE("name") times the enclosing scope; zones nest, the trace viewer rebuilds the
+// hierarchy from the timestamps. Every thread records into its own ring buffer, written by that thread only without
+// any lock: the newest ZoneCapacity zones of every thread are kept. The trace is exported in the Chrome trace event
+// format, loaded by chrome://tracing and ui.perfetto.dev.
+//
+// Timelines that aren't threads (a GPU queue) are Tracks, created by name and fed zones timed by other means.
+//
+// Zone names must outlive the profiler, string literals or __FUNCTION__.
+// With CONF_BOOL_ENABLE_PROFILER false the macros expand to nothing.
+//
+// Platform independent.
+
+#ifndef CONF_BOOL_ENABLE_PROFILER
+#define CONF_BOOL_ENABLE_PROFILER     (true)
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+public:
+    static const uint32_t ZoneCapacity = 1u << 16; // zones kept per thread
+
+    struct Zone
+    {
+        const char* name { nullptr };
+        int64_t startNs { 0 };
+        int64_t endNs { 0 };
+        uint32_t depth { 0 };
+    };
+
+    // A zone in a ring. The fields are atomic because the exporter copies them while the owner may be overwriting them,
+    // relaxed is enough: the write index tells which copies to keep.
+    struct ZoneSlot
+    {
+        std::atomic<const char*> name { nullptr };
+        std::atomic<int64_t> startNs { 0 };
+        std::atomic<int64_t> endNs { 0 };
+        std::atomic<uint32_t> depth { 0 };
+    };
+
+    // Ring of the zones of one thread, or of one named track.
+    struct Track
+    {
+        std::unique_ptr<ZoneSlot[]> zones { new ZoneSlot[ZoneCapacity] };
+        std::atomic<uint64_t> written { 0 }; // zones ever recorded, only the owner stores it
+        uint32_t depth { 0 };
+        std::string name; // guarded by the profiler mutex
+    };
+
+    static Profiler& Get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static int64_t NowNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Recording can be paused at runtime, zones opened while disabled are dropped.
+    void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // Name shown for the calling thread in the trace.
+    void SetThreadName(const std::string& name)
+    {
+        Track& buffer = GetThreadTrack();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer.name = name;
+    }
+
+    // Record a zone timed by other means on the calling thread.
+    void Record(const char* name, int64_t startNs, int64_t endNs, uint32_t depth)
+    {
+        Record(GetThreadTrack(), name, startNs, endNs, depth);
+    }
+
+    // A timeline of its own in the trace. Lives as long as the profiler; zones are recorded on it by one thread at a time.
+    Track& CreateTrack(const std::string& name)
+    {
+        auto track = std::make_shared<Track>();
+        track->name = name;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tracks.push_back(track);
+        return *track;
+    }
+
+    // Times in NowNanoseconds() units.
+    static void Record(Track& track, const char* name, int64_t startNs, int64_t endNs, uint32_t depth)
+    {
+        const uint64_t index = track.written.load(std::memory_order_relaxed);
+
+        // a reader that sees any of the new fields also sees every write index stored before them (see Snapshot()).
+        std::atomic_thread_fence(std::memory_order_release);
+        ZoneSlot& zone = track.zones[index % ZoneCapacity];
+        zone.name.store(name, std::memory_order_relaxed);
+        zone.startNs.store(startNs, std::memory_order_relaxed);
+        zone.endNs.store(endNs, std::memory_order_relaxed);
+        zone.depth.store(depth, std::memory_order_relaxed);
+
+        // publishes the zone.
+        track.written.store(index + 1, std::memory_order_release);
+    }
+
+    // Write every zone recorded so far in the Chrome trace event format. Can run while other threads keep recording,
+    // zones overwritten during the copy are left out.
+    void WriteChromeTrace(std::ostream& out)
+    {
+        std::vector<std::shared_ptr<Track>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            buffers = m_tracks;
+        }
+
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        std::vector<Zone> zones;
+        for (size_t threadIndex = 0; threadIndex < buffers.size(); ++threadIndex)
+        {
+            Track& buffer = *buffers[threadIndex];
+
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                name = buffer.name.empty() ? "thread " + std::to_string(threadIndex) : buffer.name;
+            }
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadIndex
+                << ",\"args\":{\"name\":\"" << Escape(name) << "\"}}";
+            first = false;
+
+            Snapshot(buffer, zones);
+            for (const Zone& zone : zones)
+            {
+                char timing[96];
+                std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"dur\":%.3f", (zone.startNs - m_epochNs) / 1e3, (zone.endNs - zone.startNs) / 1e3);
+                out << ",\n{\"name\":\"" << Escape(zone.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIndex << "," << timing << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    // Returns false if the file can't be written.
+    bool SaveChromeTrace(const std::string& path);
+
+private:
+    friend class ProfileZone;
+
+    Profiler() : m_epochNs(NowNanoseconds()) {}
+
+    Track& GetThreadTrack()
+    {
+        // the registry owns the buffers, the zones of a thread that exited are still exported. A plain pointer needs no
+        // thread_local initialization guard on the hot path.
+        thread_local Track* threadTrack = nullptr;
+        if (!threadTrack)
+        {
+            auto buffer = std::make_shared<Track>();
+            threadTrack = buffer.get();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tracks.push_back(std::move(buffer));
+        }
+        return *threadTrack;
+    }
+
+    static void Snapshot(const Track& buffer, std::vector<Zone>& zones)
+    {
+        zones.clear();
+        const uint64_t end = buffer.written.load(std::memory_order_acquire);
+        const uint64_t begin = end > ZoneCapacity ? end - ZoneCapacity : 0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const ZoneSlot& slot = buffer.zones[i % ZoneCapacity];
+            Zone zone;
+            zone.name = slot.name.load(std::memory_order_relaxed);
+            zone.startNs = slot.startNs.load(std::memory_order_relaxed);
+            zone.endNs = slot.endNs.load(std::memory_order_relaxed);
+            zone.depth = slot.depth.load(std::memory_order_relaxed);
+            zones.push_back(zone);
+        }
+
+        // the owner kept writing during the copy, drop what may have been overwritten: the zones it completed since, and
+        // the one it may be writing (zone written, in the slot of zone written - ZoneCapacity). The fence pairs with
+        // the one in Record(), a copy that read a newer field sees the write index that came before it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t written = buffer.written.load(std::memory_order_relaxed);
+        const uint64_t firstValid = written + 1 > ZoneCapacity ? written + 1 - ZoneCapacity : 0;
+        if (firstValid > begin)
+        {
+            zones.erase(zones.begin(), zones.begin() + static_cast<size_t>(std::min(firstValid - begin, end - begin)));
+        }
+    }
+
+    static std::string Escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+        }
+        return escaped;
+    }
+
+    const int64_t m_epochNs;
+    std::atomic<bool> m_enabled { true };
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<Track>> m_tracks;
+};
+
+// Times its scope. Use through PROFILE_ZONE.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+    {
+        Profiler& profiler = Profiler::Get();
+        if (profiler.IsEnabled())
+        {
+            m_buffer = &profiler.GetThreadTrack();
+            m_name = name;
+            m_depth = m_buffer->depth++;
+            m_startNs = Profiler::NowNanoseconds();
+        }
+    }
+
+    ~ProfileZone()
+    {
+        if (m_buffer)
+        {
+            const int64_t endNs = Profiler::NowNanoseconds();
+            --m_buffer->depth;
+            Profiler::Record(*m_buffer, m_name, m_startNs, endNs, m_depth);
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler::Track* m_buffer { nullptr };
+    const char* m_name { nullptr };
+    int64_t m_startNs { 0 };
+    uint32_t m_depth { 0 };
+};
+
+inline bool Profiler::SaveChromeTrace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    WriteChromeTrace(file);
+    return static_cast<bool>(file);
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#if CONF_BOOL_ENABLE_PROFILER
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+#define PROFILE_THREAD_NAME(name) Profiler::Get().SetThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+// Cross-queue dependencies. Work on one queue that consumes the results of another (graphics sampling what async compute
+// wrote, anything reading what the copy queue uploaded) records a dependency on the producer's sync point; right before
+// the consumer queue submits, the scheduler turns the pending dependencies into GPU side waits.
+//
+// GPU queues execute in order, so once a queue has waited for a value of another queue every later submission on it is
+// covered as well. Waits that are already covered, on the queue itself, or on points the CPU has seen complete are
+// dropped instead of being sent to the GPU.
+//
+// Platform independent: issuing the actual wait is left to a callback (ID3D12CommandQueue::Wait in the renderer).
+
+#include "FenceTimeline.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+class QueueScheduler
+{
+public:
+    // Make waitingQueue wait on the GPU until point has been reached.
+    using GpuWaitFunction = std::function<void(QueueType waitingQueue, const SyncPoint& point)>;
+
+    struct Stats
+    {
+        uint64_t dependencies { 0 }; // AddDependency() calls
+        uint64_t waitsIssued { 0 };  // GPU waits actually sent
+        uint64_t waitsSkipped { 0 }; // dependencies already satisfied
+    };
+
+    QueueScheduler(QueueTimelines& timelines, GpuWaitFunction gpuWait)
+        : m_timelines(timelines)
+        , m_gpuWait(std::move(gpuWait))
+    {
+    }
+
+    QueueScheduler(const QueueScheduler&) = delete;
+    QueueScheduler& operator=(const QueueScheduler&) = delete;
+
+    // The next submission on queue must not start before point is reached. Thread safe.
+    void AddDependency(QueueType queue, const SyncPoint& point)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.dependencies;
+
+        uint64_t& pending = m_pending[Index(queue)][Index(point.queue)];
+        pending = std::max(pending, point.value);
+    }
+
+    // Issue the GPU waits for every pending dependency of queue. Call right before submitting to queue, from the
+    // thread submitting to it. Returns the number of waits issued.
+    uint32_t Resolve(QueueType queue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        uint32_t issued = 0;
+        for (uint32_t producer = 0; producer < QueueCount; ++producer)
+        {
+            uint64_t& pending = m_pending[Index(queue)][producer];
+            if (pending == 0)
+            {
+                continue;
+            }
+
+            const SyncPoint point { static_cast<QueueType>(producer), pending };
+            pending = 0;
+
+            uint64_t& waited = m_waited[Index(queue)][producer];
+            if (point.queue == queue || point.value <= waited || m_timelines.IsComplete(point))
+            {
+                // in order on the same queue / covered by an earlier wait / already done.
+                ++m_stats.waitsSkipped;
+                continue;
+            }
+
+            m_gpuWait(queue, point);
+            waited = point.value;
+            ++m_stats.waitsIssued;
+            ++issued;
+        }
+        return issued;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    static const uint32_t QueueCount = static_cast<uint32_t>(QueueType::Count);
+
+    static uint32_t Index(QueueType queue) { return static_cast<uint32_t>(queue); }
+
+    QueueTimelines& m_timelines;
+    GpuWaitFunction m_gpuWait;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_pending[QueueCount][QueueCount] = {}; // [waiting queue][producer queue] highest value to wait for at the next submission
+    uint64_t m_waited[QueueCount][QueueCount] = {};  // [waiting queue][producer queue] highest value already waited for on the GPU
+    Stats m_stats;
+};
@@ -0,0 +1,534 @@
+#pragma once
+
+// Render graph: the passes of a frame declare the resources they read and write and the state they need them in, the
+// graph works out everything between them. Compiling
+//  - culls the passes nothing depends on: a pass is kept when it has side effects, writes an imported resource (the
+//    back buffer, anything read outside the graph) or writes a resource a kept pass reads,
+//  - places the transient resources (created by the graph, only alive during it) in a single heap, resources whose
+//    lifetimes don't overlap share memory. Offsets come from a TlsfAllocator walked in pass order: a resource is
+//    allocated before its first pass and freed after its last one, the heap is as large as the high water mark,
+//  - plans the barriers, one batch in front of each pass: aliasing barriers for transient resources taking over memory,
+//    transitions only where the state actually changes, UAV barriers between unordered access passes.
+//
+// Passes run in the order they were added, on one queue. The plan can be executed every frame as is: transient resources
+// go back to the state they were created in before their memory changes hands (in a batch that has to be recorded
+// anyway), and imported resources end in their final state. The content of a transient resource is undefined at its first pass, which must write all of it (clear,
+// discard or copy).
+//
+// Only handles and offsets are managed here, the D3D12 resources, heap and command lists are up to RenderGraph_DX12,
+// so large graphs can be compiled, measured and tested anywhere.
+//
+// Not thread safe.
+//
+// Platform independent.
+
+#include "Device.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class RenderGraph
+{
+public:
+    using ResourceHandle = uint32_t;
+    using PassHandle = uint32_t;
+    static const uint32_t InvalidHandle = ~0u;
+
+    // Placed resources are aligned to at least 64 KB.
+    static const uint64_t PlacementAlignment = 64 * 1024;
+
+    struct Barrier
+    {
+        enum class Type : uint32_t
+        {
+            Transition = 0,
+            Aliasing,        // resource takes over memory last used by resourceBefore
+            UnorderedAccess, // writes of the previous pass visible to the next one
+        };
+
+        Type type { Type::Transition };
+        ResourceHandle resource { InvalidHandle };
+        ResourceHandle resourceBefore { InvalidHandle }; // aliasing only, InvalidHandle when it may be any of the resources sharing the memory
+        ResourceState before { ResourceState::Present };
+        ResourceState after { ResourceState::Present };
+    };
+
+    struct BarrierBatch
+    {
+        uint32_t first { 0 }; // in GetBarriers()
+        uint32_t count { 0 };
+    };
+
+    struct CompiledPass
+    {
+        PassHandle pass { InvalidHandle };
+        BarrierBatch barriers; // recorded right before the pass
+    };
+
+    struct Stats
+    {
+        uint64_t passes { 0 };
+        uint64_t culledPasses { 0 };
+        uint64_t transientResources { 0 }; // used by a pass that isn't culled
+        uint64_t aliasedResources { 0 };   // transient resources sharing memory with another one
+        uint64_t transitionBarriers { 0 };
+        uint64_t aliasingBarriers { 0 };
+        uint64_t unorderedAccessBarriers { 0 };
+        uint64_t barrierBatches { 0 };     // ResourceBarrier calls, empty batches aren't counted
+        uint64_t transientHeapSize { 0 };  // with aliasing
+        uint64_t transientBytes { 0 };     // without aliasing, every transient resource on its own
+    };
+
+    // Forget the passes and resources, the storage is kept for the next frame.
+    void Reset()
+    {
+        m_resources.clear();
+        m_passes.clear();
+        m_accesses.clear();
+        m_compiledPasses.clear();
+        m_barriers.clear();
+        m_finalBarriers = BarrierBatch();
+        m_transientHeapSize = 0;
+        m_stats = Stats();
+        m_compiled = false;
+    }
+
+    // Resource owned outside the graph, in initialState when the graph starts and left in finalState when it ends.
+    ResourceHandle ImportResource(const std::string& name, ResourceState initialState, ResourceState finalState)
+    {
+        Resource resource;
+        resource.name = name;
+        resource.imported = true;
+        resource.initialState = initialState;
+        resource.finalState = finalState;
+        m_resources.push_back(resource);
+        return static_cast<ResourceHandle>(m_resources.size() - 1);
+    }
+
+    // Resource only alive during the graph, size and alignment of its placement (GetResourceAllocationInfo).
+    ResourceHandle CreateTransient(const std::string& name, uint64_t size, uint64_t alignment = PlacementAlignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+        Resource resource;
+        resource.name = name;
+        resource.size = TlsfAllocator::AlignUp(std::max<uint64_t>(size, 1), PlacementAlignment);
+        resource.alignment = alignment > PlacementAlignment ? alignment : PlacementAlignment;
+        m_resources.push_back(resource);
+        return static_cast<ResourceHandle>(m_resources.size() - 1);
+    }
+
+    // Passes run in the order they are added. One with side effects (readback, anything the graph can't see) is never culled.
+    PassHandle AddPass(const std::string& name, bool sideEffects = false)
+    {
+        Pass pass;
+        pass.name = name;
+        pass.sideEffects = sideEffects;
+        pass.firstAccess = static_cast<uint32_t>(m_accesses.size());
+        m_passes.push_back(pass);
+        return static_cast<PassHandle>(m_passes.size() - 1);
+    }
+
+    // Accesses of the pass added last. A pass uses each resource in a single state.
+    void Read(PassHandle pass, ResourceHandle resource, ResourceState state) { AddAccess(pass, resource, state, false); }
+    void Write(PassHandle pass, ResourceHandle resource, ResourceState state) { AddAccess(pass, resource, state, true); }
+
+    void Compile()
+    {
+        const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+        m_compiledPasses.clear();
+        m_barriers.clear();
+        m_stats = Stats();
+
+        Cull();
+
+        // lifetimes, in compiled pass indices.
+        for (auto& resource : m_resources)
+        {
+            resource.firstPass = resource.lastPass = InvalidHandle;
+        }
+        for (const Pass& pass : m_passes)
+        {
+            if (pass.culled)
+            {
+                continue;
+            }
+
+            const uint32_t compiledIndex = static_cast<uint32_t>(m_compiledPasses.size());
+            m_compiledPasses.push_back(CompiledPass{ static_cast<PassHandle>(&pass - m_passes.data()), BarrierBatch() });
+            for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i)
+            {
+                Resource& resource = m_resources[m_accesses[i].resource];
+                if (resource.firstPass == InvalidHandle)
+                {
+                    resource.firstPass = compiledIndex;
+                    resource.initialState = resource.imported ? resource.initialState : m_accesses[i].state;
+                }
+                resource.lastPass = compiledIndex;
+            }
+        }
+
+        PlaceTransients();
+        PlanBarriers(resourceCount);
+
+        m_stats.passes = m_passes.size();
+        m_stats.culledPasses = m_passes.size() - m_compiledPasses.size();
+        m_stats.transientHeapSize = m_transientHeapSize;
+        m_compiled = true;
+    }
+
+    bool IsCompiled() const { return m_compiled; }
+
+    // Passes that survived culling, in execution order.
+    const std::vector<CompiledPass>& GetCompiledPasses() const { return m_compiledPasses; }
+    const std::vector<Barrier>& GetBarriers() const { return m_barriers; }
+    BarrierBatch GetFinalBarriers() const { return m_finalBarriers; } // after the last pass
+
+    uint32_t GetPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+    const std::string& GetPassName(PassHandle pass) const { return m_passes[pass].name; }
+    bool IsCulled(PassHandle pass) const { return m_passes[pass].culled; }
+
+    uint32_t GetResourceCount() const { return static_cast<uint32_t>(m_resources.size()); }
+    const std::string& GetResourceName(ResourceHandle resource) const { return m_resources[resource].name; }
+    bool IsImported(ResourceHandle resource) const { return m_resources[resource].imported; }
+    bool IsUsed(ResourceHandle resource) const { return m_resources[resource].firstPass != InvalidHandle; } // by a pass that isn't culled
+
+    // Transient resources: placement in the heap and state to create them in (the one of their first pass).
+    uint64_t GetTransientOffset(ResourceHandle resource) const { return m_resources[resource].offset; }
+    uint64_t GetTransientSize(ResourceHandle resource) const { return m_resources[resource].size; }
+    ResourceState GetInitialState(ResourceHandle resource) const { return m_resources[resource].initialState; }
+    uint64_t GetTransientHeapSize() const { return m_transientHeapSize; }
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Resource
+    {
+        std::string name;
+        bool imported { false };
+        ResourceState initialState { ResourceState::Present };
+        ResourceState finalState { ResourceState::Present };
+        uint64_t size { 0 };
+        uint64_t alignment { 0 };
+
+        // compiled
+        uint32_t firstPass { InvalidHandle };
+        uint32_t lastPass { InvalidHandle };
+        uint64_t offset { 0 };
+        ResourceHandle aliasedBefore { InvalidHandle }; // previous occupant of the memory, itself when there are several
+        bool aliased { false };                         // shares memory with another resource
+        bool needed { false };                          // culling
+    };
+
+    struct Pass
+    {
+        std::string name;
+        bool sideEffects { false };
+        bool culled { false };
+        uint32_t firstAccess { 0 };
+        uint32_t accessCount { 0 };
+    };
+
+    struct Access
+    {
+        ResourceHandle resource;
+        ResourceState state;
+        bool write;
+    };
+
+    // Memory of the transient heap and the resource that last used it, disjoint ranges keyed by their start.
+    struct Occupant
+    {
+        uint64_t end;
+        ResourceHandle resource;
+    };
+
+    // Offsets only, far larger than any heap: the allocator never runs out, the heap is its high water mark.
+    static const uint64_t VirtualHeapSize = 1ull << 48;
+
+    void AddAccess(PassHandle pass, ResourceHandle resource, ResourceState state, bool write)
+    {
+        assert(pass == m_passes.size() - 1 && "accesses are added to the pass added last");
+        assert(resource < m_resources.size());
+
+        Pass& current = m_passes[pass];
+        for (uint32_t i = current.firstAccess; i < current.firstAccess + current.accessCount; ++i)
+        {
+            if (m_accesses[i].resource == resource)
+            {
+                assert(m_accesses[i].state == state && "a pass uses a resource in a single state");
+                m_accesses[i].write = m_accesses[i].write || write;
+                return;
+            }
+        }
+
+        m_accesses.push_back(Access{ resource, state, write });
+        ++current.accessCount;
+        m_compiled = false;
+    }
+
+    // Walk the passes backwards, a pass is needed when it writes something needed.
+    void Cull()
+    {
+        for (auto& resource : m_resources)
+        {
+            resource.needed = resource.imported;
+        }
+
+        for (size_t index = m_passes.size(); index-- > 0;)
+        {
+            Pass& pass = m_passes[index];
+            bool needed = pass.sideEffects;
+            for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount && !needed; ++i)
+            {
+                needed = m_accesses[i].write && m_resources[m_accesses[i].resource].needed;
+            }
+
+            pass.culled = !needed;
+            if (needed)
+            {
+                for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i)
+                {
+                    m_resources[m_accesses[i].resource].needed = true;
+                }
+            }
+        }
+    }
+
+    void PlaceTransients()
+    {
+        // resources starting and ending at each compiled pass, as linked lists through the scratch arrays.
+        const uint32_t passCount = static_cast<uint32_t>(m_compiledPasses.size());
+        m_firstStarting.assign(passCount, ResourceHandle(InvalidHandle));
+        m_firstEnding.assign(passCount, ResourceHandle(InvalidHandle));
+        m_nextStarting.assign(m_resources.size(), ResourceHandle(InvalidHandle));
+        m_nextEnding.assign(m_resources.size(), ResourceHandle(InvalidHandle));
+        m_handles.assign(m_resources.size(), TlsfAllocator::Handle(TlsfAllocator::InvalidHandle));
+
+        for (ResourceHandle handle = static_cast<ResourceHandle>(m_resources.size()); handle-- > 0;)
+        {
+            Resource& resource = m_resources[handle];
+            resource.offset = 0;
+            resource.aliasedBefore = InvalidHandle;
+            resource.aliased = false;
+            if (resource.imported || resource.firstPass == InvalidHandle)
+            {
+                continue;
+            }
+
+            m_nextStarting[handle] = m_firstStarting[resource.firstPass];
+            m_firstStarting[resource.firstPass] = handle;
+            m_nextEnding[handle] = m_firstEnding[resource.lastPass];
+            m_firstEnding[resource.lastPass] = handle;
+        }
+
+        TlsfAllocator allocator(VirtualHeapSize, PlacementAlignment);
+        m_occupants.clear();
+        m_transientHeapSize = 0;
+
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            for (ResourceHandle handle = m_firstStarting[pass]; handle != InvalidHandle; handle = m_nextStarting[handle])
+            {
+                Resource& resource = m_resources[handle];
+                const TlsfAllocator::Allocation allocation = allocator.Allocate(resource.size, resource.alignment);
+                assert(allocation.IsValid());
+
+                resource.offset = allocation.offset;
+                m_handles[handle] = allocation.handle;
+                m_transientHeapSize = std::max(m_transientHeapSize, allocation.offset + resource.size);
+                Occupy(handle, allocation.offset, allocation.offset + resource.size);
+
+                ++m_stats.transientResources;
+                m_stats.transientBytes += resource.size;
+            }
+
+            for (ResourceHandle handle = m_firstEnding[pass]; handle != InvalidHandle; handle = m_nextEnding[handle])
+            {
+                allocator.Free(m_handles[handle]);
+            }
+        }
+
+        for (const auto& resource : m_resources)
+        {
+            m_stats.aliasedResources += resource.aliased ? 1 : 0;
+        }
+    }
+
+    // Mark [begin, end) as used by handle, remembering which resources used it before.
+    void Occupy(ResourceHandle handle, uint64_t begin, uint64_t end)
+    {
+        Resource& resource = m_resources[handle];
+
+        auto it = m_occupants.upper_bound(begin);
+        if (it != m_occupants.begin() && std::prev(it)->second.end > begin)
+        {
+            --it;
+        }
+
+        while (it != m_occupants.end() && it->first < end)
+        {
+            const uint64_t start = it->first;
+            const Occupant previous = it->second;
+            it = m_occupants.erase(it);
+
+            // what the new resource doesn't cover stays with the previous one.
+            if (start < begin)
+            {
+                m_occupants.emplace(start, Occupant{ begin, previous.resource });
+            }
+            if (previous.end > end)
+            {
+                it = m_occupants.emplace(end, Occupant{ previous.end, previous.resource }).first;
+            }
+
+            resource.aliasedBefore = resource.aliasedBefore == InvalidHandle || resource.aliasedBefore == previous.resource ? previous.resource : handle;
+            resource.aliased = true;
+            m_resources[previous.resource].aliased = true;
+        }
+
+        m_occupants.emplace(begin, Occupant{ end, handle });
+    }
+
+    void PlanBarriers(uint32_t resourceCount)
+    {
+        m_states.resize(resourceCount);
+        m_lastAccessPass.assign(resourceCount, uint32_t(InvalidHandle));
+        m_lastAccessWrite.assign(resourceCount, 0);
+        for (uint32_t i = 0; i < resourceCount; ++i)
+        {
+            m_states[i] = m_resources[i].initialState;
+        }
+
+        // transitions back to the creation state after the last use of transient resources, recorded with the next
+        // aliasing barriers, before any other resource takes over the memory.
+        m_pendingRestores.clear();
+
+        for (uint32_t compiledIndex = 0; compiledIndex < m_compiledPasses.size(); ++compiledIndex)
+        {
+            CompiledPass& compiled = m_compiledPasses[compiledIndex];
+            const Pass& pass = m_passes[compiled.pass];
+            compiled.barriers.first = static_cast<uint32_t>(m_barriers.size());
+
+            // memory changes hands before anything touches the new resources.
+            for (ResourceHandle handle = m_firstStarting[compiledIndex]; handle != InvalidHandle; handle = m_nextStarting[handle])
+            {
+                const Resource& resource = m_resources[handle];
+                if (resource.aliased)
+                {
+                    FlushRestores();
+
+                    // the first resource in a range follows the last one of the previous execution.
+                    Barrier barrier;
+                    barrier.type = Barrier::Type::Aliasing;
+                    barrier.resource = handle;
+                    barrier.resourceBefore = resource.aliasedBefore == handle ? InvalidHandle : resource.aliasedBefore;
+                    m_barriers.push_back(barrier);
+                    ++m_stats.aliasingBarriers;
+                }
+            }
+
+            for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i)
+            {
+                const Access& access = m_accesses[i];
+                ResourceState& state = m_states[access.resource];
+                if (state != access.state)
+                {
+                    Barrier barrier;
+                    barrier.resource = access.resource;
+                    barrier.before = state;
+                    barrier.after = access.state;
+                    m_barriers.push_back(barrier);
+                    ++m_stats.transitionBarriers;
+                    state = access.state;
+                }
+                else if (state == ResourceState::UnorderedAccess && m_lastAccessPass[access.resource] != InvalidHandle &&
+                    (access.write || m_lastAccessWrite[access.resource]))
+                {
+                    Barrier barrier;
+                    barrier.type = Barrier::Type::UnorderedAccess;
+                    barrier.resource = access.resource;
+                    barrier.before = barrier.after = state;
+                    m_barriers.push_back(barrier);
+                    ++m_stats.unorderedAccessBarriers;
+                }
+
+                m_lastAccessPass[access.resource] = compiledIndex;
+                m_lastAccessWrite[access.resource] = access.write ? 1 : 0;
+            }
+
+            compiled.barriers.count = static_cast<uint32_t>(m_barriers.size()) - compiled.barriers.first;
+            m_stats.barrierBatches += compiled.barriers.count > 0 ? 1 : 0;
+
+            for (ResourceHandle handle = m_firstEnding[compiledIndex]; handle != InvalidHandle; handle = m_nextEnding[handle])
+            {
+                if (m_states[handle] != m_resources[handle].initialState)
+                {
+                    m_pendingRestores.push_back(handle);
+                }
+            }
+        }
+
+        m_finalBarriers.first = static_cast<uint32_t>(m_barriers.size());
+        FlushRestores();
+        for (ResourceHandle handle = 0; handle < resourceCount; ++handle)
+        {
+            const Resource& resource = m_resources[handle];
+            if (resource.imported && m_states[handle] != resource.finalState)
+            {
+                Barrier barrier;
+                barrier.resource = handle;
+                barrier.before = m_states[handle];
+                barrier.after = resource.finalState;
+                m_barriers.push_back(barrier);
+                ++m_stats.transitionBarriers;
+                m_states[handle] = resource.finalState;
+            }
+        }
+        m_finalBarriers.count = static_cast<uint32_t>(m_barriers.size()) - m_finalBarriers.first;
+        m_stats.barrierBatches += m_finalBarriers.count > 0 ? 1 : 0;
+    }
+
+    void FlushRestores()
+    {
+        for (ResourceHandle handle : m_pendingRestores)
+        {
+            Barrier barrier;
+            barrier.resource = handle;
+            barrier.before = m_states[handle];
+            barrier.after = m_resources[handle].initialState;
+            m_barriers.push_back(barrier);
+            ++m_stats.transitionBarriers;
+            m_states[handle] = barrier.after;
+        }
+        m_pendingRestores.clear();
+    }
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<Access> m_accesses;
+
+    std::vector<CompiledPass> m_compiledPasses;
+    std::vector<Barrier> m_barriers;
+    BarrierBatch m_finalBarriers;
+    uint64_t m_transientHeapSize { 0 };
+    Stats m_stats;
+    bool m_compiled { false };
+
+    // compilation scratch, kept to avoid reallocating every frame.
+    std::vector<ResourceHandle> m_firstStarting;
+    std::vector<ResourceHandle> m_firstEnding;
+    std::vector<ResourceHandle> m_nextStarting;
+    std::vector<ResourceHandle> m_nextEnding;
+    std::vector<TlsfAllocator::Handle> m_handles;
+    std::map<uint64_t, Occupant> m_occupants;
+    std::vector<ResourceState> m_states;
+    std::vector<uint32_t> m_lastAccessPass;
+    std::vector<uint8_t> m_lastAccessWrite;
+    std::vector<ResourceHandle> m_pendingRestores;
+};
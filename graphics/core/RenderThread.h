@@ -0,0 +1,169 @@
+#pragma once
+
+// Runs the frame loop on its own thread so rendering doesn't share a thread with the window messages. The window thread
+// forwards its events through a lock-free SPSC queue and never waits on the render thread (apart from Stop()).
+// Resizes are coalesced: only the last size posted before a frame is applied, and a resize is never lost even when the
+// queue is full.
+//
+// Platform independent, the window and the renderer are only seen through the callbacks.
+
+#include "Profiler.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+
+struct WindowEvent
+{
+    enum class Type : uint32_t
+    {
+        Resize,
+        KeyDown,
+        KeyUp
+    };
+
+    Type type { Type::Resize };
+    uint32_t width { 0 };
+    uint32_t height { 0 };
+    uint8_t key { 0 };
+
+    static WindowEvent Resize(uint32_t width, uint32_t height) { WindowEvent event; event.type = Type::Resize; event.width = width; event.height = height; return event; }
+    static WindowEvent KeyDown(uint8_t key) { WindowEvent event; event.type = Type::KeyDown; event.key = key; return event; }
+    static WindowEvent KeyUp(uint8_t key) { WindowEvent event; event.type = Type::KeyUp; event.key = key; return event; }
+};
+
+class RenderThread
+{
+public:
+    struct Callbacks
+    {
+        std::function<void(const WindowEvent&)> onEvent; // every event but the coalesced resizes
+        std::function<void(uint32_t width, uint32_t height)> onResize; // at most once per frame, before onFrame
+        std::function<void()> onFrame;
+        std::function<void()> onExit; // the thread is about to exit on its own (onFrame threw), called on the render thread
+    };
+
+    RenderThread() = default;
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    ~RenderThread()
+    {
+        // the owner is expected to Stop() and handle the error itself, a destructor can't rethrow it.
+        try
+        {
+            Stop();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void Start(Callbacks callbacks)
+    {
+        m_callbacks = std::move(callbacks);
+        m_error = nullptr;
+        m_quit.store(false, std::memory_order_release);
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread([this]() { ThreadMain(); });
+    }
+
+    // Ask the render thread to quit after the current frame and join it. Rethrows whatever stopped the thread, if anything.
+    void Stop()
+    {
+        m_quit.store(true, std::memory_order_release);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        m_running.store(false, std::memory_order_release);
+
+        if (m_error)
+        {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // True between Start() and Stop(), even if the thread has already exited on its own: the events keep going to the
+    // render thread (and are ignored) until the owner stops it.
+    bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Producer (window) thread only, never blocks. Returns false if the event had to be dropped because the queue was full,
+    // which can only happen to key events.
+    bool Post(const WindowEvent& event)
+    {
+        if (event.type == WindowEvent::Type::Resize)
+        {
+            m_pendingResize.store(PackSize(event.width, event.height), std::memory_order_release);
+            return true;
+        }
+
+        if (!m_events.TryPush(event))
+        {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t GetFrameCount() const { return m_frameCount.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedEventCount() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+    static const uint64_t NoResize = ~0ull;
+
+    static uint64_t PackSize(uint32_t width, uint32_t height) { return (static_cast<uint64_t>(width) << 32) | height; }
+
+    void ThreadMain()
+    {
+        PROFILE_THREAD_NAME("Render thread");
+        try
+        {
+            while (!m_quit.load(std::memory_order_acquire))
+            {
+                WindowEvent event;
+                while (m_events.TryPop(event))
+                {
+                    if (m_callbacks.onEvent)
+                    {
+                        m_callbacks.onEvent(event);
+                    }
+                }
+
+                const uint64_t resize = m_pendingResize.exchange(NoResize, std::memory_order_acq_rel);
+                if (resize != NoResize && m_callbacks.onResize)
+                {
+                    m_callbacks.onResize(static_cast<uint32_t>(resize >> 32), static_cast<uint32_t>(resize & 0xffffffffu));
+                }
+
+                m_callbacks.onFrame();
+                m_frameCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        catch (...)
+        {
+            m_error = std::current_exception();
+            if (m_callbacks.onExit)
+            {
+                m_callbacks.onExit();
+            }
+        }
+    }
+
+    Callbacks m_callbacks;
+    std::thread m_thread;
+    std::exception_ptr m_error;
+
+    std::atomic<bool> m_running { false };
+    std::atomic<bool> m_quit { false };
+
+    SpscQueue<WindowEvent, 256> m_events;
+    std::atomic<uint64_t> m_pendingResize { NoResize }; // latest size posted, the render thread swaps it out once per frame
+    std::atomic<uint64_t> m_droppedEvents { 0 };
+    std::atomic<uint64_t> m_frameCount { 0 };
+};
@@ -0,0 +1,462 @@
+#pragma once
+
+// Resource states across command lists. Lists recorded in parallel can't know the state a shared resource will be in
+// when they execute, so each list tracks its own view of the states (ResourceStateTracker):
+//  - the first use of a subresource in the list only records the state the list needs it in, the transition from the
+//    real state is resolved against the ResourceStateRegistry when the lists are submitted, in submission order,
+//  - later uses queue transitions from the state the list left the subresource in, a transition queued on top of a
+//    pending one replaces it (and vanishes when it goes back to the original state), nothing is queued when the state
+//    doesn't change,
+//  - pending barriers go out together with Flush(), right before the work that depends on them: one ResourceBarrier call,
+//  - BeginTransition() starts a split barrier, the transition overlaps the work recorded until the next use of the
+//    subresource (or EndTransition()) completes it.
+//
+// Subresources are tracked individually only once a list touches them individually, a resource used as a whole costs a
+// single state.
+//
+// Resources are opaque keys (the ID3D12Resource in the renderer), the conversion to D3D12 barriers is up to
+// ResourceStateTracker_DX12.
+//
+// Platform independent.
+
+#include "Device.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using ResourceKey = const void*;
+static const uint32_t AllSubresources = ~0u; // D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+
+// State of every subresource of a resource, a single one while they all share it.
+class SubresourceStates
+{
+public:
+    SubresourceStates() = default;
+    SubresourceStates(uint32_t count, ResourceState state) : m_count(count), m_state(state) {}
+
+    uint32_t GetCount() const { return m_count; }
+    bool IsUniform() const { return m_uniform; }
+    ResourceState Get(uint32_t subresource) const { return m_uniform ? m_state : m_states[subresource]; }
+
+    void Set(uint32_t subresource, ResourceState state)
+    {
+        if (subresource == AllSubresources)
+        {
+            m_uniform = true;
+            m_state = state;
+            return;
+        }
+
+        assert(subresource < m_count);
+        if (m_uniform)
+        {
+            if (state == m_state)
+            {
+                return;
+            }
+            m_states.assign(m_count, m_state);
+            m_uniform = false;
+        }
+        m_states[subresource] = state;
+    }
+
+private:
+    uint32_t m_count { 1 };
+    bool m_uniform { true };
+    ResourceState m_state { ResourceState::Present };
+    std::vector<ResourceState> m_states; // when not uniform
+};
+
+// Committed states: the state of each registered resource once the lists submitted so far have executed. Thread safe.
+class ResourceStateRegistry
+{
+public:
+    void Register(ResourceKey resource, uint32_t subresourceCount, ResourceState state)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_states[resource] = SubresourceStates(std::max(1u, subresourceCount), state);
+    }
+
+    void Unregister(ResourceKey resource)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_states.erase(resource);
+    }
+
+    bool IsRegistered(ResourceKey resource) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_states.find(resource) != m_states.end();
+    }
+
+    uint32_t GetSubresourceCount(ResourceKey resource) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_states.find(resource);
+        return it != m_states.end() ? it->second.GetCount() : 1;
+    }
+
+    ResourceState GetState(ResourceKey resource, uint32_t subresource = 0) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_states.find(resource);
+        assert(it != m_states.end() && "resource not registered");
+        return it != m_states.end() ? it->second.Get(subresource) : ResourceState::Present;
+    }
+
+private:
+    friend class ResourceStateTracker;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<ResourceKey, SubresourceStates> m_states;
+};
+
+// States of the resources used by one command list. Not thread safe: one tracker per list being recorded.
+class ResourceStateTracker
+{
+public:
+    struct Barrier
+    {
+        enum class Type : uint32_t
+        {
+            Transition = 0,
+            UnorderedAccess,
+        };
+
+        enum class Split : uint32_t
+        {
+            None = 0,
+            Begin, // the transition starts, the subresource can't be used until the matching End
+            End,
+        };
+
+        Type type { Type::Transition };
+        Split split { Split::None };
+        ResourceKey resource { nullptr };
+        uint32_t subresource { AllSubresources };
+        ResourceState before { ResourceState::Present };
+        ResourceState after { ResourceState::Present };
+    };
+
+    struct Stats
+    {
+        uint64_t transitions { 0 };        // requested
+        uint64_t barriers { 0 };           // flushed
+        uint64_t mergedBarriers { 0 };     // replaced or dropped before being flushed
+        uint64_t flushes { 0 };            // with at least one barrier
+        uint64_t resolvedBarriers { 0 };   // fixups at submission
+    };
+
+    explicit ResourceStateTracker(const ResourceStateRegistry& registry) : m_registry(registry) {}
+
+    ResourceStateTracker(const ResourceStateTracker&) = delete;
+    ResourceStateTracker& operator=(const ResourceStateTracker&) = delete;
+
+    // Start a new command list.
+    void Reset()
+    {
+        m_lookup.clear();
+        m_tracked.clear();
+        m_pending.clear();
+        m_splits.clear();
+    }
+
+    // resource (or one of its subresources) is about to be used in state.
+    void Transition(ResourceKey resource, ResourceState state, uint32_t subresource = AllSubresources)
+    {
+        ++m_stats.transitions;
+        Tracked& tracked = Track(resource);
+        EndSplits(resource, subresource, state);
+
+        if (subresource != AllSubresources)
+        {
+            TransitionSubresource(tracked, resource, subresource, state);
+            return;
+        }
+
+        if (tracked.current.IsUniform())
+        {
+            const ResourceState current = tracked.current.Get(0);
+            if (current == UnknownState)
+            {
+                tracked.first.Set(AllSubresources, state);
+            }
+            else if (current != state)
+            {
+                QueueTransition(resource, AllSubresources, current, state);
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < tracked.current.GetCount(); ++i)
+            {
+                TransitionSubresource(tracked, resource, i, state);
+            }
+        }
+        tracked.current.Set(AllSubresources, state);
+    }
+
+    // Start the transition to state now, the next use of the subresource (or EndTransition()) completes it. The subresource
+    // must not be used in between. Falls back to waiting for the submission when the list doesn't know the state yet.
+    void BeginTransition(ResourceKey resource, ResourceState state, uint32_t subresource = AllSubresources)
+    {
+        Tracked& tracked = Track(resource);
+        EndSplits(resource, subresource, state);
+
+        const bool known = subresource == AllSubresources ? tracked.current.IsUniform() && tracked.current.Get(0) != UnknownState
+                                                          : tracked.current.Get(subresource) != UnknownState;
+        const ResourceState current = known ? tracked.current.Get(subresource == AllSubresources ? 0 : subresource) : UnknownState;
+        if (!known || current == state)
+        {
+            Transition(resource, state, subresource);
+            return;
+        }
+
+        ++m_stats.transitions;
+        Barrier barrier;
+        barrier.split = Barrier::Split::Begin;
+        barrier.resource = resource;
+        barrier.subresource = subresource;
+        barrier.before = current;
+        barrier.after = state;
+        m_pending.push_back(barrier);
+        m_splits.push_back(barrier);
+        tracked.current.Set(subresource, state);
+    }
+
+    // Complete a split transition started by BeginTransition().
+    void EndTransition(ResourceKey resource, uint32_t subresource = AllSubresources)
+    {
+        for (size_t i = 0; i < m_splits.size(); ++i)
+        {
+            if (m_splits[i].resource == resource && m_splits[i].subresource == subresource)
+            {
+                QueueEnd(i);
+                return;
+            }
+        }
+        assert(false && "no split transition to end");
+    }
+
+    // Writes to resource in unordered access must be visible to the next use.
+    void UnorderedAccessBarrier(ResourceKey resource)
+    {
+        for (const Barrier& pending : m_pending)
+        {
+            if (pending.type == Barrier::Type::UnorderedAccess && pending.resource == resource)
+            {
+                ++m_stats.mergedBarriers;
+                return;
+            }
+        }
+
+        Barrier barrier;
+        barrier.type = Barrier::Type::UnorderedAccess;
+        barrier.resource = resource;
+        barrier.before = barrier.after = ResourceState::UnorderedAccess;
+        m_pending.push_back(barrier);
+    }
+
+    // Barriers queued since the last flush, appended to barriers. Record them right before the work that needs them.
+    size_t Flush(std::vector<Barrier>& barriers)
+    {
+        const size_t count = m_pending.size();
+        barriers.insert(barriers.end(), m_pending.begin(), m_pending.end());
+        m_pending.clear();
+
+        m_stats.barriers += count;
+        m_stats.flushes += count > 0 ? 1 : 0;
+        return count;
+    }
+
+    bool HasPendingBarriers() const { return !m_pending.empty(); }
+
+    // The list is being submitted after every list resolved before it: append the transitions from the committed states
+    // to the states the list expects at its start to fixups (they execute right before the list), then commit the
+    // states the list leaves its resources in. Every barrier must have been flushed and every split transition ended.
+    size_t Resolve(ResourceStateRegistry& registry, std::vector<Barrier>& fixups)
+    {
+        assert(m_pending.empty() && "flush the barriers before closing the list");
+        assert(m_splits.empty() && "end the split transitions before closing the list");
+
+        const size_t firstFixup = fixups.size();
+        std::lock_guard<std::mutex> lock(registry.m_mutex);
+        for (const Tracked& tracked : m_tracked)
+        {
+            auto it = registry.m_states.find(tracked.resource);
+            assert(it != registry.m_states.end() && "resource not registered");
+            if (it == registry.m_states.end())
+            {
+                continue;
+            }
+            SubresourceStates& committed = it->second;
+
+            if (tracked.first.IsUniform() && committed.IsUniform())
+            {
+                const ResourceState first = tracked.first.Get(0);
+                if (first != UnknownState && first != committed.Get(0))
+                {
+                    fixups.push_back(MakeTransition(tracked.resource, AllSubresources, committed.Get(0), first));
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < tracked.first.GetCount(); ++i)
+                {
+                    const ResourceState first = tracked.first.Get(i);
+                    if (first != UnknownState && first != committed.Get(i))
+                    {
+                        fixups.push_back(MakeTransition(tracked.resource, i, committed.Get(i), first));
+                    }
+                }
+            }
+
+            if (tracked.current.IsUniform())
+            {
+                if (tracked.current.Get(0) != UnknownState)
+                {
+                    committed.Set(AllSubresources, tracked.current.Get(0));
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < tracked.current.GetCount(); ++i)
+                {
+                    if (tracked.current.Get(i) != UnknownState)
+                    {
+                        committed.Set(i, tracked.current.Get(i));
+                    }
+                }
+            }
+        }
+
+        m_stats.resolvedBarriers += fixups.size() - firstFixup;
+        return fixups.size() - firstFixup;
+    }
+
+    // State the list leaves the subresource in so far, false when the list hasn't used it.
+    bool GetCurrentState(ResourceKey resource, uint32_t subresource, ResourceState& state) const
+    {
+        const auto it = m_lookup.find(resource);
+        if (it == m_lookup.end())
+        {
+            return false;
+        }
+        state = m_tracked[it->second].current.Get(subresource == AllSubresources ? 0 : subresource);
+        return state != UnknownState;
+    }
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    // Not used by the list yet.
+    static const ResourceState UnknownState = static_cast<ResourceState>(~0u);
+
+    struct Tracked
+    {
+        ResourceKey resource;
+        SubresourceStates first;   // state the list needs at its start, resolved at submission
+        SubresourceStates current; // state the list leaves it in
+    };
+
+    Tracked& Track(ResourceKey resource)
+    {
+        const auto it = m_lookup.find(resource);
+        if (it != m_lookup.end())
+        {
+            return m_tracked[it->second];
+        }
+
+        const uint32_t count = m_registry.GetSubresourceCount(resource);
+        m_lookup.emplace(resource, static_cast<uint32_t>(m_tracked.size()));
+        m_tracked.push_back(Tracked{ resource, SubresourceStates(count, UnknownState), SubresourceStates(count, UnknownState) });
+        return m_tracked.back();
+    }
+
+    void TransitionSubresource(Tracked& tracked, ResourceKey resource, uint32_t subresource, ResourceState state)
+    {
+        const ResourceState current = tracked.current.Get(subresource);
+        if (current == UnknownState)
+        {
+            tracked.first.Set(subresource, state);
+        }
+        else if (current != state)
+        {
+            QueueTransition(resource, subresource, current, state);
+        }
+        tracked.current.Set(subresource, state);
+    }
+
+    static Barrier MakeTransition(ResourceKey resource, uint32_t subresource, ResourceState before, ResourceState after)
+    {
+        Barrier barrier;
+        barrier.resource = resource;
+        barrier.subresource = subresource;
+        barrier.before = before;
+        barrier.after = after;
+        return barrier;
+    }
+
+    // A transition already pending for the same subresource is replaced: A->B then B->C is A->C, A->B then B->A is nothing.
+    void QueueTransition(ResourceKey resource, uint32_t subresource, ResourceState before, ResourceState after)
+    {
+        for (size_t i = m_pending.size(); i-- > 0;)
+        {
+            Barrier& pending = m_pending[i];
+            if (pending.resource != resource)
+            {
+                continue;
+            }
+            if (pending.type != Barrier::Type::Transition || pending.split != Barrier::Split::None || pending.subresource != subresource)
+            {
+                break; // ordered after something else on the resource, can't be merged
+            }
+
+            assert(pending.after == before);
+            ++m_stats.mergedBarriers;
+            if (pending.before == after)
+            {
+                m_pending.erase(m_pending.begin() + i);
+            }
+            else
+            {
+                pending.after = after;
+            }
+            return;
+        }
+
+        m_pending.push_back(MakeTransition(resource, subresource, before, after));
+    }
+
+    // Complete the split transitions the use of subresource in state depends on.
+    void EndSplits(ResourceKey resource, uint32_t subresource, ResourceState /*state*/)
+    {
+        for (size_t i = m_splits.size(); i-- > 0;)
+        {
+            const Barrier& split = m_splits[i];
+            if (split.resource == resource && (subresource == AllSubresources || split.subresource == AllSubresources || split.subresource == subresource))
+            {
+                QueueEnd(i);
+            }
+        }
+    }
+
+    void QueueEnd(size_t splitIndex)
+    {
+        Barrier end = m_splits[splitIndex];
+        end.split = Barrier::Split::End;
+        m_pending.push_back(end);
+        m_splits.erase(m_splits.begin() + splitIndex);
+    }
+
+    const ResourceStateRegistry& m_registry;
+    std::unordered_map<ResourceKey, uint32_t> m_lookup; // index in m_tracked
+    std::vector<Tracked> m_tracked;
+    std::vector<Barrier> m_pending;
+    std::vector<Barrier> m_splits; // begun, not ended yet
+    Stats m_stats;
+};
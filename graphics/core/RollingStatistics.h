@@ -0,0 +1,87 @@
+#pragma once
+
+// Statistics over the last WindowSize samples of a series (frame times, pass durations...): average, extremes and
+// percentiles. Adding a sample is O(1), the summary sorts a copy of the window.
+//
+// Platform independent.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class RollingStatistics
+{
+public:
+    struct Summary
+    {
+        uint64_t samples { 0 }; // added since the start, the summary covers the last window of them
+        double average { 0.0 };
+        double min { 0.0 };
+        double max { 0.0 };
+        double p50 { 0.0 };
+        double p95 { 0.0 };
+        double p99 { 0.0 };
+    };
+
+    explicit RollingStatistics(uint32_t windowSize = 256)
+        : m_window(std::max(1u, windowSize))
+    {
+    }
+
+    void Add(double sample)
+    {
+        m_window[m_samples % m_window.size()] = sample;
+        ++m_samples;
+    }
+
+    void Clear() { m_samples = 0; }
+
+    uint64_t GetSampleCount() const { return m_samples; }
+    double GetLast() const { return m_samples > 0 ? m_window[(m_samples - 1) % m_window.size()] : 0.0; }
+
+    Summary Summarize() const
+    {
+        Summary summary;
+        summary.samples = m_samples;
+
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(m_samples, m_window.size()));
+        if (count == 0)
+        {
+            return summary;
+        }
+
+        std::vector<double> sorted(m_window.begin(), m_window.begin() + count);
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (double sample : sorted)
+        {
+            sum += sample;
+        }
+
+        summary.average = sum / count;
+        summary.min = sorted.front();
+        summary.max = sorted.back();
+        summary.p50 = Percentile(sorted, 0.50);
+        summary.p95 = Percentile(sorted, 0.95);
+        summary.p99 = Percentile(sorted, 0.99);
+        return summary;
+    }
+
+    // Nearest rank percentile of sorted samples, fraction in [0, 1].
+    static double Percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        const double rank = std::ceil(fraction * sorted.size());
+        const size_t index = static_cast<size_t>(std::max(1.0, rank)) - 1;
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+private:
+    std::vector<double> m_window;
+    uint64_t m_samples { 0 };
+};
@@ -0,0 +1,386 @@
+#pragma once
+
+// Structural key and version downgrade of D3D12 root signature descriptions, for RootSignatureCache_DX12.
+//  - RootSignatureKey flattens a D3D12_VERSIONED_ROOT_SIGNATURE_DESC into a stream of 32 bit words: everything that
+//    makes two signatures different (parameters, ranges, static samplers, flags), nothing that doesn't (the addresses
+//    of the arrays). Two descriptions build the same key exactly when they describe the same signature, the hash of
+//    the key picks the bucket and the key itself settles collisions.
+//  - RootSignatureDowngrade turns a 1.1 description into the 1.0 one for devices without 1.1 support, like
+//    D3DX12SerializeVersionedRootSignature but in storage owned by the object and reused, instead of a heap allocation
+//    per parameter array and descriptor range each time.
+//
+// Only the root signature structures of d3d12.h are used. They are declared below when d3d12.h isn't available, with
+// the same names, values and layout, so the code can be built and tested anywhere.
+//
+// Platform independent.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#else
+typedef uint32_t UINT;
+typedef float FLOAT;
+
+enum D3D_ROOT_SIGNATURE_VERSION { D3D_ROOT_SIGNATURE_VERSION_1 = 0x1, D3D_ROOT_SIGNATURE_VERSION_1_0 = 0x1, D3D_ROOT_SIGNATURE_VERSION_1_1 = 0x2 };
+enum D3D12_ROOT_PARAMETER_TYPE
+{
+    D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE = 0,
+    D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS,
+    D3D12_ROOT_PARAMETER_TYPE_CBV,
+    D3D12_ROOT_PARAMETER_TYPE_SRV,
+    D3D12_ROOT_PARAMETER_TYPE_UAV,
+};
+enum D3D12_SHADER_VISIBILITY { D3D12_SHADER_VISIBILITY_ALL = 0, D3D12_SHADER_VISIBILITY_PIXEL = 5 };
+enum D3D12_DESCRIPTOR_RANGE_TYPE { D3D12_DESCRIPTOR_RANGE_TYPE_SRV = 0, D3D12_DESCRIPTOR_RANGE_TYPE_UAV, D3D12_DESCRIPTOR_RANGE_TYPE_CBV, D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER };
+enum D3D12_DESCRIPTOR_RANGE_FLAGS : int { D3D12_DESCRIPTOR_RANGE_FLAG_NONE = 0 };
+enum D3D12_ROOT_DESCRIPTOR_FLAGS : int { D3D12_ROOT_DESCRIPTOR_FLAG_NONE = 0 };
+enum D3D12_ROOT_SIGNATURE_FLAGS : int { D3D12_ROOT_SIGNATURE_FLAG_NONE = 0 };
+enum D3D12_FILTER { D3D12_FILTER_MIN_MAG_MIP_POINT = 0 };
+enum D3D12_TEXTURE_ADDRESS_MODE { D3D12_TEXTURE_ADDRESS_MODE_WRAP = 1 };
+enum D3D12_COMPARISON_FUNC { D3D12_COMPARISON_FUNC_NEVER = 1 };
+enum D3D12_STATIC_BORDER_COLOR { D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK = 0 };
+
+struct D3D12_DESCRIPTOR_RANGE
+{
+    D3D12_DESCRIPTOR_RANGE_TYPE RangeType;
+    UINT NumDescriptors;
+    UINT BaseShaderRegister;
+    UINT RegisterSpace;
+    UINT OffsetInDescriptorsFromTableStart;
+};
+
+struct D3D12_DESCRIPTOR_RANGE1
+{
+    D3D12_DESCRIPTOR_RANGE_TYPE RangeType;
+    UINT NumDescriptors;
+    UINT BaseShaderRegister;
+    UINT RegisterSpace;
+    D3D12_DESCRIPTOR_RANGE_FLAGS Flags;
+    UINT OffsetInDescriptorsFromTableStart;
+};
+
+struct D3D12_ROOT_DESCRIPTOR_TABLE { UINT NumDescriptorRanges; const D3D12_DESCRIPTOR_RANGE* pDescriptorRanges; };
+struct D3D12_ROOT_DESCRIPTOR_TABLE1 { UINT NumDescriptorRanges; const D3D12_DESCRIPTOR_RANGE1* pDescriptorRanges; };
+struct D3D12_ROOT_CONSTANTS { UINT ShaderRegister; UINT RegisterSpace; UINT Num32BitValues; };
+struct D3D12_ROOT_DESCRIPTOR { UINT ShaderRegister; UINT RegisterSpace; };
+struct D3D12_ROOT_DESCRIPTOR1 { UINT ShaderRegister; UINT RegisterSpace; D3D12_ROOT_DESCRIPTOR_FLAGS Flags; };
+
+struct D3D12_ROOT_PARAMETER
+{
+    D3D12_ROOT_PARAMETER_TYPE ParameterType;
+    union
+    {
+        D3D12_ROOT_DESCRIPTOR_TABLE DescriptorTable;
+        D3D12_ROOT_CONSTANTS Constants;
+        D3D12_ROOT_DESCRIPTOR Descriptor;
+    };
+    D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_ROOT_PARAMETER1
+{
+    D3D12_ROOT_PARAMETER_TYPE ParameterType;
+    union
+    {
+        D3D12_ROOT_DESCRIPTOR_TABLE1 DescriptorTable;
+        D3D12_ROOT_CONSTANTS Constants;
+        D3D12_ROOT_DESCRIPTOR1 Descriptor;
+    };
+    D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_STATIC_SAMPLER_DESC
+{
+    D3D12_FILTER Filter;
+    D3D12_TEXTURE_ADDRESS_MODE AddressU;
+    D3D12_TEXTURE_ADDRESS_MODE AddressV;
+    D3D12_TEXTURE_ADDRESS_MODE AddressW;
+    FLOAT MipLODBias;
+    UINT MaxAnisotropy;
+    D3D12_COMPARISON_FUNC ComparisonFunc;
+    D3D12_STATIC_BORDER_COLOR BorderColor;
+    FLOAT MinLOD;
+    FLOAT MaxLOD;
+    UINT ShaderRegister;
+    UINT RegisterSpace;
+    D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_ROOT_SIGNATURE_DESC
+{
+    UINT NumParameters;
+    const D3D12_ROOT_PARAMETER* pParameters;
+    UINT NumStaticSamplers;
+    const D3D12_STATIC_SAMPLER_DESC* pStaticSamplers;
+    D3D12_ROOT_SIGNATURE_FLAGS Flags;
+};
+
+struct D3D12_ROOT_SIGNATURE_DESC1
+{
+    UINT NumParameters;
+    const D3D12_ROOT_PARAMETER1* pParameters;
+    UINT NumStaticSamplers;
+    const D3D12_STATIC_SAMPLER_DESC* pStaticSamplers;
+    D3D12_ROOT_SIGNATURE_FLAGS Flags;
+};
+
+struct D3D12_VERSIONED_ROOT_SIGNATURE_DESC
+{
+    D3D_ROOT_SIGNATURE_VERSION Version;
+    union
+    {
+        D3D12_ROOT_SIGNATURE_DESC Desc_1_0;
+        D3D12_ROOT_SIGNATURE_DESC1 Desc_1_1;
+    };
+};
+#endif
+
+class RootSignatureKey
+{
+public:
+    // Replace the key with the one of desc, serialized as targetVersion (part of the key: the same description gives a
+    // different blob for each version). The storage is kept from one build to the next.
+    void Build(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, D3D_ROOT_SIGNATURE_VERSION targetVersion)
+    {
+        m_words.clear();
+        Add(targetVersion);
+        Add(desc.Version);
+
+        if (desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0)
+        {
+            const D3D12_ROOT_SIGNATURE_DESC& desc10 = desc.Desc_1_0;
+            AddHeader(desc10.NumParameters, desc10.NumStaticSamplers, desc10.Flags);
+            for (UINT i = 0; i < desc10.NumParameters; ++i)
+            {
+                const D3D12_ROOT_PARAMETER& parameter = desc10.pParameters[i];
+                Add(parameter.ParameterType);
+                Add(parameter.ShaderVisibility);
+                if (parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+                {
+                    Add(parameter.DescriptorTable.NumDescriptorRanges);
+                    for (UINT r = 0; r < parameter.DescriptorTable.NumDescriptorRanges; ++r)
+                    {
+                        const D3D12_DESCRIPTOR_RANGE& range = parameter.DescriptorTable.pDescriptorRanges[r];
+                        AddRange(range.RangeType, range.NumDescriptors, range.BaseShaderRegister, range.RegisterSpace, 0, range.OffsetInDescriptorsFromTableStart);
+                    }
+                }
+                else if (parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+                {
+                    AddConstants(parameter.Constants);
+                }
+                else
+                {
+                    Add(parameter.Descriptor.ShaderRegister);
+                    Add(parameter.Descriptor.RegisterSpace);
+                }
+            }
+            AddStaticSamplers(desc10.NumStaticSamplers, desc10.pStaticSamplers);
+        }
+        else
+        {
+            const D3D12_ROOT_SIGNATURE_DESC1& desc11 = desc.Desc_1_1;
+            AddHeader(desc11.NumParameters, desc11.NumStaticSamplers, desc11.Flags);
+            for (UINT i = 0; i < desc11.NumParameters; ++i)
+            {
+                const D3D12_ROOT_PARAMETER1& parameter = desc11.pParameters[i];
+                Add(parameter.ParameterType);
+                Add(parameter.ShaderVisibility);
+                if (parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+                {
+                    Add(parameter.DescriptorTable.NumDescriptorRanges);
+                    for (UINT r = 0; r < parameter.DescriptorTable.NumDescriptorRanges; ++r)
+                    {
+                        const D3D12_DESCRIPTOR_RANGE1& range = parameter.DescriptorTable.pDescriptorRanges[r];
+                        AddRange(range.RangeType, range.NumDescriptors, range.BaseShaderRegister, range.RegisterSpace, range.Flags, range.OffsetInDescriptorsFromTableStart);
+                    }
+                }
+                else if (parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+                {
+                    AddConstants(parameter.Constants);
+                }
+                else
+                {
+                    Add(parameter.Descriptor.ShaderRegister);
+                    Add(parameter.Descriptor.RegisterSpace);
+                    Add(parameter.Descriptor.Flags);
+                }
+            }
+            AddStaticSamplers(desc11.NumStaticSamplers, desc11.pStaticSamplers);
+        }
+
+        m_hash = Hash(m_words.data(), m_words.size());
+    }
+
+    uint64_t GetHash() const { return m_hash; }
+    const std::vector<uint32_t>& GetWords() const { return m_words; }
+
+    bool operator==(const RootSignatureKey& other) const { return m_hash == other.m_hash && m_words == other.m_words; }
+    bool operator!=(const RootSignatureKey& other) const { return !(*this == other); }
+
+    // FNV-1a, 64 bits.
+    static uint64_t Hash(const uint32_t* words, size_t count)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (uint32_t byte = 0; byte < 4; ++byte)
+            {
+                hash ^= (words[i] >> (byte * 8)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+private:
+    template <class Value>
+    void Add(Value value) { m_words.push_back(static_cast<uint32_t>(value)); }
+
+    void Add(FLOAT value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        m_words.push_back(bits);
+    }
+
+    template <class Flags>
+    void AddHeader(UINT parameterCount, UINT staticSamplerCount, Flags flags)
+    {
+        Add(parameterCount);
+        Add(staticSamplerCount);
+        Add(flags);
+    }
+
+    template <class Type, class Flags>
+    void AddRange(Type type, UINT count, UINT baseRegister, UINT space, Flags flags, UINT offset)
+    {
+        Add(type);
+        Add(count);
+        Add(baseRegister);
+        Add(space);
+        Add(flags);
+        Add(offset);
+    }
+
+    void AddConstants(const D3D12_ROOT_CONSTANTS& constants)
+    {
+        Add(constants.ShaderRegister);
+        Add(constants.RegisterSpace);
+        Add(constants.Num32BitValues);
+    }
+
+    void AddStaticSamplers(UINT count, const D3D12_STATIC_SAMPLER_DESC* samplers)
+    {
+        for (UINT i = 0; i < count; ++i)
+        {
+            const D3D12_STATIC_SAMPLER_DESC& sampler = samplers[i];
+            Add(sampler.Filter);
+            Add(sampler.AddressU);
+            Add(sampler.AddressV);
+            Add(sampler.AddressW);
+            Add(sampler.MipLODBias);
+            Add(sampler.MaxAnisotropy);
+            Add(sampler.ComparisonFunc);
+            Add(sampler.BorderColor);
+            Add(sampler.MinLOD);
+            Add(sampler.MaxLOD);
+            Add(sampler.ShaderRegister);
+            Add(sampler.RegisterSpace);
+            Add(sampler.ShaderVisibility);
+        }
+    }
+
+    std::vector<uint32_t> m_words;
+    uint64_t m_hash { 0 };
+};
+
+class RootSignatureDowngrade
+{
+public:
+    // A root signature is at most 64 DWORDs and every parameter costs at least one.
+    static const UINT MaxParameters = 64;
+    // Ranges stored inline, more only happens with unusual tables and goes to a vector kept for the next conversions.
+    static const UINT InlineRanges = 256;
+
+    RootSignatureDowngrade() = default;
+    RootSignatureDowngrade(const RootSignatureDowngrade&) = delete;
+    RootSignatureDowngrade& operator=(const RootSignatureDowngrade&) = delete;
+
+    // The 1.0 description of desc, valid until the next call. The 1.1 range and root descriptor flags have no 1.0
+    // equivalent and are dropped (1.0 assumes volatile descriptors and static data). Null when desc has too many parameters.
+    const D3D12_ROOT_SIGNATURE_DESC* Convert(const D3D12_ROOT_SIGNATURE_DESC1& desc)
+    {
+        if (desc.NumParameters > MaxParameters)
+        {
+            return nullptr;
+        }
+
+        UINT rangeCount = 0;
+        for (UINT i = 0; i < desc.NumParameters; ++i)
+        {
+            if (desc.pParameters[i].ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+            {
+                rangeCount += desc.pParameters[i].DescriptorTable.NumDescriptorRanges;
+            }
+        }
+
+        D3D12_DESCRIPTOR_RANGE* ranges = m_inlineRanges;
+        if (rangeCount > InlineRanges)
+        {
+            m_overflowRanges.resize(rangeCount);
+            ranges = m_overflowRanges.data();
+        }
+
+        for (UINT i = 0; i < desc.NumParameters; ++i)
+        {
+            const D3D12_ROOT_PARAMETER1& source = desc.pParameters[i];
+            D3D12_ROOT_PARAMETER& parameter = m_parameters[i];
+            memset(&parameter, 0, sizeof(parameter));
+            parameter.ParameterType = source.ParameterType;
+            parameter.ShaderVisibility = source.ShaderVisibility;
+
+            switch (source.ParameterType)
+            {
+            case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+                parameter.DescriptorTable.NumDescriptorRanges = source.DescriptorTable.NumDescriptorRanges;
+                parameter.DescriptorTable.pDescriptorRanges = ranges;
+                for (UINT r = 0; r < source.DescriptorTable.NumDescriptorRanges; ++r)
+                {
+                    const D3D12_DESCRIPTOR_RANGE1& range = source.DescriptorTable.pDescriptorRanges[r];
+                    ranges->RangeType = range.RangeType;
+                    ranges->NumDescriptors = range.NumDescriptors;
+                    ranges->BaseShaderRegister = range.BaseShaderRegister;
+                    ranges->RegisterSpace = range.RegisterSpace;
+                    ranges->OffsetInDescriptorsFromTableStart = range.OffsetInDescriptorsFromTableStart;
+                    ++ranges;
+                }
+                break;
+
+            case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+                parameter.Constants = source.Constants;
+                break;
+
+            default:
+                parameter.Descriptor.ShaderRegister = source.Descriptor.ShaderRegister;
+                parameter.Descriptor.RegisterSpace = source.Descriptor.RegisterSpace;
+                break;
+            }
+        }
+
+        m_desc.NumParameters = desc.NumParameters;
+        m_desc.pParameters = desc.NumParameters > 0 ? m_parameters : nullptr;
+        m_desc.NumStaticSamplers = desc.NumStaticSamplers;
+        m_desc.pStaticSamplers = desc.pStaticSamplers;
+        m_desc.Flags = desc.Flags;
+        return &m_desc;
+    }
+
+private:
+    D3D12_ROOT_SIGNATURE_DESC m_desc {};
+    D3D12_ROOT_PARAMETER m_parameters[MaxParameters];
+    D3D12_DESCRIPTOR_RANGE m_inlineRanges[InlineRanges];
+    std::vector<D3D12_DESCRIPTOR_RANGE> m_overflowRanges;
+};
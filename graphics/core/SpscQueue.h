@@ -0,0 +1,78 @@
+#pragma once
+
+// Bounded lock-free single producer / single consumer ring buffer. One thread pushes, one other thread pops, neither
+// ever blocks: TryPush() fails when the ring is full, TryPop() when it is empty.
+//
+// Platform independent.
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+template <class T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only.
+    bool TryPush(const T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == Capacity)
+        {
+            // looks full, refresh the consumer position (the only place the producer touches the consumer's cache line).
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == Capacity)
+            {
+                return false;
+            }
+        }
+
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only.
+    bool TryPop(T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+            {
+                return false;
+            }
+        }
+
+        item = std::move(m_items[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only a hint when called while the other side is running.
+    size_t GetSizeApprox() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    static const size_t CacheLineSize = 64;
+
+    // producer and consumer state on separate cache lines, each side only reads the other's index when it has to.
+    alignas(CacheLineSize) std::atomic<size_t> m_tail { 0 };
+    size_t m_cachedHead { 0 };
+
+    alignas(CacheLineSize) std::atomic<size_t> m_head { 0 };
+    size_t m_cachedTail { 0 };
+
+    alignas(CacheLineSize) T m_items[Capacity];
+};
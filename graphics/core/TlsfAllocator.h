@@ -0,0 +1,535 @@
+#pragma once
+
+// Two level segregated fit allocator over a range of size bytes (the placed resources of an ID3D12Heap in
+// HeapAllocator_DX12). Only offsets are handed out, the memory itself isn't touched, so the algorithm can be run,
+// fuzzed and benchmarked anywhere.
+//
+// Free blocks are binned by size in FirstLevelCount x SecondLevelCount lists: the first level is the power of two of the
+// size, the second splits each power of two linearly. Two bitmaps find the first non empty list that fits in O(1),
+// allocating splits the block found and freeing merges with the physical neighbours, both O(1). Every offset and size
+// is a multiple of granularity (64 KB for heaps, the placement alignment of buffers and most textures), larger
+// alignments (4 MB for MSAA textures) are served by splitting the gap in front of the allocation into a free block.
+//
+// Not thread safe.
+//
+// Platform independent.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class TlsfAllocator
+{
+public:
+    using Handle = uint32_t;
+    static const Handle InvalidHandle = ~0u;
+
+    struct Allocation
+    {
+        uint64_t offset { 0 };
+        uint64_t size { 0 }; // rounded up to the granularity
+        Handle handle { InvalidHandle };
+
+        bool IsValid() const { return handle != InvalidHandle; }
+    };
+
+    struct Stats
+    {
+        uint64_t size { 0 };
+        uint64_t usedBytes { 0 };
+        uint64_t freeBytes { 0 };
+        uint64_t largestFreeBlock { 0 };
+        uint64_t allocations { 0 };
+        uint64_t freeBlocks { 0 };
+        double utilization { 0.0 };   // usedBytes / size
+        double fragmentation { 0.0 }; // 1 - largestFreeBlock / freeBytes: 0 when the free space is contiguous
+    };
+
+    // granularity must be a power of two, size a multiple of it.
+    explicit TlsfAllocator(uint64_t size, uint64_t granularity = 1)
+        : m_size(size)
+        , m_granularity(granularity)
+    {
+        assert(granularity > 0 && (granularity & (granularity - 1)) == 0 && "granularity must be a power of two");
+        assert(size % granularity == 0 && "size must be a multiple of the granularity");
+
+        for (auto& heads : m_freeHeads)
+        {
+            for (auto& head : heads)
+            {
+                head = Null;
+            }
+        }
+
+        if (size > 0)
+        {
+            const uint32_t block = NewBlock();
+            m_firstBlock = block;
+            m_blocks[block].offset = 0;
+            m_blocks[block].size = size;
+            InsertFree(block);
+        }
+    }
+
+    // size bytes at an offset aligned to alignment (a power of two), invalid when no free block is large enough.
+    Allocation Allocate(uint64_t size, uint64_t alignment = 1)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+        Allocation allocation;
+        size = AlignUp(std::max<uint64_t>(size, 1), m_granularity);
+        alignment = std::max(alignment, m_granularity);
+
+        if (size > m_size)
+        {
+            return allocation;
+        }
+
+        // a block this large fits the allocation wherever it starts.
+        const uint64_t searchSize = size + (alignment - m_granularity);
+        uint32_t block = FindFree(searchSize);
+        if (block == Null)
+        {
+            // FindFree() skips the bins that also hold blocks too small. Look through them for one that fits after all:
+            // a block of exactly searchSize, or one whose offset is aligned already (a new heap of exactly size).
+            block = FindFit(size, alignment, searchSize);
+            if (block == Null)
+            {
+                return allocation;
+            }
+        }
+        RemoveFree(block);
+
+        const uint64_t alignedOffset = AlignUp(m_blocks[block].offset, alignment);
+        const uint64_t gap = alignedOffset - m_blocks[block].offset;
+        if (gap > 0)
+        {
+            // the previous physical block is in use (free neighbours are always merged), the gap stays a block of its own.
+            const uint32_t gapBlock = SplitFront(block, gap);
+            InsertFree(gapBlock);
+        }
+
+        if (m_blocks[block].size > size)
+        {
+            const uint32_t remainder = SplitBack(block, size);
+            InsertFree(remainder);
+        }
+
+        m_blocks[block].free = false;
+        m_usedBytes += size;
+        ++m_allocations;
+
+        allocation.offset = m_blocks[block].offset;
+        allocation.size = size;
+        allocation.handle = block;
+        return allocation;
+    }
+
+    void Free(Handle handle)
+    {
+        assert(handle < m_blocks.size() && !m_blocks[handle].free && "invalid or already freed handle");
+
+        uint32_t block = handle;
+        m_blocks[block].free = true;
+        m_usedBytes -= m_blocks[block].size;
+        --m_allocations;
+
+        const uint32_t next = m_blocks[block].nextPhysical;
+        if (next != Null && m_blocks[next].free)
+        {
+            RemoveFree(next);
+            Merge(block, next);
+        }
+
+        const uint32_t previous = m_blocks[block].previousPhysical;
+        if (previous != Null && m_blocks[previous].free)
+        {
+            RemoveFree(previous);
+            Merge(previous, block);
+            block = previous;
+        }
+
+        InsertFree(block);
+    }
+
+    uint64_t GetSize() const { return m_size; }
+    uint64_t GetGranularity() const { return m_granularity; }
+    uint64_t GetUsedBytes() const { return m_usedBytes; }
+    uint64_t GetAllocationCount() const { return m_allocations; }
+    bool IsEmpty() const { return m_allocations == 0; }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.size = m_size;
+        stats.usedBytes = m_usedBytes;
+        stats.freeBytes = m_size - m_usedBytes;
+        stats.allocations = m_allocations;
+
+        for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel)
+        {
+            for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel)
+            {
+                for (uint32_t block = m_freeHeads[firstLevel][secondLevel]; block != Null; block = m_blocks[block].nextFree)
+                {
+                    ++stats.freeBlocks;
+                    stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_blocks[block].size);
+                }
+            }
+        }
+
+        stats.utilization = m_size > 0 ? static_cast<double>(stats.usedBytes) / static_cast<double>(m_size) : 0.0;
+        stats.fragmentation = stats.freeBytes > 0 ? 1.0 - static_cast<double>(stats.largestFreeBlock) / static_cast<double>(stats.freeBytes) : 0.0;
+        return stats;
+    }
+
+    // Check every invariant: the physical chain covers the range without holes, no two free blocks are adjacent, the
+    // free lists hold exactly the free blocks, in the right bins, and the bitmaps match the lists. For tests and fuzzing.
+    bool Validate() const
+    {
+        if (m_size == 0)
+        {
+            return m_blocks.empty();
+        }
+
+        uint64_t offset = 0;
+        uint64_t used = 0;
+        uint64_t freeBlocks = 0;
+        uint32_t previous = Null;
+        for (uint32_t block = m_firstBlock; block != Null; block = m_blocks[block].nextPhysical)
+        {
+            const Block& current = m_blocks[block];
+            if (current.offset != offset || current.size == 0 || current.previousPhysical != previous)
+            {
+                return false;
+            }
+            if (current.offset % m_granularity != 0 || current.size % m_granularity != 0)
+            {
+                return false;
+            }
+            if (current.free && previous != Null && m_blocks[previous].free)
+            {
+                return false;
+            }
+
+            if (current.free)
+            {
+                ++freeBlocks;
+            }
+            else
+            {
+                used += current.size;
+            }
+            offset += current.size;
+            previous = block;
+        }
+
+        if (offset != m_size || used != m_usedBytes)
+        {
+            return false;
+        }
+
+        uint64_t listedBlocks = 0;
+        for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel)
+        {
+            if (((m_firstLevelBitmap >> firstLevel) & 1) != (m_secondLevelBitmaps[firstLevel] != 0 ? 1u : 0u))
+            {
+                return false;
+            }
+
+            for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel)
+            {
+                const bool listed = m_freeHeads[firstLevel][secondLevel] != Null;
+                if (listed != (((m_secondLevelBitmaps[firstLevel] >> secondLevel) & 1) != 0))
+                {
+                    return false;
+                }
+
+                for (uint32_t block = m_freeHeads[firstLevel][secondLevel]; block != Null; block = m_blocks[block].nextFree)
+                {
+                    uint32_t blockFirstLevel = 0;
+                    uint32_t blockSecondLevel = 0;
+                    MappingInsert(m_blocks[block].size, blockFirstLevel, blockSecondLevel);
+                    if (!m_blocks[block].free || blockFirstLevel != firstLevel || blockSecondLevel != secondLevel)
+                    {
+                        return false;
+                    }
+                    ++listedBlocks;
+                }
+            }
+        }
+        return listedBlocks == freeBlocks;
+    }
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+private:
+    static const uint32_t Null = ~0u;
+    static const uint32_t SecondLevelBits = 5;
+    static const uint32_t SecondLevelCount = 1u << SecondLevelBits;
+    static const uint64_t SmallBlockSize = 1ull << SecondLevelBits; // below, the sizes are binned linearly in the first list
+    static const uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+
+    struct Block
+    {
+        uint64_t offset { 0 };
+        uint64_t size { 0 };
+        uint32_t previousPhysical { Null };
+        uint32_t nextPhysical { Null };
+        uint32_t previousFree { Null };
+        uint32_t nextFree { Null };
+        bool free { false };
+    };
+
+    static uint32_t HighestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    static uint32_t LowestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    // Bin of a free block of size.
+    static void MappingInsert(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+    {
+        if (size < SmallBlockSize)
+        {
+            firstLevel = 0;
+            secondLevel = static_cast<uint32_t>(size);
+            return;
+        }
+
+        const uint32_t highestBit = HighestBit(size);
+        secondLevel = static_cast<uint32_t>(size >> (highestBit - SecondLevelBits)) ^ SecondLevelCount;
+        firstLevel = highestBit - SecondLevelBits + 1;
+    }
+
+    // First free block whose every size is at least size: rounds size up to the next bin first.
+    uint32_t FindFree(uint64_t size) const
+    {
+        if (size >= SmallBlockSize)
+        {
+            size += (1ull << (HighestBit(size) - SecondLevelBits)) - 1;
+        }
+
+        uint32_t firstLevel = 0;
+        uint32_t secondLevel = 0;
+        MappingInsert(size, firstLevel, secondLevel);
+        if (firstLevel >= FirstLevelCount)
+        {
+            return Null;
+        }
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        if (secondLevelMap == 0)
+        {
+            const uint64_t firstLevelMap = firstLevel + 1 < 64 ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+            if (firstLevelMap == 0)
+            {
+                return Null;
+            }
+            firstLevel = LowestBit(firstLevelMap);
+            secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        }
+        secondLevel = LowestBit(secondLevelMap);
+        return m_freeHeads[firstLevel][secondLevel];
+    }
+
+    // Free block, in the bins from the one of size to the one of searchSize, that holds size bytes at an offset aligned
+    // to alignment. Linear in the blocks of these bins, the non empty ones are found through the bitmaps.
+    uint32_t FindFit(uint64_t size, uint64_t alignment, uint64_t searchSize) const
+    {
+        uint32_t firstLevel = 0;
+        uint32_t secondLevel = 0;
+        uint32_t lastFirstLevel = 0;
+        uint32_t lastSecondLevel = 0;
+        MappingInsert(size, firstLevel, secondLevel);
+        MappingInsert(searchSize, lastFirstLevel, lastSecondLevel);
+        lastFirstLevel = std::min(lastFirstLevel, FirstLevelCount - 1);
+
+        for (; firstLevel <= lastFirstLevel; ++firstLevel, secondLevel = 0)
+        {
+            uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+            if (firstLevel == lastFirstLevel && lastSecondLevel + 1 < SecondLevelCount)
+            {
+                secondLevelMap &= (1u << (lastSecondLevel + 1)) - 1;
+            }
+
+            for (; secondLevelMap != 0; secondLevelMap &= secondLevelMap - 1)
+            {
+                for (uint32_t block = m_freeHeads[firstLevel][LowestBit(secondLevelMap)]; block != Null; block = m_blocks[block].nextFree)
+                {
+                    const Block& candidate = m_blocks[block];
+                    if (AlignUp(candidate.offset, alignment) - candidate.offset + size <= candidate.size)
+                    {
+                        return block;
+                    }
+                }
+            }
+        }
+        return Null;
+    }
+
+    void InsertFree(uint32_t block)
+    {
+        uint32_t firstLevel = 0;
+        uint32_t secondLevel = 0;
+        MappingInsert(m_blocks[block].size, firstLevel, secondLevel);
+
+        const uint32_t head = m_freeHeads[firstLevel][secondLevel];
+        m_blocks[block].free = true;
+        m_blocks[block].previousFree = Null;
+        m_blocks[block].nextFree = head;
+        if (head != Null)
+        {
+            m_blocks[head].previousFree = block;
+        }
+        m_freeHeads[firstLevel][secondLevel] = block;
+
+        m_firstLevelBitmap |= 1ull << firstLevel;
+        m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    }
+
+    void RemoveFree(uint32_t block)
+    {
+        uint32_t firstLevel = 0;
+        uint32_t secondLevel = 0;
+        MappingInsert(m_blocks[block].size, firstLevel, secondLevel);
+
+        Block& removed = m_blocks[block];
+        if (removed.previousFree != Null)
+        {
+            m_blocks[removed.previousFree].nextFree = removed.nextFree;
+        }
+        else
+        {
+            m_freeHeads[firstLevel][secondLevel] = removed.nextFree;
+        }
+        if (removed.nextFree != Null)
+        {
+            m_blocks[removed.nextFree].previousFree = removed.previousFree;
+        }
+        removed.previousFree = removed.nextFree = Null;
+
+        if (m_freeHeads[firstLevel][secondLevel] == Null)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+            {
+                m_firstLevelBitmap &= ~(1ull << firstLevel);
+            }
+        }
+    }
+
+    // Cut the first size bytes of block into a new block placed before it, returns the new block.
+    uint32_t SplitFront(uint32_t block, uint64_t size)
+    {
+        const uint32_t front = NewBlock();
+        Block& current = m_blocks[block];
+        Block& created = m_blocks[front];
+
+        created.offset = current.offset;
+        created.size = size;
+        created.previousPhysical = current.previousPhysical;
+        created.nextPhysical = block;
+        if (created.previousPhysical != Null)
+        {
+            m_blocks[created.previousPhysical].nextPhysical = front;
+        }
+
+        current.offset += size;
+        current.size -= size;
+        current.previousPhysical = front;
+
+        if (m_firstBlock == block)
+        {
+            m_firstBlock = front;
+        }
+        return front;
+    }
+
+    // Keep the first size bytes of block, the rest becomes a new block placed after it, returned.
+    uint32_t SplitBack(uint32_t block, uint64_t size)
+    {
+        const uint32_t back = NewBlock();
+        Block& current = m_blocks[block];
+        Block& created = m_blocks[back];
+
+        created.offset = current.offset + size;
+        created.size = current.size - size;
+        created.previousPhysical = block;
+        created.nextPhysical = current.nextPhysical;
+        if (created.nextPhysical != Null)
+        {
+            m_blocks[created.nextPhysical].previousPhysical = back;
+        }
+
+        current.size = size;
+        current.nextPhysical = back;
+        return back;
+    }
+
+    // Append next, physically right after block, to block. The first block of the chain is never the one removed.
+    void Merge(uint32_t block, uint32_t next)
+    {
+        Block& current = m_blocks[block];
+        current.size += m_blocks[next].size;
+        current.nextPhysical = m_blocks[next].nextPhysical;
+        if (current.nextPhysical != Null)
+        {
+            m_blocks[current.nextPhysical].previousPhysical = block;
+        }
+        DeleteBlock(next);
+    }
+
+    uint32_t NewBlock()
+    {
+        if (!m_unusedBlocks.empty())
+        {
+            const uint32_t block = m_unusedBlocks.back();
+            m_unusedBlocks.pop_back();
+            m_blocks[block] = Block();
+            return block;
+        }
+        m_blocks.push_back(Block());
+        return static_cast<uint32_t>(m_blocks.size() - 1);
+    }
+
+    void DeleteBlock(uint32_t block)
+    {
+        m_blocks[block] = Block();
+        m_unusedBlocks.push_back(block);
+    }
+
+    uint64_t m_size;
+    uint64_t m_granularity;
+    uint64_t m_usedBytes { 0 };
+    uint64_t m_allocations { 0 };
+
+    std::vector<Block> m_blocks; // indexed by handle, slots of merged blocks are reused
+    std::vector<uint32_t> m_unusedBlocks;
+
+    uint64_t m_firstLevelBitmap { 0 };
+    uint32_t m_secondLevelBitmaps[FirstLevelCount] {};
+    uint32_t m_freeHeads[FirstLevelCount][SecondLevelCount];
+    uint32_t m_firstBlock { Null }; // start of the physical chain
+};
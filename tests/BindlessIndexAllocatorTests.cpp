@@ -0,0 +1,77 @@
+#include "Test.h"
+#include "core/BindlessIndexAllocator.h"
+
+TEST(BindlessIndexAllocator_StaleHandlesAreRecognized)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    BindlessIndexAllocator indices(timeline, 4);
+
+    const BindlessIndexAllocator::Handle handle = indices.Allocate();
+    CHECK(handle.IsValid() && indices.IsValid(handle));
+
+    indices.Free(handle);
+    CHECK(!indices.IsValid(handle));
+    CHECK(indices.GetStats().allocated == 0 && indices.GetStats().pendingFree == 1);
+}
+
+TEST(BindlessIndexAllocator_SlotReusedOnlyOnceTheGpuIsDone)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    BindlessIndexAllocator indices(timeline, 2);
+
+    const BindlessIndexAllocator::Handle first = indices.Allocate();
+    const BindlessIndexAllocator::Handle second = indices.Allocate();
+    indices.Free(first); // may still be read by the frame being recorded
+
+    // full: the freed slot is waiting for the GPU.
+    CHECK(!indices.Allocate().IsValid());
+    CHECK(indices.GetStats().failedAllocations == 1);
+
+    indices.EndFrame(timeline.Signal());
+    fence.Complete(1);
+    const BindlessIndexAllocator::Handle reused = indices.Allocate();
+    CHECK(reused.IsValid() && reused.index == first.index && reused.generation != first.generation);
+    CHECK(indices.IsValid(reused) && !indices.IsValid(first) && indices.IsValid(second));
+    CHECK(indices.GetStats().highWater == 2);
+}
+
+TEST(BindlessIndexAllocator_FreeWithAnExplicitFenceValue)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    BindlessIndexAllocator indices(timeline, 1);
+
+    const BindlessIndexAllocator::Handle handle = indices.Allocate();
+    timeline.Signal();
+    timeline.Signal();
+    indices.Free(handle, 2);
+
+    fence.Complete(1);
+    indices.RetireCompleted();
+    CHECK(indices.GetStats().pendingFree == 1 && !indices.Allocate().IsValid());
+
+    fence.Complete(2);
+    CHECK(indices.Allocate().IsValid());
+    CHECK(indices.GetStats().pendingFree == 0 && indices.GetStats().allocated == 1);
+}
+
+TEST(BindlessIndexAllocator_FrameFreeWaitsForTheEndOfFrameSignal)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    BindlessIndexAllocator indices(timeline, 1);
+
+    // the frame frees the slot, then submits and signals the queue before its own end of frame signal.
+    const BindlessIndexAllocator::Handle handle = indices.Allocate();
+    indices.Free(handle);
+    const uint64_t midFrame = timeline.Signal();
+    indices.EndFrame(timeline.Signal());
+
+    fence.Complete(midFrame);
+    CHECK(!indices.Allocate().IsValid() && indices.GetStats().pendingFree == 1);
+
+    fence.Complete(midFrame + 1);
+    CHECK(indices.Allocate().IsValid());
+}
@@ -0,0 +1,180 @@
+#include "Test.h"
+#include "core/DeferredReleaseQueue.h"
+
+#include <memory>
+
+namespace
+{
+    // Appends its id to a log when destroyed, stands in for a ComPtr.
+    struct Tracked
+    {
+        Tracked(int id, std::vector<int>& log) : id(id), log(&log) {}
+        ~Tracked() { log->push_back(id); }
+
+        int id;
+        std::vector<int>* log;
+    };
+
+    typedef DeferredReleaseQueue<std::unique_ptr<Tracked>> Queue;
+
+    struct Timelines
+    {
+        Timelines()
+        {
+            timelines[QueueType::Direct].Bind(&direct);
+            timelines[QueueType::Copy].Bind(&copy);
+        }
+
+        // Signal on queue, what the frame loop does before retiring the objects the submission used.
+        SyncPoint Signal(QueueType queue) { return timelines.Signal(queue); }
+
+        SoftwareFence direct;
+        SoftwareFence copy;
+        QueueTimelines timelines;
+    };
+
+    void Retire(Queue& queue, int id, std::vector<int>& log, const SyncPoint& lastUse, uint64_t byteSize = 0)
+    {
+        queue.Retire(std::unique_ptr<Tracked>(new Tracked(id, log)), lastUse, byteSize);
+    }
+}
+
+TEST(DeferredReleaseQueue_CollectReleasesInFenceOrder)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    Queue queue;
+
+    Retire(queue, 1, released, gpu.Signal(QueueType::Direct));
+    Retire(queue, 2, released, gpu.Signal(QueueType::Direct));
+    Retire(queue, 3, released, gpu.Signal(QueueType::Direct));
+
+    CHECK(queue.Collect(gpu.timelines) == 0);
+    CHECK(released.empty());
+
+    gpu.direct.Complete(2);
+    CHECK(queue.Collect(gpu.timelines) == 2);
+    CHECK((released == std::vector<int>{ 1, 2 }));
+
+    gpu.direct.CompleteAll();
+    CHECK(queue.Collect(gpu.timelines) == 1);
+    CHECK((released == std::vector<int>{ 1, 2, 3 }));
+    CHECK(queue.Collect(gpu.timelines) == 0);
+}
+
+TEST(DeferredReleaseQueue_QueuesAreIndependent)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    Queue queue;
+
+    Retire(queue, 1, released, gpu.Signal(QueueType::Direct));
+    Retire(queue, 2, released, gpu.Signal(QueueType::Copy));
+
+    gpu.copy.CompleteAll();
+    CHECK(queue.Collect(gpu.timelines) == 1);
+    CHECK((released == std::vector<int>{ 2 }));
+
+    // an object retired on a queue without a timeline stays until ReleaseAll().
+    Retire(queue, 3, released, SyncPoint{ QueueType::Compute, 1 });
+    gpu.direct.CompleteAll();
+    CHECK(queue.Collect(gpu.timelines) == 1);
+    CHECK((released == std::vector<int>{ 2, 1 }));
+    CHECK(queue.GetStats().pendingObjects == 1);
+}
+
+TEST(DeferredReleaseQueue_OutOfOrderRetireIsLateNeverEarly)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    Queue queue;
+
+    const SyncPoint first = gpu.Signal(QueueType::Direct);
+    const SyncPoint second = gpu.Signal(QueueType::Direct);
+    Retire(queue, 2, released, second);
+    Retire(queue, 1, released, first);
+
+    gpu.direct.Complete(first.value);
+    CHECK(queue.Collect(gpu.timelines) == 0);
+    CHECK(released.empty());
+
+    gpu.direct.Complete(second.value);
+    CHECK(queue.Collect(gpu.timelines) == 2);
+    CHECK((released == std::vector<int>{ 2, 1 }));
+}
+
+TEST(DeferredReleaseQueue_ByteCounters)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    Queue queue;
+
+    Retire(queue, 1, released, gpu.Signal(QueueType::Direct), 100);
+    Retire(queue, 2, released, gpu.Signal(QueueType::Direct), 20);
+    Retire(queue, 3, released, gpu.Signal(QueueType::Copy), 3);
+
+    Queue::Stats stats = queue.GetStats();
+    CHECK(stats.pendingObjects == 3);
+    CHECK(stats.pendingBytes == 123);
+    CHECK(stats.releasedObjects == 0);
+    CHECK(stats.releasedBytes == 0);
+
+    gpu.direct.Complete(1);
+    queue.Collect(gpu.timelines);
+    stats = queue.GetStats();
+    CHECK(stats.pendingObjects == 2);
+    CHECK(stats.pendingBytes == 23);
+    CHECK(stats.releasedObjects == 1);
+    CHECK(stats.releasedBytes == 100);
+}
+
+TEST(DeferredReleaseQueue_ReleaseAll)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    {
+        Queue queue;
+        Retire(queue, 1, released, gpu.Signal(QueueType::Direct), 8);
+        Retire(queue, 2, released, gpu.Signal(QueueType::Copy), 8);
+
+        CHECK(queue.ReleaseAll() == 2);
+        CHECK(released.size() == 2);
+        const Queue::Stats stats = queue.GetStats();
+        CHECK(stats.pendingObjects == 0);
+        CHECK(stats.pendingBytes == 0);
+        CHECK(stats.releasedObjects == 2);
+        CHECK(stats.releasedBytes == 16);
+        CHECK(queue.ReleaseAll() == 0);
+
+        // the destructor releases whatever is left.
+        Retire(queue, 3, released, gpu.Signal(QueueType::Direct));
+    }
+    CHECK((released == std::vector<int>{ 1, 2, 3 }));
+}
+
+TEST(DeferredReleaseQueue_FrameRetiresWaitForTheEndOfFrameSignal)
+{
+    Timelines gpu;
+    std::vector<int> released;
+    Queue queue;
+
+    // retired during a frame that submits and signals the direct queue before its own end of frame signal.
+    queue.RetireWithFrame(std::unique_ptr<Tracked>(new Tracked(1, released)), 64);
+    const SyncPoint midFrame = gpu.Signal(QueueType::Direct);
+    queue.RetireWithFrame(std::unique_ptr<Tracked>(new Tracked(2, released)));
+    const SyncPoint frameEnd = gpu.Signal(QueueType::Direct);
+    queue.EndFrame(frameEnd);
+    CHECK(queue.GetStats().pendingObjects == 2 && queue.GetStats().pendingBytes == 64);
+
+    // the mid frame signal isn't enough, the frame may use them until its end.
+    gpu.direct.Complete(midFrame.value);
+    CHECK(queue.Collect(gpu.timelines) == 0);
+
+    gpu.direct.Complete(frameEnd.value);
+    CHECK(queue.Collect(gpu.timelines) == 2);
+    CHECK((released == std::vector<int>{ 1, 2 }));
+
+    // an open frame is released by ReleaseAll() too.
+    queue.RetireWithFrame(std::unique_ptr<Tracked>(new Tracked(3, released)));
+    CHECK(queue.ReleaseAll() == 1 && queue.GetStats().pendingObjects == 0);
+}
@@ -0,0 +1,115 @@
+#include "Test.h"
+#include "core/FenceTimeline.h"
+
+#include <thread>
+
+TEST(FenceTimeline_CachedValueAnswersWithoutTheFence)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    for (uint64_t i = 1; i <= 3; ++i)
+    {
+        CHECK(timeline.Signal() == i);
+    }
+    fence.Complete(2);
+
+    // the cache is behind: the fence is queried once and the cache catches up.
+    CHECK(timeline.GetCachedCompletedValue() == 0);
+    CHECK(timeline.IsComplete(1));
+    CHECK(timeline.GetCachedCompletedValue() == 2 && fence.GetCompletedValueQueryCount() == 1);
+
+    // answered from the cache.
+    CHECK(timeline.IsComplete(1) && timeline.IsComplete(2));
+    CHECK(fence.GetCompletedValueQueryCount() == 1);
+
+    // not reached yet, every poll has to ask the fence.
+    CHECK(!timeline.IsComplete(3) && !timeline.IsComplete(3));
+    CHECK(fence.GetCompletedValueQueryCount() == 3);
+
+    const FenceTimeline::Stats stats = timeline.GetStats();
+    CHECK(stats.completionPolls == 5 && stats.fenceQueries == 3 && stats.blockingWaits == 0);
+}
+
+TEST(FenceTimeline_InitialValueIsComplete)
+{
+    SoftwareFence fence;
+    fence.Complete(5);
+    FenceTimeline timeline(&fence, 5);
+    CHECK(timeline.IsComplete(5) && timeline.GetStats().fenceQueries == 0);
+    CHECK(timeline.Signal() == 6 && timeline.GetLastSignaledValue() == 6);
+}
+
+TEST(FenceTimeline_WaitTimesOutThenCompletes)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    const uint64_t value = timeline.Signal();
+
+    CHECK(!timeline.Wait(value, std::chrono::milliseconds(2)));
+    const FenceTimeline::Stats stats = timeline.GetStats();
+    CHECK(stats.blockingWaits == 1 && stats.blockedNanoseconds >= 1000000);
+
+    std::thread gpu([&fence, value]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        fence.Complete(value);
+    });
+    CHECK(timeline.Wait(value));
+    gpu.join();
+
+    // the value a wait returned for is cached, no query needed afterwards.
+    CHECK(timeline.GetCachedCompletedValue() == value);
+    const uint64_t queries = timeline.GetStats().fenceQueries;
+    CHECK(timeline.IsComplete(value) && timeline.GetStats().fenceQueries == queries);
+}
+
+TEST(FenceTimeline_FlushSignalsAndWaits)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    timeline.Signal();
+    timeline.Signal();
+
+    // the "GPU" completes the flush signal once it has been issued.
+    std::thread gpu([&fence]()
+    {
+        while (fence.GetLastSignaledValue() < 3)
+        {
+            std::this_thread::yield();
+        }
+        fence.Complete(3);
+    });
+    CHECK(timeline.Flush() == 3);
+    gpu.join();
+    CHECK(timeline.GetCachedCompletedValue() == 3 && timeline.GetLastSignaledValue() == 3);
+
+    // with nothing pending, a flush doesn't block.
+    SoftwareFence autoFence(true);
+    FenceTimeline autoTimeline(&autoFence);
+    CHECK(autoTimeline.Flush() == 1 && autoTimeline.GetStats().blockingWaits == 0);
+}
+
+TEST(FenceTimeline_QueueTimelinesAreIndependent)
+{
+    SoftwareFence direct;
+    SoftwareFence copy;
+    QueueTimelines timelines;
+    timelines[QueueType::Direct].Bind(&direct);
+    timelines[QueueType::Copy].Bind(&copy);
+    CHECK(!timelines[QueueType::Compute].IsBound());
+
+    timelines.Signal(QueueType::Direct);
+    const SyncPoint upload = timelines.Signal(QueueType::Copy);
+    const SyncPoint frame = timelines.Signal(QueueType::Direct);
+    CHECK(upload.queue == QueueType::Copy && upload.value == 1);
+    CHECK(frame.queue == QueueType::Direct && frame.value == 2);
+
+    copy.Complete(1);
+    CHECK(timelines.IsComplete(upload) && !timelines.IsComplete(frame));
+    CHECK(timelines.Wait(upload));
+
+    // the unbound compute timeline is skipped.
+    direct.Complete(2);
+    timelines.WaitIdle();
+    CHECK(timelines.IsComplete(frame));
+}
@@ -0,0 +1,175 @@
+#include "Test.h"
+#include "core/FenceWaitService.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // The service thread runs the callbacks, the test thread polls until they have run.
+    template <typename Predicate>
+    bool WaitFor(Predicate predicate)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    struct Log
+    {
+        void Add(int id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.push_back(id);
+        }
+
+        std::vector<int> Get()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ids;
+        }
+
+        std::mutex mutex;
+        std::vector<int> ids;
+    };
+
+    // Sets its flag when destroyed, tells whether a coroutine frame has been unwound.
+    struct DestroyedFlag
+    {
+        explicit DestroyedFlag(std::atomic<bool>& flag) : flag(flag) {}
+        ~DestroyedFlag() { flag = true; }
+
+        std::atomic<bool>& flag;
+    };
+
+    AsyncTask AwaitAndLog(AwaitableTimeline timeline, uint64_t value, Log& log, int id)
+    {
+        co_await timeline.Until(value);
+        log.Add(id);
+    }
+
+    AsyncTask AwaitWithLocal(AwaitableTimeline timeline, uint64_t value, std::atomic<bool>& destroyed, bool& resumedPastAwait)
+    {
+        DestroyedFlag local(destroyed);
+        co_await timeline.Until(value);
+        resumedPastAwait = true;
+    }
+}
+
+TEST(FenceWaitService_CallbacksRunAsTheFenceAdvances)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    for (int i = 0; i < 3; ++i)
+    {
+        timeline.Signal();
+    }
+
+    PollingFenceWaitMultiplexer multiplexer(std::chrono::microseconds(50));
+    FenceWaitService service(multiplexer);
+    Log log;
+    service.Register(timeline, 3, [&log]() { log.Add(3); });
+    service.Register(timeline, 1, [&log]() { log.Add(1); });
+    service.Register(timeline, 2, [&log]() { log.Add(2); });
+
+    for (uint64_t value = 1; value <= 3; ++value)
+    {
+        fence.Complete(value);
+        CHECK(WaitFor([&log, value]() { return log.Get().size() == value; }));
+    }
+    CHECK((log.Get() == std::vector<int>{ 1, 2, 3 }));
+
+    const FenceWaitService::Stats stats = service.GetStats();
+    CHECK(stats.registered == 3 && stats.completed == 3 && stats.cancelled == 0);
+}
+
+TEST(FenceWaitService_CoroutinesResumeInFenceOrder)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    timeline.Signal();
+    timeline.Signal();
+
+    PollingFenceWaitMultiplexer multiplexer(std::chrono::microseconds(50));
+    FenceWaitService service(multiplexer);
+    AwaitableTimeline awaitable(timeline, service);
+    Log log;
+    AsyncTask second = AwaitAndLog(awaitable, 2, log, 2);
+    AsyncTask first = AwaitAndLog(awaitable, 1, log, 1);
+    CHECK(!first.IsDone() && !second.IsDone());
+
+    fence.Complete(1);
+    first.Wait();
+    CHECK(!second.IsDone());
+
+    fence.Complete(2);
+    second.Wait();
+    CHECK((log.Get() == std::vector<int>{ 1, 2 }));
+}
+
+TEST(FenceWaitService_AlreadyCompleteValueDoesNotSuspend)
+{
+    SoftwareFence fence(true);
+    FenceTimeline timeline(&fence);
+    timeline.Signal();
+
+    PollingFenceWaitMultiplexer multiplexer;
+    FenceWaitService service(multiplexer);
+    Log log;
+    AsyncTask task = AwaitAndLog(AwaitableTimeline(timeline, service), 1, log, 1);
+
+    // ran to the end on this thread, nothing went through the service.
+    CHECK(task.IsDone());
+    CHECK((log.Get() == std::vector<int>{ 1 }));
+    CHECK(service.GetStats().registered == 0);
+}
+
+TEST(FenceWaitService_ShutdownCancelsPendingWaits)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    timeline.Signal();
+    timeline.Signal();
+    fence.Complete(1);
+
+    PollingFenceWaitMultiplexer multiplexer(std::chrono::microseconds(50));
+    std::unique_ptr<FenceWaitService> service(new FenceWaitService(multiplexer));
+    AwaitableTimeline awaitable(timeline, *service);
+
+    std::atomic<bool> destroyed { false };
+    bool resumedPastAwait = false;
+    AsyncTask task = AwaitWithLocal(awaitable, 2, destroyed, resumedPastAwait);
+    std::atomic<int> completed { 0 };
+    std::atomic<int> cancelled { 0 };
+    service->Register(timeline, 2, [&completed]() { ++completed; }, [&cancelled]() { ++cancelled; });
+    service->Register(timeline, 1, [&completed]() { ++completed; }, [&cancelled]() { ++cancelled; });
+    CHECK(WaitFor([&completed]() { return completed == 1; }));
+    CHECK(!task.IsDone());
+
+    service.reset();
+
+    // the complete wait ran its callback, the pending ones were cancelled: the coroutine resumed with an exception
+    // and its frame was destroyed.
+    CHECK(completed == 1 && cancelled == 1);
+    CHECK(task.IsDone() && destroyed && !resumedPastAwait);
+    bool threw = false;
+    try
+    {
+        task.Wait();
+    }
+    catch (const FenceWaitCancelled&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
@@ -0,0 +1,72 @@
+#include "Test.h"
+#include "core/FencedPool.h"
+
+#include <vector>
+
+namespace
+{
+    // Objects are numbered in creation order, recycling counts how often each one was reused.
+    struct Pool
+    {
+        Pool()
+            : timeline(&fence)
+            , pool(timeline, [this]() { return next++; }, [this](int& object) { recycled.push_back(object); })
+        {
+        }
+
+        SoftwareFence fence;
+        FenceTimeline timeline;
+        int next { 0 };
+        std::vector<int> recycled;
+        FencedPool<int> pool;
+    };
+}
+
+TEST(FencedPool_ObjectIsReusedOnlyOnceItsFenceValueCompletes)
+{
+    Pool pool;
+    const int object = pool.pool.Acquire();
+    pool.pool.Release(int(object), pool.timeline.Signal());
+
+    // still in flight: a new object is created instead.
+    const int other = pool.pool.Acquire();
+    CHECK(other != object && pool.recycled.empty());
+    pool.pool.Release(int(other), pool.timeline.Signal());
+
+    // the first submission is done, its object comes back and is recycled first.
+    pool.fence.Complete(1);
+    CHECK(pool.pool.Acquire() == object);
+    CHECK((pool.recycled == std::vector<int>{ object }));
+
+    // the second isn't yet.
+    CHECK(pool.pool.Acquire() == 2);
+    pool.fence.Complete(2);
+    CHECK(pool.pool.Acquire() == other);
+
+    const FencedPool<int>::Stats stats = pool.pool.GetStats();
+    CHECK(stats.created == 3 && stats.acquired == 5 && stats.recycled == 2 && stats.available == 0);
+}
+
+TEST(FencedPool_GrowsToTheObjectsInFlight)
+{
+    // three frames in flight, each using two objects: the pool settles at six.
+    Pool pool;
+    const uint64_t framesInFlight = 3;
+    for (uint64_t frame = 1; frame <= 30; ++frame)
+    {
+        if (frame > framesInFlight)
+        {
+            pool.fence.Complete(frame - framesInFlight);
+        }
+        const int first = pool.pool.Acquire();
+        const int second = pool.pool.Acquire();
+        CHECK(first != second);
+        const uint64_t fenceValue = pool.timeline.Signal();
+        pool.pool.Release(int(first), fenceValue);
+        pool.pool.Release(int(second), fenceValue);
+    }
+
+    const FencedPool<int>::Stats stats = pool.pool.GetStats();
+    CHECK(stats.created == 6 && stats.acquired == 60 && stats.recycled == 54);
+    CHECK(stats.available == 6);
+}
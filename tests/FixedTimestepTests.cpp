@@ -0,0 +1,113 @@
+#include "Test.h"
+#include "core/FixedTimestep.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const Clock::Duration Step = std::chrono::milliseconds(10);
+
+    bool Near(double value, double expected) { return std::fabs(value - expected) < 1e-9; }
+
+    // Advance after time has passed, returns the step lengths in seconds run by the call.
+    std::vector<double> AdvanceBy(SimulatedClock& clock, FixedTimestep& timestep, Clock::Duration elapsed)
+    {
+        clock.Advance(elapsed);
+        std::vector<double> steps;
+        timestep.Advance([&steps](double stepSeconds) { steps.push_back(stepSeconds); });
+        return steps;
+    }
+}
+
+TEST(FixedTimestep_StepsPerAdvance)
+{
+    SimulatedClock clock;
+    FixedTimestep timestep(clock, Step);
+
+    // the first call only starts the clock.
+    CHECK(AdvanceBy(clock, timestep, Clock::Duration::zero()).empty());
+
+    CHECK((AdvanceBy(clock, timestep, std::chrono::milliseconds(25)) == std::vector<double>{ 0.01, 0.01 }));
+    CHECK(Near(timestep.GetAlpha(), 0.5));
+    CHECK(AdvanceBy(clock, timestep, std::chrono::milliseconds(5)).size() == 1);
+    CHECK(Near(timestep.GetAlpha(), 0.0));
+    CHECK(AdvanceBy(clock, timestep, std::chrono::milliseconds(9)).empty());
+    CHECK(Near(timestep.GetAlpha(), 0.9));
+
+    const FixedTimestep::Stats& stats = timestep.GetStats();
+    CHECK(stats.frames == 4 && stats.steps == 3 && stats.droppedSteps == 0 && stats.maxStepsInFrame == 2);
+}
+
+TEST(FixedTimestep_CapDropsWholeStepsKeepsTheFraction)
+{
+    SimulatedClock clock;
+    FixedTimestep timestep(clock, Step, 3);
+    AdvanceBy(clock, timestep, Clock::Duration::zero());
+
+    // 5.7 steps owed: 3 run, 2 dropped, the 0.7 left over is kept.
+    CHECK(AdvanceBy(clock, timestep, std::chrono::milliseconds(57)).size() == 3);
+    CHECK(Near(timestep.GetAlpha(), 0.7));
+    CHECK(timestep.GetStats().droppedSteps == 2 && timestep.GetStats().maxStepsInFrame == 3);
+
+    // the next frame goes on from the fraction, not from the backlog.
+    CHECK(AdvanceBy(clock, timestep, std::chrono::milliseconds(4)).size() == 1);
+    CHECK(Near(timestep.GetAlpha(), 0.1));
+}
+
+TEST(FixedTimestep_AlphaStaysInRange)
+{
+    SimulatedClock clock;
+    FixedTimestep timestep(clock, Step, 4);
+    AdvanceBy(clock, timestep, Clock::Duration::zero());
+
+    // every nanosecond is either stepped, dropped, or still in the accumulator.
+    std::mt19937 random(42);
+    int64_t elapsed = 0;
+    bool inRange = true;
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        const int64_t frame = random() % 60000000; // up to 60 ms, over the cap now and then
+        elapsed += frame;
+        AdvanceBy(clock, timestep, std::chrono::nanoseconds(frame));
+        inRange = inRange && timestep.GetAlpha() >= 0.0 && timestep.GetAlpha() < 1.0;
+    }
+    CHECK(inRange);
+
+    const FixedTimestep::Stats& stats = timestep.GetStats();
+    const int64_t accounted = static_cast<int64_t>(stats.steps + stats.droppedSteps) * Step.count();
+    CHECK(stats.droppedSteps > 0 && stats.maxStepsInFrame == 4);
+    CHECK(std::fabs(accounted + timestep.GetAlpha() * Step.count() - elapsed) < 1.0);
+}
+
+TEST(FixedTimestep_SetStepAppliesToTheNextAdvance)
+{
+    SimulatedClock clock;
+    FixedTimestep timestep(clock, Step);
+    AdvanceBy(clock, timestep, Clock::Duration::zero());
+    AdvanceBy(clock, timestep, std::chrono::milliseconds(25));
+
+    // the 5 ms left over count towards the new, shorter step.
+    timestep.SetStep(std::chrono::milliseconds(5));
+    CHECK(timestep.GetStep() == std::chrono::milliseconds(5) && Near(timestep.GetStepSeconds(), 0.005));
+    CHECK((AdvanceBy(clock, timestep, std::chrono::milliseconds(11)) == std::vector<double>{ 0.005, 0.005, 0.005 }));
+    CHECK(Near(timestep.GetAlpha(), 0.2));
+
+    timestep.SetStep(Clock::Duration::zero());
+    CHECK(timestep.GetStep() == Clock::Duration(1));
+    CHECK(FixedTimestep::StepFromRate(0) == std::chrono::seconds(1));
+}
+
+TEST(FixedTimestep_ResetForgetsTheElapsedTime)
+{
+    SimulatedClock clock;
+    FixedTimestep timestep(clock, Step);
+    AdvanceBy(clock, timestep, Clock::Duration::zero());
+    AdvanceBy(clock, timestep, std::chrono::milliseconds(15));
+
+    timestep.Reset();
+    CHECK(AdvanceBy(clock, timestep, std::chrono::seconds(10)).empty());
+    CHECK(Near(timestep.GetAlpha(), 0.0) && timestep.GetStats().droppedSteps == 0);
+    CHECK(AdvanceBy(clock, timestep, std::chrono::milliseconds(10)).size() == 1);
+}
@@ -0,0 +1,76 @@
+#include "Test.h"
+#include "core/FrameLatencyController.h"
+
+namespace
+{
+    // Feeds one decision window: bubbleFrames frames with the GPU idle at submit, the others not, every frame taking
+    // frameMs between presents of which waitMs blocked on the fence. Returns how often the latency changed.
+    uint32_t RecordWindow(FrameLatencyController& controller, uint32_t bubbleFrames, double waitMs, double frameMs)
+    {
+        uint32_t changes = 0;
+        const uint32_t frames = controller.GetSettings().windowFrames;
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            const bool changed = controller.RecordFrame(frame < bubbleFrames, waitMs, frameMs);
+            // decisions are only taken at the end of a window.
+            CHECK(!changed || frame + 1 == frames);
+            changes += changed ? 1 : 0;
+        }
+        return changes;
+    }
+}
+
+TEST(FrameLatencyController_InitialLatencyIsClamped)
+{
+    CHECK(FrameLatencyController(0).GetLatency() == 1);
+    CHECK(FrameLatencyController(3).GetLatency() == 3);
+    CHECK(FrameLatencyController(9).GetLatency() == 4);
+}
+
+TEST(FrameLatencyController_WaitingWithoutBubblesLowersTheLatency)
+{
+    // the GPU is the bottleneck: 16.6 ms a frame of which the CPU blocks 6 ms on the fence, frames only queue up.
+    FrameLatencyController controller(3);
+    CHECK(RecordWindow(controller, 0, 6.0, 16.6) == 1 && controller.GetLatency() == 2);
+    CHECK(RecordWindow(controller, 0, 6.0, 16.6) == 1 && controller.GetLatency() == 1);
+
+    // never below the minimum.
+    CHECK(RecordWindow(controller, 0, 6.0, 16.6) == 0 && controller.GetLatency() == 1);
+}
+
+TEST(FrameLatencyController_BubblesRaiseTheLatency)
+{
+    // the CPU can't keep the GPU fed: 10 frames of 60 find it idle.
+    FrameLatencyController controller(1);
+    CHECK(RecordWindow(controller, 10, 0.0, 16.6) == 1 && controller.GetLatency() == 2);
+    CHECK(RecordWindow(controller, 10, 0.0, 16.6) == 1 && controller.GetLatency() == 3);
+    CHECK(RecordWindow(controller, 10, 0.0, 16.6) == 1 && controller.GetLatency() == 4);
+
+    // never above the maximum.
+    CHECK(RecordWindow(controller, 10, 0.0, 16.6) == 0 && controller.GetLatency() == 4);
+}
+
+TEST(FrameLatencyController_SteadyFramesKeepTheLatency)
+{
+    FrameLatencyController controller(2);
+
+    // 3 bubbles in 60 frames are under the 5% that grows, but do keep it from shrinking.
+    CHECK(RecordWindow(controller, 3, 6.0, 16.6) == 0 && controller.GetLatency() == 2);
+
+    // no bubble, but 1 ms of wait in 16.6 ms is under the 10% that shrinks.
+    CHECK(RecordWindow(controller, 0, 1.0, 16.6) == 0 && controller.GetLatency() == 2);
+}
+
+TEST(FrameLatencyController_LatencyThatStarvedTheGpuIsNotRetriedRightAway)
+{
+    FrameLatencyController controller(1);
+    const uint32_t cooldownWindows = controller.GetSettings().cooldownWindows;
+    CHECK(RecordWindow(controller, 10, 0.0, 16.6) == 1 && controller.GetLatency() == 2);
+
+    // the GPU is then ahead, but going back to 1 waits for the cooldown.
+    for (uint32_t window = 1; window < cooldownWindows; ++window)
+    {
+        CHECK(RecordWindow(controller, 0, 6.0, 16.6) == 0 && controller.GetLatency() == 2);
+    }
+    CHECK(RecordWindow(controller, 0, 6.0, 16.6) == 1 && controller.GetLatency() == 1);
+}
@@ -0,0 +1,108 @@
+#include "Test.h"
+#include "core/FramePacer.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    const Clock::Duration Period = std::chrono::milliseconds(10); // 100 frames per second
+
+    // Paces frameCount frames each taking work, returns the time each one started.
+    std::vector<Clock::Duration> RunFrames(SimulatedClock& clock, FramePacer& pacer, uint32_t frameCount, Clock::Duration work)
+    {
+        std::vector<Clock::Duration> starts;
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            pacer.WaitForNextFrame();
+            starts.push_back(clock.Now());
+            clock.Advance(work);
+        }
+        return starts;
+    }
+
+    bool Near(double value, double expected) { return std::fabs(value - expected) < 1e-6; }
+}
+
+TEST(FramePacer_FramesStartOnePeriodApart)
+{
+    SimulatedClock clock;
+    clock.SetRelaxStep(std::chrono::microseconds(10));
+    FramePacer pacer(clock, 100);
+
+    const std::vector<Clock::Duration> starts = RunFrames(clock, pacer, 200, std::chrono::milliseconds(2));
+    for (size_t i = 1; i < starts.size(); ++i)
+    {
+        CHECK(starts[i] - starts[i - 1] == Period);
+    }
+
+    const FramePacer::Stats stats = pacer.GetStats();
+    CHECK(stats.frames == 200 && stats.missedDeadlines == 0);
+    CHECK(Near(stats.averageFrameMs, 10.0) && Near(stats.maxFrameMs, 10.0) && stats.jitterMs < 1e-6);
+}
+
+TEST(FramePacer_LongFrameCatchesUpOrRestarts)
+{
+    SimulatedClock clock;
+    clock.SetRelaxStep(std::chrono::microseconds(10));
+    FramePacer pacer(clock, 100);
+    RunFrames(clock, pacer, 3, std::chrono::milliseconds(2)); // frames at 0, 10 and 20 ms
+    clock.Advance(std::chrono::milliseconds(13)); // the frame at 20 ms takes 15 ms
+
+    // late by less than a period: the next frame starts right away and the schedule is kept.
+    pacer.WaitForNextFrame();
+    CHECK(clock.Now() == std::chrono::milliseconds(35));
+    pacer.WaitForNextFrame();
+    CHECK(clock.Now() == std::chrono::milliseconds(40));
+    CHECK(pacer.GetStats().missedDeadlines == 1);
+
+    // late by more than a period: no burst of frames to catch up, the schedule restarts from now.
+    clock.Advance(std::chrono::milliseconds(35));
+    pacer.WaitForNextFrame();
+    CHECK(clock.Now() == std::chrono::milliseconds(75));
+    pacer.WaitForNextFrame();
+    CHECK(clock.Now() == std::chrono::milliseconds(85));
+    CHECK(pacer.GetStats().missedDeadlines == 2);
+}
+
+TEST(FramePacer_SleepsThenSpinsToTheDeadline)
+{
+    // the sleep overshoots by 0.5 ms, the spin threshold of 2 ms absorbs it: each frame sleeps 6.5 ms and spins 1.5 ms.
+    SimulatedClock clock;
+    clock.SetRelaxStep(std::chrono::microseconds(10));
+    clock.SetOversleep(std::chrono::microseconds(500));
+    FramePacer pacer(clock, 100);
+    pacer.SetSpinThreshold(std::chrono::milliseconds(2));
+
+    const std::vector<Clock::Duration> starts = RunFrames(clock, pacer, 100, std::chrono::milliseconds(2));
+    CHECK(starts.back() == 99 * Period);
+
+    const FramePacer::Stats stats = pacer.GetStats();
+    CHECK(Near(stats.spinFraction, 0.15) && Near(stats.cpuBusyFraction, 0.35));
+    CHECK(clock.GetSleepCount() == 99 && clock.GetRelaxCount() == 99 * 150);
+}
+
+TEST(FramePacer_NoSpinWithoutThreshold)
+{
+    SimulatedClock clock;
+    FramePacer pacer(clock, 100);
+    pacer.SetSpinThreshold(Clock::Duration::zero());
+
+    const std::vector<Clock::Duration> starts = RunFrames(clock, pacer, 50, std::chrono::milliseconds(2));
+    CHECK(starts.back() == 49 * Period);
+
+    const FramePacer::Stats stats = pacer.GetStats();
+    CHECK(stats.spinFraction == 0.0 && Near(stats.cpuBusyFraction, 0.2));
+    CHECK(clock.GetRelaxCount() == 0);
+}
+
+TEST(FramePacer_ZeroRateOnlyMeasures)
+{
+    SimulatedClock clock;
+    FramePacer pacer(clock, 0);
+
+    const std::vector<Clock::Duration> starts = RunFrames(clock, pacer, 10, std::chrono::milliseconds(3));
+    CHECK(starts.back() == std::chrono::milliseconds(27));
+    CHECK(clock.GetSleepCount() == 0 && clock.GetRelaxCount() == 0);
+    CHECK(Near(pacer.GetStats().averageFrameMs, 3.0));
+}
@@ -0,0 +1,177 @@
+#include "Test.h"
+#include "core/FramePipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Spins until value reaches target, false after a few seconds.
+    bool WaitFor(const std::atomic<uint32_t>& value, uint32_t target)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (value.load() < target)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // Each frame simulated writes its number to the back packet, each frame rendered logs the front one.
+    struct Frames
+    {
+        FramePackets<uint32_t> packets;
+        uint32_t simulated { 0 };
+        std::vector<uint32_t> rendered;
+
+        void Run(FramePipeline& pipeline, JobSystem* jobSystem, uint32_t count)
+        {
+            for (uint32_t frame = 0; frame < count; ++frame)
+            {
+                pipeline.RunFrame(jobSystem, [this]() { packets.Back() = ++simulated; }, [this]() { packets.Publish(); },
+                    [this]() { rendered.push_back(packets.Front()); });
+            }
+        }
+    };
+}
+
+TEST(FramePipeline_StagesRunBackToBackWhenNotPipelined)
+{
+    JobSystem jobs(1);
+    FramePipeline pipeline;
+
+    // disabled, then enabled but without a job system.
+    Frames frames;
+    frames.Run(pipeline, &jobs, 3);
+    pipeline.SetEnabled(true);
+    frames.Run(pipeline, nullptr, 3);
+
+    // every frame renders what was simulated for it, nothing is simulated ahead.
+    CHECK((frames.rendered == std::vector<uint32_t>{ 1, 2, 3, 4, 5, 6 }));
+    CHECK(frames.simulated == 6);
+    CHECK(pipeline.GetStats().frames == 6 && pipeline.GetStats().pipelinedFrames == 0);
+}
+
+TEST(FramePipeline_RenderReadsThePublishedPacket)
+{
+    JobSystem jobs(2);
+    FramePipeline pipeline;
+    pipeline.SetEnabled(true);
+
+    Frames frames;
+    frames.Run(pipeline, &jobs, 100);
+    CHECK(frames.rendered.size() == 100);
+    bool inOrder = true;
+    for (uint32_t i = 0; i < frames.rendered.size(); ++i)
+    {
+        inOrder = inOrder && frames.rendered[i] == i + 1;
+    }
+    CHECK(inOrder);
+
+    // the simulation of frame 101 is in flight until flushed, and published by the next frame.
+    pipeline.Flush();
+    CHECK(frames.simulated == 101);
+    frames.Run(pipeline, &jobs, 1);
+    pipeline.Flush();
+    CHECK(frames.rendered.back() == 101 && frames.simulated == 102);
+    CHECK(pipeline.GetStats().pipelinedFrames == 101);
+}
+
+TEST(FramePipeline_SimulationOverlapsTheRenderWaitingOnItsOwnJobs)
+{
+    // a single worker still busy with a job of the render stage when the next frame's simulation is scheduled, and the
+    // render stage waiting on that job: the waiting thread must leave the simulation to the worker, not run it inline.
+    // Each stage then waits for the other to have started, the simulation would time out if it ran within the render.
+    JobSystem jobs(1);
+    FramePipeline pipeline;
+    pipeline.SetEnabled(true);
+
+    const uint32_t frameCount = 10;
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<uint32_t> busyStarted { 0 };
+    std::atomic<uint32_t> rendersWaiting { 0 };
+    std::atomic<uint32_t> rendersStarted { 0 };
+    std::atomic<uint32_t> simulationsStarted { 0 };
+    std::atomic<uint32_t> notOverlapped { 0 };
+    std::atomic<uint32_t> simulatedOnCaller { 0 };
+    JobCounter busy;
+
+    auto simulate = [&]()
+    {
+        const uint32_t frame = simulationsStarted.fetch_add(1) + 1;
+        if (frame > 1)
+        {
+            simulatedOnCaller.fetch_add(std::this_thread::get_id() == caller ? 1 : 0);
+            notOverlapped.fetch_add(WaitFor(rendersStarted, frame - 1) ? 0 : 1);
+        }
+    };
+    auto render = [&]()
+    {
+        rendersWaiting.fetch_add(1);
+        jobs.Wait(busy);
+        const uint32_t frame = rendersStarted.fetch_add(1) + 1;
+        notOverlapped.fetch_add(WaitFor(simulationsStarted, frame + 1) ? 0 : 1);
+    };
+
+    for (uint32_t frame = 1; frame <= frameCount; ++frame)
+    {
+        jobs.Schedule([&, frame]()
+        {
+            busyStarted.fetch_add(1);
+            WaitFor(rendersWaiting, frame);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }, &busy);
+        CHECK(WaitFor(busyStarted, frame));
+        pipeline.RunFrame(&jobs, simulate, []() {}, render);
+    }
+    pipeline.Flush();
+
+    CHECK(simulationsStarted.load() == frameCount + 1 && rendersStarted.load() == frameCount);
+    CHECK(notOverlapped.load() == 0 && simulatedOnCaller.load() == 0);
+    CHECK(pipeline.GetStats().pipelinedFrames == frameCount);
+}
+
+TEST(FramePipeline_SimulationErrorIsRethrownByTheNextFrame)
+{
+    JobSystem jobs(1);
+    FramePipeline pipeline;
+    pipeline.SetEnabled(true);
+
+    Frames frames;
+    auto simulate = [&frames]()
+    {
+        frames.packets.Back() = ++frames.simulated;
+        if (frames.simulated == 2)
+        {
+            throw std::runtime_error("simulation failed");
+        }
+    };
+    auto publish = [&frames]() { frames.packets.Publish(); };
+    auto render = [&frames]() { frames.rendered.push_back(frames.packets.Front()); };
+
+    // frame 2 is simulated on the worker during the render of frame 1 and fails.
+    pipeline.RunFrame(&jobs, simulate, publish, render);
+    bool thrown = false;
+    try
+    {
+        pipeline.RunFrame(&jobs, simulate, publish, render);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // the failed frame is dropped, the next one simulates again before rendering.
+    pipeline.RunFrame(&jobs, simulate, publish, render);
+    pipeline.Flush();
+    CHECK((frames.rendered == std::vector<uint32_t>{ 1, 3 }));
+    CHECK(frames.simulated == 4);
+}
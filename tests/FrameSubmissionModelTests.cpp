@@ -0,0 +1,80 @@
+#include "Test.h"
+#include "core/FrameSubmissionModel.h"
+#include "core/NullDevice.h"
+
+#include <chrono>
+
+TEST(FrameSubmissionModel_FramesInFlightStayWithinTheLatency)
+{
+    for (uint32_t frameLatency = 1; frameLatency <= 4; ++frameLatency)
+    {
+        SimulatedClock clock;
+        NullDevice device(clock);
+
+        FrameSubmissionModel::Settings settings;
+        settings.frameLatency = frameLatency;
+        FrameSubmissionModel model(device, clock, settings);
+
+        for (uint32_t frame = 0; frame < 50; ++frame)
+        {
+            model.Frame();
+            clock.Advance(std::chrono::microseconds(10)); // CPU work, far less than the GPU's
+
+            FenceTimeline& timeline = model.GetTimeline();
+            CHECK(timeline.GetLastSignaledValue() - timeline.RefreshCompletedValue() < frameLatency);
+        }
+        CHECK(model.GetStats().frames == 50);
+    }
+}
+
+TEST(FrameSubmissionModel_AllocatorsAreRecycled)
+{
+    SimulatedClock clock;
+    NullDevice device(clock);
+
+    FrameSubmissionModel::Settings settings;
+    settings.frameLatency = 3;
+    FrameSubmissionModel model(device, clock, settings);
+    for (uint32_t frame = 0; frame < 200; ++frame)
+    {
+        model.Frame();
+    }
+
+    // one per frame in flight, the one being recorded included.
+    const FrameSubmissionModel::Stats stats = model.GetStats();
+    CHECK(stats.allocators.created <= settings.frameLatency);
+    CHECK(device.GetCallCount(NullDevice::Call::CreateCommandAllocator) == stats.allocators.created);
+}
+
+TEST(FrameSubmissionModel_SceneListsAreRecordedAndSubmittedOnce)
+{
+    SimulatedClock clock;
+    NullDevice device(clock);
+
+    FrameSubmissionModel::Settings settings;
+    settings.sceneCommandListCount = 3;
+    FrameSubmissionModel model(device, clock, settings);
+
+    uint32_t recorded = 0;
+    bool indicesInRange = true;
+    model.SetRecordScene([&](GpuCommandList& commandList, uint32_t listIndex, uint32_t listCount)
+    {
+        indicesInRange = indicesInRange && listIndex < listCount && listCount == 3;
+        commandList.Draw(3, 1);
+        ++recorded;
+    });
+
+    const uint64_t frames = 20;
+    for (uint64_t frame = 0; frame < frames; ++frame)
+    {
+        model.Frame();
+    }
+    model.Flush();
+
+    CHECK(recorded == frames * 3 && indicesInRange);
+    CHECK(device.GetCallCount(NullDevice::Call::Draw) == frames * 3);
+    CHECK(device.GetCallCount(NullDevice::Call::ExecuteCommandLists) == frames);
+    CHECK(device.GetCallCount(NullDevice::Call::ClearRenderTarget) == frames);
+    CHECK(device.GetCallCount(NullDevice::Call::ResourceBarrier) == frames * 2);
+    CHECK(model.GetTimeline().IsComplete(model.GetTimeline().GetLastSignaledValue()));
+}
@@ -0,0 +1,94 @@
+#include "Test.h"
+#include "core/JobSystem.h"
+
+#include <stdexcept>
+#include <thread>
+
+TEST(JobSystem_ParallelForRunsEveryIndexOnce)
+{
+    JobSystem jobs(4);
+    std::vector<std::atomic<uint32_t>> runs(1000);
+    jobs.ParallelFor(static_cast<uint32_t>(runs.size()), 7, [&](uint32_t i) { runs[i].fetch_add(1); });
+
+    bool once = true;
+    for (const auto& count : runs)
+    {
+        once = once && count.load() == 1;
+    }
+    CHECK(once);
+}
+
+TEST(JobSystem_WaitRethrowsOnceEveryJobHasRun)
+{
+    JobSystem jobs(3);
+    std::atomic<uint32_t> finished { 0 };
+    JobCounter counter;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        jobs.Schedule([&finished, i]()
+        {
+            if (i % 16 == 3)
+            {
+                throw std::runtime_error("job failed");
+            }
+            finished.fetch_add(1);
+        }, &counter);
+    }
+
+    bool thrown = false;
+    try
+    {
+        jobs.Wait(counter);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(counter.IsDone());
+    CHECK(finished.load() == 60);
+    CHECK(jobs.GetStats().failed == 4);
+
+    // the exception is consumed, the counter can be reused.
+    jobs.Schedule([&finished]() { finished.fetch_add(1); }, &counter);
+    jobs.Wait(counter);
+    CHECK(finished.load() == 61);
+}
+
+TEST(JobSystem_ParallelForRethrows)
+{
+    JobSystem jobs(2);
+    bool thrown = false;
+    try
+    {
+        jobs.ParallelFor(100, 1, [](uint32_t i)
+        {
+            if (i == 42)
+            {
+                throw std::runtime_error("body failed");
+            }
+        });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+TEST(JobSystem_WorkerOnlyJobsAreNotRunByWait)
+{
+    JobSystem jobs(1);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<uint32_t> onCaller { 0 };
+    JobCounter counter;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        jobs.ScheduleOnWorker([&onCaller, caller]() { onCaller.fetch_add(std::this_thread::get_id() == caller ? 1 : 0); }, &counter);
+    }
+
+    // the caller helps with its own jobs and with waiting on the worker only ones, but runs none of the latter.
+    jobs.ParallelFor(256, 1, [](uint32_t) {});
+    jobs.Wait(counter);
+    CHECK(counter.IsDone() && onCaller.load() == 0);
+}
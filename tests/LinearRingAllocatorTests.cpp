@@ -0,0 +1,60 @@
+#include "Test.h"
+#include "core/LinearRingAllocator.h"
+
+TEST(LinearRingAllocator_AlignsAndWrapsContiguously)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    LinearRingAllocator ring(timeline, 1024);
+
+    CHECK(ring.Allocate(100, 1) == 0);
+    CHECK(ring.Allocate(16, 256) == 256);
+    CHECK(ring.Allocate(600, 16) == 272);
+    ring.EndFrame(timeline.Signal());
+    fence.Complete(1);
+
+    // 872 used, 200 bytes don't fit before the end: the allocation starts over at 0, the end of the ring is padding.
+    CHECK(ring.Allocate(200, 16) == 0);
+    const LinearRingAllocator::Stats stats = ring.GetStats();
+    CHECK(stats.allocations == 4 && stats.allocatedBytes == 916);
+    CHECK(stats.paddingBytes == (256 - 100) + (1024 - 872));
+}
+
+TEST(LinearRingAllocator_FullUntilTheFrameCompletes)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    LinearRingAllocator ring(timeline, 1024);
+
+    CHECK(ring.Allocate(512, 1) == 0);
+    ring.EndFrame(timeline.Signal());
+    CHECK(ring.Allocate(512, 1) == 512);
+    ring.EndFrame(timeline.Signal());
+
+    CHECK(ring.Allocate(1, 1) == LinearRingAllocator::InvalidOffset);
+    CHECK(ring.GetStats().failedAllocations == 1 && ring.GetStats().framesInFlight == 2);
+
+    // the first frame's region comes back once its fence value is reached, not before.
+    fence.Complete(1);
+    CHECK(ring.Allocate(512, 1) == 0);
+    CHECK(ring.Allocate(1, 1) == LinearRingAllocator::InvalidOffset);
+    CHECK(ring.GetStats().framesInFlight == 1);
+
+    fence.Complete(2);
+    ring.RetireCompleted();
+    CHECK(ring.GetStats().framesInFlight == 0 && ring.GetStats().inFlightBytes == 512);
+}
+
+TEST(LinearRingAllocator_LargerThanTheRingFails)
+{
+    SoftwareFence fence;
+    FenceTimeline timeline(&fence);
+    LinearRingAllocator ring(timeline, 256);
+
+    CHECK(ring.Allocate(257, 1) == LinearRingAllocator::InvalidOffset);
+    CHECK(ring.Allocate(256, 1) == 0);
+    ring.EndFrame(timeline.Signal());
+
+    const LinearRingAllocator::Stats stats = ring.GetStats();
+    CHECK(stats.failedAllocations == 1 && stats.highWaterBytes == 256 && stats.maxFrameBytes == 256);
+}
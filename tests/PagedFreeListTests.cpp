@@ -0,0 +1,69 @@
+#include "Test.h"
+#include "core/PagedFreeList.h"
+
+#include <vector>
+
+TEST(PagedFreeList_PageAddedOnlyWhenFull)
+{
+    PagedFreeList list(4);
+    CHECK(list.NeedsPage() && list.GetPageCount() == 0);
+
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        indices.push_back(list.Allocate());
+        CHECK(list.GetPageCount() == 1);
+    }
+    CHECK(list.NeedsPage());
+
+    list.Free(indices[2]);
+    CHECK(!list.NeedsPage());
+    CHECK(list.Allocate() == indices[2]); // last freed first
+    CHECK(list.NeedsPage());
+
+    const uint32_t index = list.Allocate();
+    CHECK(index / list.GetPageSize() == 1 && list.GetPageCount() == 2);
+}
+
+TEST(PagedFreeList_StorageFailureLeavesTheListAsItWas)
+{
+    // what DescriptorAllocator_DX12 does: check, create the page's storage, which may fail, allocate.
+    PagedFreeList list(2);
+    std::vector<int> pages;
+    bool storageFails = true;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        if (list.NeedsPage())
+        {
+            if (storageFails)
+            {
+                storageFails = false;
+                continue;
+            }
+            pages.push_back(0);
+        }
+        const uint32_t index = list.Allocate();
+        CHECK(index / list.GetPageSize() < pages.size());
+    }
+    CHECK(list.GetPageCount() == pages.size());
+    CHECK(list.GetStats().allocated == 5);
+}
+
+TEST(PagedFreeList_Stats)
+{
+    PagedFreeList list(8);
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        indices.push_back(list.Allocate());
+    }
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        list.Free(indices[i]);
+        CHECK(!list.IsAllocated(indices[i]));
+    }
+
+    const PagedFreeList::Stats stats = list.GetStats();
+    CHECK(stats.pages == 2 && stats.capacity == 16);
+    CHECK(stats.allocated == 5 && stats.highWater == 10);
+}
@@ -0,0 +1,69 @@
+#include "Test.h"
+#include "core/Profiler.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    size_t CountZones(const std::string& trace, const std::string& name)
+    {
+        const std::string pattern = "{\"name\":\"" + name + "\",\"ph\":\"X\"";
+        size_t count = 0;
+        for (size_t position = trace.find(pattern); position != std::string::npos; position = trace.find(pattern, position + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    std::string WriteTrace()
+    {
+        std::ostringstream trace;
+        Profiler::Get().WriteChromeTrace(trace);
+        return trace.str();
+    }
+}
+
+TEST(Profiler_TrackKeepsTheNewestZones)
+{
+    Profiler::Track& track = Profiler::Get().CreateTrack("ring test");
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        Profiler::Record(track, "ring zone", i, i + 1, 0);
+    }
+    CHECK(CountZones(WriteTrace(), "ring zone") == 10);
+
+    // once the ring has wrapped, the oldest kept slot is the next one written and isn't exported.
+    for (uint32_t i = 0; i < Profiler::ZoneCapacity; ++i)
+    {
+        Profiler::Record(track, "ring zone", i, i + 1, 0);
+    }
+    CHECK(CountZones(WriteTrace(), "ring zone") == Profiler::ZoneCapacity - 1);
+}
+
+TEST(Profiler_ExportWhileRecording)
+{
+    std::atomic<bool> stop { false };
+    std::thread writer([&stop]()
+    {
+        PROFILE_THREAD_NAME("profiler test writer");
+        while (!stop.load())
+        {
+            PROFILE_ZONE("concurrent zone");
+        }
+    });
+
+    // every exported zone is a complete one: its name and a duration that isn't negative.
+    bool consistent = true;
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        const std::string trace = WriteTrace();
+        consistent = consistent && trace.find("\"dur\":-") == std::string::npos && trace.find("\"name\":\"\"") == std::string::npos;
+    }
+    stop.store(true);
+    writer.join();
+    CHECK(consistent);
+    CHECK(CountZones(WriteTrace(), "concurrent zone") > 0);
+}
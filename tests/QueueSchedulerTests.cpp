@@ -0,0 +1,119 @@
+#include "Test.h"
+#include "core/QueueScheduler.h"
+
+#include <vector>
+
+namespace
+{
+    struct Wait
+    {
+        QueueType waitingQueue;
+        QueueType producer;
+        uint64_t value;
+
+        bool operator==(const Wait& other) const { return waitingQueue == other.waitingQueue && producer == other.producer && value == other.value; }
+    };
+
+    // Three queues on software fences, the GPU waits are recorded instead of issued.
+    struct Gpu
+    {
+        Gpu()
+            : scheduler(timelines, [this](QueueType queue, const SyncPoint& point) { waits.push_back(Wait{ queue, point.queue, point.value }); })
+        {
+            timelines[QueueType::Direct].Bind(&direct);
+            timelines[QueueType::Compute].Bind(&compute);
+            timelines[QueueType::Copy].Bind(&copy);
+        }
+
+        SoftwareFence direct;
+        SoftwareFence compute;
+        SoftwareFence copy;
+        QueueTimelines timelines;
+        std::vector<Wait> waits;
+        QueueScheduler scheduler;
+    };
+}
+
+TEST(QueueScheduler_DirectWaitsForComputeAndCopy)
+{
+    Gpu gpu;
+    const SyncPoint upload = gpu.timelines.Signal(QueueType::Copy);
+    const SyncPoint simulation = gpu.timelines.Signal(QueueType::Compute);
+    gpu.scheduler.AddDependency(QueueType::Direct, upload);
+    gpu.scheduler.AddDependency(QueueType::Direct, simulation);
+
+    // nothing is waited for until the direct queue submits, and then on its own GPU timeline only.
+    CHECK(gpu.waits.empty());
+    CHECK(gpu.scheduler.Resolve(QueueType::Compute) == 0);
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 2);
+    CHECK((gpu.waits == std::vector<Wait>{ { QueueType::Direct, QueueType::Compute, 1 }, { QueueType::Direct, QueueType::Copy, 1 } }));
+
+    // resolved once.
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 0);
+    const QueueScheduler::Stats stats = gpu.scheduler.GetStats();
+    CHECK(stats.dependencies == 2 && stats.waitsIssued == 2 && stats.waitsSkipped == 0);
+}
+
+TEST(QueueScheduler_OnlyTheNewestValuePerProducerIsWaitedFor)
+{
+    Gpu gpu;
+    gpu.scheduler.AddDependency(QueueType::Direct, gpu.timelines.Signal(QueueType::Copy));
+    gpu.scheduler.AddDependency(QueueType::Direct, gpu.timelines.Signal(QueueType::Copy));
+    const SyncPoint last = gpu.timelines.Signal(QueueType::Copy);
+    gpu.scheduler.AddDependency(QueueType::Direct, last);
+
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 1);
+    CHECK((gpu.waits == std::vector<Wait>{ { QueueType::Direct, QueueType::Copy, last.value } }));
+}
+
+TEST(QueueScheduler_RedundantWaitsAreElided)
+{
+    Gpu gpu;
+    const SyncPoint first = gpu.timelines.Signal(QueueType::Compute);
+    const SyncPoint second = gpu.timelines.Signal(QueueType::Compute);
+    gpu.scheduler.AddDependency(QueueType::Direct, second);
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 1);
+
+    // covered by the wait for the later value: the direct queue executes in order.
+    gpu.scheduler.AddDependency(QueueType::Direct, first);
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 0);
+
+    // on the queue itself.
+    gpu.scheduler.AddDependency(QueueType::Direct, gpu.timelines.Signal(QueueType::Direct));
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 0);
+
+    // already complete as far as the CPU can tell.
+    const SyncPoint done = gpu.timelines.Signal(QueueType::Copy);
+    gpu.copy.Complete(done.value);
+    gpu.scheduler.AddDependency(QueueType::Direct, done);
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 0);
+
+    // a wait by another queue isn't covered by the direct queue's.
+    gpu.scheduler.AddDependency(QueueType::Copy, second);
+    CHECK(gpu.scheduler.Resolve(QueueType::Copy) == 1);
+
+    CHECK(gpu.waits.size() == 2);
+    const QueueScheduler::Stats stats = gpu.scheduler.GetStats();
+    CHECK(stats.dependencies == 5 && stats.waitsIssued == 2 && stats.waitsSkipped == 3);
+}
+
+TEST(QueueScheduler_ComputeWaitsForCopyThenDirectForCompute)
+{
+    // upload on the copy queue, simulate on compute, draw on direct: a chain of waits, one per hop.
+    Gpu gpu;
+    const SyncPoint upload = gpu.timelines.Signal(QueueType::Copy);
+    gpu.scheduler.AddDependency(QueueType::Compute, upload);
+    CHECK(gpu.scheduler.Resolve(QueueType::Compute) == 1);
+    const SyncPoint simulation = gpu.timelines.Signal(QueueType::Compute);
+
+    gpu.scheduler.AddDependency(QueueType::Direct, simulation);
+    CHECK(gpu.scheduler.Resolve(QueueType::Direct) == 1);
+    CHECK((gpu.waits == std::vector<Wait>{ { QueueType::Compute, QueueType::Copy, 1 }, { QueueType::Direct, QueueType::Compute, 1 } }));
+
+    // the GPU finished both, a new frame depending on them again needs no wait.
+    gpu.copy.CompleteAll();
+    gpu.compute.CompleteAll();
+    gpu.scheduler.AddDependency(QueueType::Compute, upload);
+    gpu.scheduler.AddDependency(QueueType::Direct, simulation);
+    CHECK(gpu.scheduler.Resolve(QueueType::Compute) == 0 && gpu.scheduler.Resolve(QueueType::Direct) == 0);
+}
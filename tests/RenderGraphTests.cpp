@@ -0,0 +1,132 @@
+#include "Test.h"
+#include "core/RenderGraph.h"
+
+namespace
+{
+    const uint64_t MB = 1024 * 1024;
+
+    // Barriers of batch of type, for the checks.
+    uint32_t CountBarriers(const RenderGraph& graph, RenderGraph::BarrierBatch batch, RenderGraph::Barrier::Type type)
+    {
+        uint32_t count = 0;
+        for (uint32_t i = batch.first; i < batch.first + batch.count; ++i)
+        {
+            count += graph.GetBarriers()[i].type == type ? 1 : 0;
+        }
+        return count;
+    }
+}
+
+TEST(RenderGraph_CullsPassesNothingNeeds)
+{
+    RenderGraph graph;
+    const RenderGraph::ResourceHandle backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+    const RenderGraph::ResourceHandle unused = graph.CreateTransient("unused", MB);
+    const RenderGraph::ResourceHandle scene = graph.CreateTransient("scene", MB);
+
+    const RenderGraph::PassHandle dead = graph.AddPass("dead");
+    graph.Write(dead, unused, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle draw = graph.AddPass("draw");
+    graph.Write(draw, scene, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle compose = graph.AddPass("compose");
+    graph.Read(compose, scene, ResourceState::ShaderResource);
+    graph.Write(compose, backBuffer, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle readback = graph.AddPass("readback", true);
+    graph.Read(readback, unused, ResourceState::CopySource);
+    graph.Compile();
+
+    // the readback has side effects, it keeps the pass writing what it reads.
+    CHECK(!graph.IsCulled(dead) && !graph.IsCulled(draw) && !graph.IsCulled(compose) && !graph.IsCulled(readback));
+
+    graph.Reset();
+    const RenderGraph::ResourceHandle target = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+    const RenderGraph::ResourceHandle orphan = graph.CreateTransient("orphan", MB);
+    const RenderGraph::PassHandle orphanPass = graph.AddPass("orphan");
+    graph.Write(orphanPass, orphan, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle present = graph.AddPass("present");
+    graph.Write(present, target, ResourceState::RenderTarget);
+    graph.Compile();
+
+    CHECK(graph.IsCulled(orphanPass) && !graph.IsCulled(present));
+    CHECK(!graph.IsUsed(orphan) && graph.GetCompiledPasses().size() == 1);
+    CHECK(graph.GetStats().culledPasses == 1 && graph.GetStats().transientResources == 0);
+}
+
+TEST(RenderGraph_TransientsWithDisjointLifetimesShareMemory)
+{
+    RenderGraph graph;
+    const RenderGraph::ResourceHandle output = graph.ImportResource("output", ResourceState::Present, ResourceState::Present);
+    const RenderGraph::ResourceHandle a = graph.CreateTransient("a", 4 * MB);
+    const RenderGraph::ResourceHandle b = graph.CreateTransient("b", 4 * MB);
+    const RenderGraph::ResourceHandle c = graph.CreateTransient("c", 4 * MB);
+
+    // a lives in passes 0-1, b in 1-2, c in 2-3: a and c never overlap.
+    const RenderGraph::PassHandle p0 = graph.AddPass("p0");
+    graph.Write(p0, a, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle p1 = graph.AddPass("p1");
+    graph.Read(p1, a, ResourceState::ShaderResource);
+    graph.Write(p1, b, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle p2 = graph.AddPass("p2");
+    graph.Read(p2, b, ResourceState::ShaderResource);
+    graph.Write(p2, c, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle p3 = graph.AddPass("p3");
+    graph.Read(p3, c, ResourceState::ShaderResource);
+    graph.Write(p3, output, ResourceState::RenderTarget);
+    graph.Compile();
+
+    CHECK(graph.GetTransientOffset(a) == graph.GetTransientOffset(c));
+    CHECK(graph.GetTransientOffset(a) != graph.GetTransientOffset(b));
+    CHECK(graph.GetTransientHeapSize() == 8 * MB);
+    CHECK(graph.GetStats().transientBytes == 12 * MB && graph.GetStats().aliasedResources == 2);
+
+    // c takes the memory over from a right before its first pass, a going back to its creation state first.
+    const RenderGraph::BarrierBatch batch = graph.GetCompiledPasses()[2].barriers;
+    CHECK(CountBarriers(graph, batch, RenderGraph::Barrier::Type::Aliasing) == 1);
+    const RenderGraph::Barrier& restore = graph.GetBarriers()[batch.first];
+    CHECK(restore.type == RenderGraph::Barrier::Type::Transition && restore.resource == a && restore.after == ResourceState::RenderTarget);
+    const RenderGraph::Barrier& aliasing = graph.GetBarriers()[batch.first + 1];
+    CHECK(aliasing.type == RenderGraph::Barrier::Type::Aliasing && aliasing.resource == c && aliasing.resourceBefore == a);
+}
+
+TEST(RenderGraph_TransitionsOnlyWhereTheStateChanges)
+{
+    RenderGraph graph;
+    const RenderGraph::ResourceHandle backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+    const RenderGraph::ResourceHandle buffer = graph.CreateTransient("buffer", MB);
+
+    const RenderGraph::PassHandle first = graph.AddPass("first");
+    graph.Write(first, buffer, ResourceState::UnorderedAccess);
+    const RenderGraph::PassHandle second = graph.AddPass("second");
+    graph.Write(second, buffer, ResourceState::UnorderedAccess);
+    const RenderGraph::PassHandle draw = graph.AddPass("draw");
+    graph.Read(draw, buffer, ResourceState::ShaderResource);
+    graph.Write(draw, backBuffer, ResourceState::RenderTarget);
+    const RenderGraph::PassHandle overlay = graph.AddPass("overlay");
+    graph.Write(overlay, backBuffer, ResourceState::RenderTarget);
+    graph.Compile();
+
+    const std::vector<RenderGraph::CompiledPass>& passes = graph.GetCompiledPasses();
+    CHECK(passes.size() == 4);
+
+    // created in its first state, no barrier in front of the first pass.
+    CHECK(graph.GetInitialState(buffer) == ResourceState::UnorderedAccess && passes[0].barriers.count == 0);
+    // UAV barrier between the two unordered access writes.
+    CHECK(passes[1].barriers.count == 1 && CountBarriers(graph, passes[1].barriers, RenderGraph::Barrier::Type::UnorderedAccess) == 1);
+    // buffer to shader resource, back buffer to render target.
+    CHECK(passes[2].barriers.count == 2 && CountBarriers(graph, passes[2].barriers, RenderGraph::Barrier::Type::Transition) == 2);
+    // back buffer already a render target.
+    CHECK(passes[3].barriers.count == 0);
+
+    // the back buffer back to present, the buffer back to its creation state for the next execution.
+    const RenderGraph::BarrierBatch final = graph.GetFinalBarriers();
+    CHECK(final.count == 2);
+    bool backBufferPresented = false;
+    bool bufferRestored = false;
+    for (uint32_t i = final.first; i < final.first + final.count; ++i)
+    {
+        const RenderGraph::Barrier& barrier = graph.GetBarriers()[i];
+        backBufferPresented = backBufferPresented || (barrier.resource == backBuffer && barrier.after == ResourceState::Present);
+        bufferRestored = bufferRestored || (barrier.resource == buffer && barrier.after == ResourceState::UnorderedAccess);
+    }
+    CHECK(backBufferPresented && bufferRestored);
+}
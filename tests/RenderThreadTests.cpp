@@ -0,0 +1,133 @@
+#include "Test.h"
+#include "core/RenderThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool WaitForFrames(const RenderThread& thread, uint64_t frames)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (thread.GetFrameCount() < frames)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+}
+
+TEST(RenderThread_ForwardsEventsAndCoalescesResizes)
+{
+    // posted before the thread starts: the first frame sees all of them.
+    RenderThread thread;
+    CHECK(thread.Post(WindowEvent::KeyDown(1)));
+    CHECK(thread.Post(WindowEvent::Resize(10, 20)));
+    CHECK(thread.Post(WindowEvent::Resize(30, 40)));
+    CHECK(thread.Post(WindowEvent::KeyUp(1)));
+
+    // only written by the render thread, read once Stop() has joined it.
+    std::vector<std::string> log;
+    RenderThread::Callbacks callbacks;
+    callbacks.onEvent = [&log](const WindowEvent& event)
+    {
+        log.push_back((event.type == WindowEvent::Type::KeyDown ? "down " : "up ") + std::to_string(event.key));
+    };
+    callbacks.onResize = [&log](uint32_t width, uint32_t height) { log.push_back("resize " + std::to_string(width) + "x" + std::to_string(height)); };
+    callbacks.onFrame = [&log]() { if (log.size() < 5) log.push_back("frame"); };
+    thread.Start(callbacks);
+    CHECK(thread.IsRunning());
+    CHECK(WaitForFrames(thread, 2));
+    thread.Stop();
+
+    CHECK((log == std::vector<std::string>{ "down 1", "up 1", "resize 30x40", "frame", "frame" }));
+}
+
+TEST(RenderThread_StopJoinsTheThread)
+{
+    RenderThread thread;
+    std::atomic<uint64_t> frames { 0 };
+    RenderThread::Callbacks callbacks;
+    callbacks.onFrame = [&frames]() { ++frames; };
+    thread.Start(callbacks);
+    CHECK(WaitForFrames(thread, 10));
+    thread.Stop();
+
+    // no frame runs once Stop() has returned.
+    const uint64_t stoppedAt = frames;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(!thread.IsRunning() && frames == stoppedAt && thread.GetFrameCount() == stoppedAt);
+
+    // a second Stop() has nothing to join.
+    thread.Stop();
+}
+
+TEST(RenderThread_FrameExceptionReachesStop)
+{
+    RenderThread thread;
+    std::atomic<bool> exited { false };
+    RenderThread::Callbacks callbacks;
+    callbacks.onFrame = [&thread]()
+    {
+        if (thread.GetFrameCount() == 3)
+        {
+            throw std::runtime_error("device removed");
+        }
+    };
+    callbacks.onExit = [&exited]() { exited = true; };
+    thread.Start(callbacks);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!exited && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+
+    // the thread has exited on its own, but it runs until the owner stops it.
+    CHECK(exited && thread.IsRunning() && thread.GetFrameCount() == 3);
+    CHECK(thread.Post(WindowEvent::KeyDown(2)));
+
+    std::string error;
+    try
+    {
+        thread.Stop();
+    }
+    catch (const std::runtime_error& exception)
+    {
+        error = exception.what();
+    }
+    CHECK(error == "device removed" && !thread.IsRunning());
+
+    // reported once.
+    thread.Stop();
+}
+
+TEST(RenderThread_FullQueueDropsKeysButNotResizes)
+{
+    RenderThread thread;
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 300; ++i)
+    {
+        accepted += thread.Post(WindowEvent::KeyDown(static_cast<uint8_t>(i))) ? 1 : 0;
+    }
+    CHECK(accepted == 256 && thread.GetDroppedEventCount() == 300 - 256);
+    CHECK(thread.Post(WindowEvent::Resize(64, 32)));
+
+    uint32_t events = 0;
+    uint32_t resizes = 0;
+    RenderThread::Callbacks callbacks;
+    callbacks.onEvent = [&events](const WindowEvent&) { ++events; };
+    callbacks.onResize = [&resizes](uint32_t width, uint32_t height) { resizes += width == 64 && height == 32 ? 1 : 0; };
+    callbacks.onFrame = []() {};
+    thread.Start(callbacks);
+    CHECK(WaitForFrames(thread, 1));
+    thread.Stop();
+    CHECK(events == 256 && resizes == 1);
+}
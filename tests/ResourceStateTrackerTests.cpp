@@ -0,0 +1,105 @@
+#include "Test.h"
+#include "core/ResourceStateTracker.h"
+
+#include <vector>
+
+namespace
+{
+    // Stand in for ID3D12Resource pointers.
+    const int textureObject = 0;
+    const int bufferObject = 0;
+    const ResourceKey texture = &textureObject;
+    const ResourceKey buffer = &bufferObject;
+}
+
+TEST(ResourceStateTracker_FirstUseIsResolvedAtSubmission)
+{
+    ResourceStateRegistry registry;
+    registry.Register(texture, 1, ResourceState::Present);
+
+    // two lists recorded independently, both starting with the texture in a state they don't know.
+    ResourceStateTracker first(registry);
+    first.Transition(texture, ResourceState::RenderTarget);
+    ResourceStateTracker second(registry);
+    second.Transition(texture, ResourceState::ShaderResource);
+    CHECK(!first.HasPendingBarriers() && !second.HasPendingBarriers());
+
+    // submitted in order: each fixup goes from the state the previous list left.
+    std::vector<ResourceStateTracker::Barrier> fixups;
+    CHECK(first.Resolve(registry, fixups) == 1);
+    CHECK(fixups[0].before == ResourceState::Present && fixups[0].after == ResourceState::RenderTarget);
+    CHECK(second.Resolve(registry, fixups) == 1);
+    CHECK(fixups[1].before == ResourceState::RenderTarget && fixups[1].after == ResourceState::ShaderResource);
+    CHECK(registry.GetState(texture) == ResourceState::ShaderResource);
+
+    // nothing to fix up when the list expects the committed state.
+    ResourceStateTracker third(registry);
+    third.Transition(texture, ResourceState::ShaderResource);
+    fixups.clear();
+    CHECK(third.Resolve(registry, fixups) == 0);
+}
+
+TEST(ResourceStateTracker_PendingTransitionsAreMerged)
+{
+    ResourceStateRegistry registry;
+    registry.Register(texture, 1, ResourceState::Present);
+    registry.Register(buffer, 1, ResourceState::Present);
+
+    ResourceStateTracker tracker(registry);
+    tracker.Transition(texture, ResourceState::RenderTarget);
+    tracker.Transition(buffer, ResourceState::CopyDest);
+
+    tracker.Transition(texture, ResourceState::CopySource);
+    tracker.Transition(texture, ResourceState::ShaderResource); // replaces RenderTarget -> CopySource
+    tracker.Transition(buffer, ResourceState::ShaderResource);
+    tracker.Transition(buffer, ResourceState::CopyDest);        // cancels CopyDest -> ShaderResource
+    tracker.Transition(buffer, ResourceState::CopyDest);        // no change, nothing queued
+
+    std::vector<ResourceStateTracker::Barrier> barriers;
+    CHECK(tracker.Flush(barriers) == 1);
+    CHECK(barriers[0].resource == texture && barriers[0].before == ResourceState::RenderTarget && barriers[0].after == ResourceState::ShaderResource);
+    CHECK(tracker.GetStats().mergedBarriers == 2 && tracker.GetStats().flushes == 1);
+}
+
+TEST(ResourceStateTracker_SubresourcesAreTrackedOnlyWhenUsedIndividually)
+{
+    ResourceStateRegistry registry;
+    registry.Register(texture, 4, ResourceState::ShaderResource);
+
+    ResourceStateTracker tracker(registry);
+    tracker.Transition(texture, ResourceState::RenderTarget, 2);
+
+    std::vector<ResourceStateTracker::Barrier> fixups;
+    CHECK(tracker.Resolve(registry, fixups) == 1);
+    CHECK(fixups[0].subresource == 2 && fixups[0].after == ResourceState::RenderTarget);
+    CHECK(registry.GetState(texture, 2) == ResourceState::RenderTarget);
+    CHECK(registry.GetState(texture, 1) == ResourceState::ShaderResource);
+
+    // the whole resource back to one state: one transition for each subresource that differs.
+    ResourceStateTracker next(registry);
+    next.Transition(texture, ResourceState::CopySource);
+    fixups.clear();
+    CHECK(next.Resolve(registry, fixups) == 4);
+    CHECK(registry.GetState(texture, 0) == ResourceState::CopySource && registry.GetState(texture, 2) == ResourceState::CopySource);
+}
+
+TEST(ResourceStateTracker_SplitTransitionEndsAtTheNextUse)
+{
+    ResourceStateRegistry registry;
+    registry.Register(texture, 1, ResourceState::Present);
+
+    ResourceStateTracker tracker(registry);
+    tracker.Transition(texture, ResourceState::RenderTarget);
+    tracker.BeginTransition(texture, ResourceState::ShaderResource);
+
+    std::vector<ResourceStateTracker::Barrier> barriers;
+    CHECK(tracker.Flush(barriers) == 1 && barriers[0].split == ResourceStateTracker::Barrier::Split::Begin);
+
+    tracker.Transition(texture, ResourceState::ShaderResource);
+    CHECK(tracker.Flush(barriers) == 1 && barriers[1].split == ResourceStateTracker::Barrier::Split::End);
+    CHECK(barriers[1].before == ResourceState::RenderTarget && barriers[1].after == ResourceState::ShaderResource);
+
+    std::vector<ResourceStateTracker::Barrier> fixups;
+    tracker.Resolve(registry, fixups);
+    CHECK(registry.GetState(texture) == ResourceState::ShaderResource);
+}
@@ -0,0 +1,172 @@
+#include "Test.h"
+#include "core/BlobCache.h"
+#include "core/RootSignatureDesc.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // A table of two SRV ranges and a CBV, 1.1.
+    struct Signature
+    {
+        Signature()
+        {
+            memset(ranges, 0, sizeof(ranges));
+            memset(parameters, 0, sizeof(parameters));
+            ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+            ranges[0].NumDescriptors = 4;
+            ranges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+            ranges[1].NumDescriptors = 2;
+            ranges[1].BaseShaderRegister = 4;
+            ranges[1].OffsetInDescriptorsFromTableStart = 4;
+
+            parameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+            parameters[0].DescriptorTable.NumDescriptorRanges = 2;
+            parameters[0].DescriptorTable.pDescriptorRanges = ranges;
+            parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+            parameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+            parameters[1].Descriptor.ShaderRegister = 1;
+
+            memset(&desc, 0, sizeof(desc));
+            desc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
+            desc.Desc_1_1.NumParameters = 2;
+            desc.Desc_1_1.pParameters = parameters;
+        }
+
+        D3D12_DESCRIPTOR_RANGE1 ranges[2];
+        D3D12_ROOT_PARAMETER1 parameters[2];
+        D3D12_VERSIONED_ROOT_SIGNATURE_DESC desc;
+    };
+
+    RootSignatureKey MakeKey(const Signature& signature, D3D_ROOT_SIGNATURE_VERSION targetVersion = D3D_ROOT_SIGNATURE_VERSION_1_1)
+    {
+        RootSignatureKey key;
+        key.Build(signature.desc, targetVersion);
+        return key;
+    }
+
+    const char* const CachePath = "RootSignatureCacheTests.bin";
+}
+
+TEST(RootSignatureKey_SameSignatureSameKey)
+{
+    // separate arrays, same content: the addresses aren't part of the key.
+    Signature first;
+    Signature second;
+    CHECK(MakeKey(first) == MakeKey(second));
+    CHECK(MakeKey(first).GetHash() == MakeKey(second).GetHash());
+
+    second.ranges[1].BaseShaderRegister = 5;
+    CHECK(MakeKey(first) != MakeKey(second));
+
+    Signature third;
+    third.parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    CHECK(MakeKey(first) != MakeKey(third));
+
+    // serialized for another version, another blob.
+    CHECK(MakeKey(first) != MakeKey(first, D3D_ROOT_SIGNATURE_VERSION_1_0));
+}
+
+TEST(RootSignatureDowngrade_KeepsEverything10Describes)
+{
+    Signature signature;
+    RootSignatureDowngrade downgrade;
+    const D3D12_ROOT_SIGNATURE_DESC* desc = downgrade.Convert(signature.desc.Desc_1_1);
+    CHECK(desc != nullptr && desc->NumParameters == 2);
+
+    const D3D12_ROOT_PARAMETER& table = desc->pParameters[0];
+    CHECK(table.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE && table.ShaderVisibility == D3D12_SHADER_VISIBILITY_PIXEL);
+    CHECK(table.DescriptorTable.NumDescriptorRanges == 2);
+    CHECK(table.DescriptorTable.pDescriptorRanges[1].NumDescriptors == 2);
+    CHECK(table.DescriptorTable.pDescriptorRanges[1].BaseShaderRegister == 4);
+    CHECK(table.DescriptorTable.pDescriptorRanges[1].OffsetInDescriptorsFromTableStart == 4);
+    CHECK(desc->pParameters[1].ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV && desc->pParameters[1].Descriptor.ShaderRegister == 1);
+}
+
+TEST(RootSignatureDowngrade_RangesBeyondTheInlineStorage)
+{
+    std::vector<D3D12_DESCRIPTOR_RANGE1> ranges(RootSignatureDowngrade::InlineRanges + 10);
+    memset(ranges.data(), 0, ranges.size() * sizeof(ranges[0]));
+    for (UINT i = 0; i < ranges.size(); ++i)
+    {
+        ranges[i].NumDescriptors = 1;
+        ranges[i].BaseShaderRegister = i;
+    }
+
+    D3D12_ROOT_PARAMETER1 parameters[2];
+    memset(parameters, 0, sizeof(parameters));
+    for (UINT i = 0; i < 2; ++i)
+    {
+        parameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        parameters[i].DescriptorTable.NumDescriptorRanges = static_cast<UINT>(ranges.size() / 2);
+        parameters[i].DescriptorTable.pDescriptorRanges = ranges.data() + i * ranges.size() / 2;
+    }
+
+    D3D12_ROOT_SIGNATURE_DESC1 desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.NumParameters = 2;
+    desc.pParameters = parameters;
+
+    RootSignatureDowngrade downgrade;
+    const D3D12_ROOT_SIGNATURE_DESC* converted = downgrade.Convert(desc);
+    CHECK(converted != nullptr);
+    const UINT half = static_cast<UINT>(ranges.size() / 2);
+    CHECK(converted->pParameters[1].DescriptorTable.pDescriptorRanges[0].BaseShaderRegister == half);
+    CHECK(converted->pParameters[1].DescriptorTable.pDescriptorRanges[half - 1].BaseShaderRegister == 2 * half - 1);
+}
+
+TEST(BlobCache_SaveAndLoad)
+{
+    Signature signature;
+    const RootSignatureKey key = MakeKey(signature);
+    const uint8_t blob[] = { 1, 2, 3, 4, 5 };
+
+    BlobCache cache;
+    cache.Insert(key.GetWords(), blob, sizeof(blob));
+    cache.Insert(MakeKey(signature, D3D_ROOT_SIGNATURE_VERSION_1_0).GetWords(), blob, 2);
+    CHECK(cache.IsDirty() && cache.Save(CachePath) && !cache.IsDirty());
+
+    BlobCache loaded;
+    CHECK(loaded.Load(CachePath) && loaded.GetCount() == 2);
+    const BlobCache::Blob* found = loaded.Find(key.GetWords());
+    CHECK(found != nullptr && *found == BlobCache::Blob(blob, blob + sizeof(blob)));
+    std::remove(CachePath);
+}
+
+TEST(BlobCache_DamagedFileLoadsEmpty)
+{
+    Signature signature;
+    const uint8_t blob[64] = {};
+    BlobCache cache;
+    cache.Insert(MakeKey(signature).GetWords(), blob, sizeof(blob));
+    CHECK(cache.Save(CachePath));
+
+    // truncated in the middle of the blob.
+    std::vector<char> bytes;
+    {
+        std::ifstream file(CachePath, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(CachePath, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size() - 10);
+    }
+    BlobCache truncated;
+    CHECK(!truncated.Load(CachePath) && truncated.GetCount() == 0);
+
+    // another format.
+    {
+        std::ofstream file(CachePath, std::ios::binary | std::ios::trunc);
+        file << "not a blob cache";
+    }
+    BlobCache foreign;
+    CHECK(!foreign.Load(CachePath) && foreign.GetCount() == 0);
+
+    std::remove(CachePath);
+    BlobCache missing;
+    CHECK(!missing.Load(CachePath) && missing.GetCount() == 0);
+}
@@ -0,0 +1,64 @@
+#include "Test.h"
+#include "core/SpscQueue.h"
+
+#include <cstdint>
+#include <thread>
+
+TEST(SpscQueue_FullAndEmpty)
+{
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t item = 0;
+    CHECK(!queue.TryPop(item));
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        CHECK(queue.TryPush(i));
+    }
+    CHECK(!queue.TryPush(8) && queue.GetSizeApprox() == 8);
+
+    // one slot freed, one more fits, in the slot of the wrapped around index.
+    CHECK(queue.TryPop(item) && item == 0);
+    CHECK(queue.TryPush(8));
+    for (uint32_t i = 1; i <= 8; ++i)
+    {
+        CHECK(queue.TryPop(item) && item == i);
+    }
+    CHECK(!queue.TryPop(item) && queue.GetSizeApprox() == 0);
+}
+
+TEST(SpscQueue_TwoThreadsKeepOrderAndCount)
+{
+    // a small ring so the indices wrap around tens of thousands of times, and both sides hit full and empty.
+    const uint32_t itemCount = 1u << 22;
+    SpscQueue<uint32_t, 256> queue;
+
+    std::thread producer([&queue, itemCount]()
+    {
+        for (uint32_t i = 0; i < itemCount; ++i)
+        {
+            while (!queue.TryPush(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t outOfOrder = 0;
+    while (received < itemCount)
+    {
+        uint32_t item = 0;
+        if (!queue.TryPop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        outOfOrder += item != received ? 1 : 0;
+        ++received;
+    }
+    producer.join();
+
+    uint32_t extra = 0;
+    CHECK(received == itemCount && outOfOrder == 0);
+    CHECK(!queue.TryPop(extra));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Minimal test harness for the platform independent core/ headers, no dependency: TEST(name) { ... } registers a test,
+// CHECK(condition) reports a failed condition and carries on, main.cpp runs every test and returns the number of failures.
+
+#include <cstdio>
+#include <vector>
+
+struct TestCase
+{
+    const char* name;
+    void (*function)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+inline int& GetFailedCheckCount()
+{
+    static int failedChecks = 0;
+    return failedChecks;
+}
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, void (*function)()) { GetTestCases().push_back(TestCase{ name, function }); }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistration name##Registration(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            ++GetFailedCheckCount(); \
+            printf("%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
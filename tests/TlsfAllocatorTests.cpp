@@ -0,0 +1,99 @@
+#include "Test.h"
+#include "core/TlsfAllocator.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    const uint64_t Granularity = 64 * 1024;
+    const uint64_t MsaaAlignment = 4 * 1024 * 1024;
+}
+
+TEST(TlsfAllocator_BlockOfExactlyTheSizeFits)
+{
+    // every size, not only the ones on a bin boundary.
+    for (uint64_t size = Granularity; size <= 256 * Granularity; size += Granularity)
+    {
+        TlsfAllocator allocator(size, Granularity);
+        const TlsfAllocator::Allocation allocation = allocator.Allocate(size, Granularity);
+        CHECK(allocation.IsValid() && allocation.offset == 0 && allocation.size == size);
+        CHECK(allocator.Validate());
+    }
+}
+
+TEST(TlsfAllocator_AlignedBlockFitsAnAlignedResource)
+{
+    // a heap created for one MSAA texture: offset 0 is aligned, no slack for the alignment is needed.
+    for (uint64_t size = Granularity; size <= 3 * MsaaAlignment; size += 3 * Granularity)
+    {
+        TlsfAllocator allocator(TlsfAllocator::AlignUp(size, MsaaAlignment), Granularity);
+        const TlsfAllocator::Allocation allocation = allocator.Allocate(size, MsaaAlignment);
+        CHECK(allocation.IsValid() && allocation.offset == 0);
+        CHECK(allocator.Validate());
+    }
+}
+
+TEST(TlsfAllocator_AlignmentSplitsTheGap)
+{
+    TlsfAllocator allocator(4 * MsaaAlignment, Granularity);
+    const TlsfAllocator::Allocation small = allocator.Allocate(Granularity);
+    const TlsfAllocator::Allocation aligned = allocator.Allocate(MsaaAlignment, MsaaAlignment);
+    CHECK(small.IsValid() && aligned.IsValid());
+    CHECK(aligned.offset % MsaaAlignment == 0 && aligned.offset >= small.offset + small.size);
+    CHECK(allocator.Validate());
+
+    // the gap in front of the aligned allocation is still free.
+    const TlsfAllocator::Allocation gap = allocator.Allocate(MsaaAlignment - Granularity);
+    CHECK(gap.IsValid() && gap.offset == Granularity);
+
+    allocator.Free(small.handle);
+    allocator.Free(aligned.handle);
+    allocator.Free(gap.handle);
+    CHECK(allocator.IsEmpty() && allocator.GetStats().freeBlocks == 1);
+    CHECK(allocator.Validate());
+}
+
+TEST(TlsfAllocator_TooLargeIsInvalid)
+{
+    TlsfAllocator allocator(MsaaAlignment, Granularity);
+    CHECK(!allocator.Allocate(MsaaAlignment + 1).IsValid());
+    CHECK(allocator.Allocate(MsaaAlignment).IsValid());
+    CHECK(!allocator.Allocate(Granularity).IsValid());
+    CHECK(allocator.Validate());
+}
+
+TEST(TlsfAllocator_RandomAllocationsKeepTheInvariants)
+{
+    TlsfAllocator allocator(64 * MsaaAlignment, Granularity);
+    std::mt19937 random(1234);
+    std::vector<TlsfAllocator::Allocation> allocations;
+    for (uint32_t i = 0; i < 4000; ++i)
+    {
+        if (allocations.empty() || random() % 3 != 0)
+        {
+            const uint64_t size = (1 + random() % 64) * Granularity - random() % Granularity;
+            const uint64_t alignment = random() % 8 == 0 ? MsaaAlignment : Granularity;
+            const TlsfAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+            if (allocation.IsValid())
+            {
+                CHECK(allocation.offset % alignment == 0 && allocation.size >= size);
+                allocations.push_back(allocation);
+            }
+        }
+        else
+        {
+            const size_t index = random() % allocations.size();
+            allocator.Free(allocations[index].handle);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+        }
+    }
+    CHECK(allocator.Validate());
+
+    for (const TlsfAllocator::Allocation& allocation : allocations)
+    {
+        allocator.Free(allocation.handle);
+    }
+    CHECK(allocator.IsEmpty() && allocator.Validate());
+}
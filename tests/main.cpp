@@ -0,0 +1,28 @@
+#include "Test.h"
+
+#include <exception>
+
+int main()
+{
+    int failedTests = 0;
+    for (const TestCase& testCase : GetTestCases())
+    {
+        const int failedChecks = GetFailedCheckCount();
+        try
+        {
+            testCase.function();
+        }
+        catch (const std::exception& exception)
+        {
+            ++GetFailedCheckCount();
+            printf("%s: exception: %s\n", testCase.name, exception.what());
+        }
+
+        const bool passed = GetFailedCheckCount() == failedChecks;
+        failedTests += passed ? 0 : 1;
+        printf("[%s] %s\n", passed ? "  OK  " : "FAILED", testCase.name);
+    }
+
+    printf("%d of %d tests passed\n", static_cast<int>(GetTestCases().size()) - failedTests, static_cast<int>(GetTestCases().size()));
+    return failedTests;
+}